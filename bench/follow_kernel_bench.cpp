@@ -0,0 +1,96 @@
+// =============================================================================
+//  FOLLOW KERNEL MICROBENCHMARK
+//  Times FindLeader (SIMD) against FindLeaderScalar on the same candidate sets.
+//
+//  Usage: bench_follow_kernel [--iterations N]
+//  Build with USE_AVX2=TRUE to measure the 8-wide path instead of SSE2.
+// =============================================================================
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "follow_kernel.h"
+#include "sim_random.h"
+
+// Neighbors of a car on a busy road: mostly same-direction traffic plus some crossing
+static void MakeScenario(int count, std::vector<FollowSelf>& selves, std::vector<FollowCandidates>& sets) {
+    const int SCENARIOS = 64;
+    selves.resize(SCENARIOS);
+    sets.resize(SCENARIOS);
+    for (int s = 0; s < SCENARIOS; s++) {
+        FollowSelf& self = selves[s];
+        self.px = 0; self.py = 0; self.pz = 0;
+        self.fx = 1; self.fy = 0; self.fz = 0;
+        self.lateralOffset = 0;
+        self.length = 4.5f;
+        self.range = 60.0f;
+        self.checkCrossing = true;
+
+        FollowCandidates& c = sets[s];
+        c.Clear();
+        for (int i = 0; i < count; i++) {
+            bool crossing = SimRandom::GetValue(0, 3) == 0;
+            float x = (float)SimRandom::GetValue(-400, 400) / 10.0f;
+            float z = (float)SimRandom::GetValue(-60, 60) / 10.0f;
+            float lateral = SimRandom::GetValue(0, 5) == 0 ? 3.5f : 0.0f;
+            if (crossing) c.Add(i, x, 0, z, 0, 0, 1, lateral, 4.5f);
+            else c.Add(i, x, 0, z, 1, 0, 0, lateral, (float)SimRandom::GetValue(25, 100) / 10.0f);
+        }
+    }
+}
+
+template <typename F>
+static double TimePerCall(F fn, const std::vector<FollowSelf>& selves, const std::vector<FollowCandidates>& sets,
+                          long iterations, long& checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (long it = 0; it < iterations; it++) {
+        size_t s = (size_t)it % selves.size();
+        FollowResult r = fn(selves[s], sets[s]);
+        checksum += r.leader + (r.crossingStop ? 1 : 0);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    long iterations = 2000000;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--iterations") == 0) iterations = atol(argv[i + 1]);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (iterations <= 0) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    SimRandom::Seed(1);
+    printf("kernel=%s iterations=%ld\n", GetFollowKernelName(), iterations);
+    printf("%10s %12s %12s %8s\n", "candidates", "scalar ns", "simd ns", "speedup");
+
+    int counts[] = { 8, 16, 32, 64, 128 };
+    for (int count : counts) {
+        std::vector<FollowSelf> selves;
+        std::vector<FollowCandidates> sets;
+        MakeScenario(count, selves, sets);
+
+        long checkScalar = 0, checkSimd = 0;
+        double scalarNs = TimePerCall(FindLeaderScalar, selves, sets, iterations, checkScalar);
+        double simdNs = TimePerCall(FindLeader, selves, sets, iterations, checkSimd);
+        if (checkScalar != checkSimd) {
+            fprintf(stderr, "Mismatch between kernels at %d candidates\n", count);
+            return 1;
+        }
+        printf("%10d %12.1f %12.1f %7.2fx\n", count, scalarNs, simdNs, simdNs > 0.0 ? scalarNs / simdNs : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,698 @@
+// =============================================================================
+//  SIMULATION BENCHMARKS
+//  Microbenchmarks for the core hot paths, parameterized by vehicle count.
+//  Results are written in Google Benchmark's JSON layout so the usual
+//  compare tools can diff two runs (e.g. before/after a change).
+//
+//  Usage: bench_sim [--out FILE] [--filter TEXT] [--min-time SECONDS]
+//    --out       JSON output file                     (default bench_results.json)
+//    --filter    only run benchmarks whose name contains TEXT
+//    --min-time  minimum measured time per benchmark   (default 0.2)
+// =============================================================================
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "raymath.h"
+#include "roadgraph.h"
+#include "road_network.h"
+#include "traffic_manager.h"
+#include "spawner.h"
+#include "vehicle.h"
+#include "worker_pool.h"
+#include "sim_random.h"
+#include "config.h"
+#include "router.h"
+#include "follow_model.h"
+#include "meso_engine.h"
+#include "demand.h"
+#include "road_network_file.h"
+
+// =============================================================================
+//  HARNESS
+// =============================================================================
+
+// Passed to every benchmark body: loop with while (state.KeepRunning()) { ... }
+// Setup work inside the loop goes between PauseTiming() and ResumeTiming().
+class BenchState {
+public:
+    BenchState(long iterations, int arg) : iterations(iterations), arg(arg) {}
+
+    int range() const { return arg; }
+
+    bool KeepRunning() {
+        if (done == 0) Start();
+        if (done < iterations) {
+            done++;
+            return true;
+        }
+        Stop();
+        return false;
+    }
+
+    void PauseTiming() { Stop(); }
+    void ResumeTiming() { Start(); }
+
+    double RealSeconds() const { return realSeconds; }
+    double CpuSeconds() const { return cpuSeconds; }
+
+private:
+    long iterations;
+    long done = 0;
+    int arg;
+    bool running = false;
+    double realSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    std::chrono::steady_clock::time_point realStart;
+    std::clock_t cpuStart = 0;
+
+    void Start() {
+        if (running) return;
+        running = true;
+        realStart = std::chrono::steady_clock::now();
+        cpuStart = std::clock();
+    }
+    void Stop() {
+        if (!running) return;
+        running = false;
+        realSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+        cpuSeconds += (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    }
+};
+
+typedef void (*BenchFunc)(BenchState&);
+
+struct BenchEntry {
+    std::string name;
+    BenchFunc fn;
+    std::vector<int> args; // Empty = not parameterized
+};
+
+static std::vector<BenchEntry>& Registry() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFunc fn, std::vector<int> args) {
+        Registry().push_back({ name, fn, args });
+    }
+};
+
+#define BENCHMARK(fn) static BenchRegistrar fn##_reg(#fn, fn, {})
+#define BENCHMARK_VEHICLES(fn) static BenchRegistrar fn##_reg(#fn, fn, VEHICLE_COUNTS)
+
+static const std::vector<int> VEHICLE_COUNTS = { 50, 500, 5000, 50000 };
+
+// =============================================================================
+//  FIXTURES
+// =============================================================================
+
+// Same four controllers as Simulation::Init
+static void SetupLights(TrafficManager& mgr) {
+    mgr.AddController(16, { 16, 17 });
+    mgr.ConfigureTrafficLight(16, { 10.5f, 0.0f, 34.0f }, 0.0f, 20.0f, 15.0f, 3.0f, 15.0f);
+    mgr.AddController(12, { 12, 13 });
+    mgr.ConfigureTrafficLight(12, { -10.5f, 0.0f, -34.0f }, 180.0f, 25.0f, 15.0f, 3.0f, 15.0f);
+    mgr.AddController(8, { 8, 9 });
+    mgr.ConfigureTrafficLight(8, { 34.0f, 0.0f, -10.5f }, 90.0f, 5.0f, 15.0f, 3.0f, 15.0f);
+    mgr.AddController(2, { 2, 3 });
+    mgr.ConfigureTrafficLight(2, { -34.0f, 0.0f, 10.5f }, 270.0f, 0.0f, 15.0f, 3.0f, 15.0f);
+}
+
+// N vehicles at the same density as the default scenario (~50 vehicles on a 240 m square),
+// so bigger counts spread over a bigger area instead of piling onto the same roads.
+static void FillVehicles(VehicleStore& vehicles, const RoadGraph& graph, int count) {
+    SimRandom::Seed(1234);
+    vehicles.Clear();
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+    float half = sqrtf((float)count * 1150.0f) / 2.0f;
+    int halfCm = (int)(half * 100.0f);
+
+    // First road leading to each node, so every vehicle sits on a road (occupancy lists)
+    std::vector<std::pair<int, int>> roadTo(nodes.size() * 2, { -1, 0 });
+    for (const Node& n : nodes) {
+        for (int b = 0; b < (int)n.nextNodes.size(); b++) {
+            int to = n.nextNodes[b];
+            if (to >= 0 && to < (int)roadTo.size() && roadTo[to].first == -1) roadTo[to] = { n.id, b };
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        VehicleType type = (VehicleType)SimRandom::GetValue(VEHICLE_CAR, VEHICLE_MOTORCYCLE);
+        Vector3 pos = { SimRandom::GetValue(-halfCm, halfCm) / 100.0f, 0.0f, SimRandom::GetValue(-halfCm, halfCm) / 100.0f };
+        int target = nodes[SimRandom::GetValue(0, (int)nodes.size() - 1)].id;
+        int v = vehicles.Add(type, pos, target);
+        if (target < (int)roadTo.size()) {
+            vehicles.edgeFromId[v] = roadTo[target].first;
+            vehicles.edgeBranch[v] = roadTo[target].second;
+        }
+
+        // Mostly on-axis headings like the real roads
+        float angle = SimRandom::GetValue(0, 3) * 90.0f * DEG2RAD;
+        vehicles.forward[v] = { cosf(angle), 0.0f, sinf(angle) };
+        vehicles.prevForward[v] = vehicles.forward[v];
+    }
+}
+
+// side x side DECISION grid (20 m blocks, two-way streets) with a TELEPORT in each
+// corner that jumps to the opposite one, like the exits of the default map
+static void BuildGridNetwork(RoadGraph& graph, int side) {
+    graph.Clear();
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            graph.AddNode(r * side + c, { c * 20.0f, 0.0f, r * 20.0f }, DECISION);
+        }
+    }
+    for (int r = 0; r < side; r++) {
+        for (int c = 0; c < side; c++) {
+            int id = r * side + c;
+            if (c + 1 < side) { graph.ConnectNodes(id, id + 1); graph.ConnectNodes(id + 1, id); }
+            if (r + 1 < side) { graph.ConnectNodes(id, id + side); graph.ConnectNodes(id + side, id); }
+        }
+    }
+    const int corners[4] = { 0, side - 1, side * (side - 1), side * side - 1 };
+    int first = side * side;
+    for (int k = 0; k < 4; k++) {
+        const Node& corner = graph.GetNode(corners[k]);
+        graph.AddNode(first + k, { corner.pos.x - 10.0f, 0.0f, corner.pos.z - 10.0f }, TELEPORT);
+        graph.ConnectNodes(corners[k], first + k);
+    }
+    for (int k = 0; k < 4; k++) graph.SetTeleportTarget(first + k, corners[3 - k]);
+}
+
+// Random (from, to) node pairs, same for every run
+static std::vector<std::pair<int, int>> MakeRouteQueries(const RoadGraph& graph, int count) {
+    SimRandom::Seed(4321);
+    int n = (int)graph.GetAllNodes().size();
+    std::vector<std::pair<int, int>> queries;
+    for (int q = 0; q < count; q++) {
+        queries.push_back({ SimRandom::GetValue(0, n - 1), SimRandom::GetValue(0, n - 1) });
+    }
+    return queries;
+}
+
+// =============================================================================
+//  BENCHMARKS
+// =============================================================================
+
+// One lookup per vehicle (what the physics pass does every tick)
+static void BM_RoadGraphGetNode(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+
+    float sink = 0.0f;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < vehicles.Size(); i++) sink += graph.GetNode(vehicles.targetNodeId[i]).pos.x;
+    }
+    if (sink == 12345.0f) printf(" "); // Keep the loop alive
+}
+BENCHMARK_VEHICLES(BM_RoadGraphGetNode);
+
+static void BM_UpdateVehicles(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    TrafficManager mgr(20.0f, 50.0f);
+    SetupLights(mgr);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+
+    while (state.KeepRunning()) {
+        mgr.UpdateVehicles(SimulationConfig::FIXED_TIMESTEP, vehicles, graph);
+    }
+}
+BENCHMARK_VEHICLES(BM_UpdateVehicles);
+
+// Same as above on a worker pool (one thread per core)
+static void BM_UpdateVehiclesParallel(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    TrafficManager mgr(20.0f, 50.0f);
+    SetupLights(mgr);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+    WorkerPool pool(0);
+
+    while (state.KeepRunning()) {
+        mgr.UpdateVehicles(SimulationConfig::FIXED_TIMESTEP, vehicles, graph, &pool);
+    }
+}
+BENCHMARK_VEHICLES(BM_UpdateVehiclesParallel);
+
+static void BM_UpdateLights(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    TrafficManager mgr(20.0f, 50.0f);
+    SetupLights(mgr);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+
+    while (state.KeepRunning()) {
+        mgr.UpdateLights(SimulationConfig::FIXED_TIMESTEP, graph, vehicles);
+    }
+}
+BENCHMARK_VEHICLES(BM_UpdateLights);
+
+// Light scheduling alone for N signalized nodes (no vehicles): most ticks have no phase change
+static void BM_UpdateLightsSignals(BenchState& state) {
+    RoadGraph graph;
+    TrafficManager mgr(20.0f, 50.0f);
+    for (int c = 0; c < state.range(); c++) {
+        graph.AddNode(c, { (float)c, 0.0f, 0.0f }, ARC);
+        mgr.AddController(c, { c });
+        mgr.ConfigureTrafficLight(c, { (float)c, 0.0f, 0.0f }, 0.0f, (float)(c % 30), 15.0f, 3.0f, 15.0f);
+    }
+    VehicleStore vehicles;
+
+    while (state.KeepRunning()) {
+        mgr.UpdateLights(SimulationConfig::FIXED_TIMESTEP, graph, vehicles);
+    }
+}
+static BenchRegistrar BM_UpdateLightsSignals_reg("BM_UpdateLightsSignals", BM_UpdateLightsSignals, { 4, 400, 4000 });
+
+// Default spawn queue against N vehicles already on the map (the blocking scan)
+static void BM_SpawnerUpdate(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore baseVehicles;
+    FillVehicles(baseVehicles, graph, state.range());
+
+    globalConfig = GetDefaultConfig();
+    VehicleSpawner baseSpawner;
+    baseSpawner.LoadFromConfig();
+
+    VehicleStore vehicles;
+    VehicleSpawner spawner;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        vehicles = baseVehicles;
+        spawner = baseSpawner;
+        state.ResumeTiming();
+
+        spawner.Update(graph, vehicles);
+    }
+}
+BENCHMARK_VEHICLES(BM_SpawnerUpdate);
+
+// Same with a long backlog (20 waiting per start node): only the queue heads are looked at
+static void BM_SpawnerBacklog(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore baseVehicles;
+    FillVehicles(baseVehicles, graph, state.range());
+
+    globalConfig = GetDefaultConfig();
+    VehicleSpawner baseSpawner;
+    const int starts[8] = { 0, 1, 26, 27, 30, 31, 35, 50 };
+    for (int k = 0; k < 160; k++) baseSpawner.Enqueue({ VEHICLE_CAR, starts[k % 8] });
+
+    VehicleStore vehicles;
+    VehicleSpawner spawner;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        vehicles = baseVehicles;
+        spawner = baseSpawner;
+        state.ResumeTiming();
+
+        spawner.Update(graph, vehicles);
+    }
+}
+BENCHMARK_VEHICLES(BM_SpawnerBacklog);
+
+// One simulated second of arrivals from a dense OD matrix (range = vehicles per hour per row)
+static void BM_DemandGenerate(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    const int starts[8] = { 0, 1, 26, 27, 30, 31, 35, 50 };
+    const int exits[8] = { 6, 7, 28, 29, 34, 44, 45, 51 };
+    DemandModel demand;
+    for (int o : starts) {
+        for (int d : exits) demand.AddTrips(o, d, (float)state.range());
+    }
+    demand.AddProfilePoint(0.0f, 0.2f);
+    demand.AddProfilePoint(8.0f, 1.0f);
+    demand.AddProfilePoint(18.0f, 1.0f);
+    SimRandom::Seed(1234);
+    demand.Prepare(graph);
+
+    std::vector<DemandArrival> arrivals;
+    while (state.KeepRunning()) {
+        arrivals.clear();
+        demand.Generate(1.0f, arrivals);
+    }
+}
+static BenchRegistrar BM_DemandGenerate_reg("BM_DemandGenerate", BM_DemandGenerate, { 10, 100, 1000 });
+
+// One vehicle leaving and one entering per iteration with N on the map: constant cost,
+// the store keeps its N slots
+static void BM_VehiclePoolChurn(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+
+    SimRandom::Seed(1234);
+    while (state.KeepRunning()) {
+        int i = SimRandom::GetValue(0, vehicles.Size() - 1);
+        VehicleType type = vehicles.type[i];
+        Vector3 pos = vehicles.position[i];
+        int target = vehicles.targetNodeId[i];
+        vehicles.Remove(i);
+        vehicles.Add(type, pos, target);
+    }
+}
+BENCHMARK_VEHICLES(BM_VehiclePoolChurn);
+
+// One route query per iteration on a side x side grid (side 0 = the default map).
+// Target: 10k queries/s, i.e. under 100000 ns per iteration.
+static const std::vector<int> GRID_SIDES = { 0, 10, 50, 150 };
+
+static void SetupRouter(Router& router, RoadGraph& graph, int side, bool hierarchy) {
+    if (side == 0) InitializeRoadNetwork(graph);
+    else BuildGridNetwork(graph, side);
+    router.Build(graph);
+    if (hierarchy) router.BuildContractionHierarchy();
+}
+
+static void BM_RouteAStar(BenchState& state) {
+    RoadGraph graph;
+    Router router;
+    SetupRouter(router, graph, state.range(), false);
+    std::vector<std::pair<int, int>> queries = MakeRouteQueries(graph, 1024);
+
+    std::vector<int> path;
+    size_t q = 0;
+    while (state.KeepRunning()) {
+        router.FindRouteAStar(queries[q].first, queries[q].second, path);
+        q = (q + 1) % queries.size();
+    }
+}
+static BenchRegistrar BM_RouteAStar_reg("BM_RouteAStar", BM_RouteAStar, GRID_SIDES);
+
+static void BM_RouteCH(BenchState& state) {
+    // Preprocessing is not what we measure: build each hierarchy once per process
+    static std::map<int, RoadGraph> graphs;
+    static std::map<int, Router> routers;
+    int side = state.range();
+    if (!routers.count(side)) SetupRouter(routers[side], graphs[side], side, true);
+    Router& router = routers[side];
+    std::vector<std::pair<int, int>> queries = MakeRouteQueries(graphs[side], 1024);
+
+    std::vector<int> path;
+    size_t q = 0;
+    while (state.KeepRunning()) {
+        router.FindRouteCH(queries[q].first, queries[q].second, path);
+        q = (q + 1) % queries.size();
+    }
+}
+static BenchRegistrar BM_RouteCH_reg("BM_RouteCH", BM_RouteCH, GRID_SIDES);
+
+// Speed update of 5000 vehicles that all use model range() (0 legacy, 1 IDM, 2 Gipps, 3 Krauss)
+static void BM_FollowModel(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, 5000);
+
+    FollowInputs inputs;
+    inputs.Resize(vehicles.Size());
+    std::vector<int> indices;
+    for (int i = 0; i < vehicles.Size(); i++) {
+        inputs.gap[i] = (i % 3 == 0) ? NO_FOLLOW_GAP : (float)(i % 40);
+        inputs.leaderSpeed[i] = (float)(i % 15);
+        inputs.stopGap[i] = (i % 7 == 0) ? 10.0f : NO_FOLLOW_GAP;
+        inputs.forced[i] = 0;
+        indices.push_back(i);
+    }
+    std::vector<float> baseSpeed = vehicles.speed;
+    FollowModelFunc model = GetFollowModelFunc((FollowModel)state.range());
+    FollowContext ctx = { SimulationConfig::FIXED_TIMESTEP, 4.0f, 20.0f, 0 };
+
+    while (state.KeepRunning()) {
+        model(indices.data(), (int)indices.size(), inputs, ctx, vehicles);
+        state.PauseTiming();
+        vehicles.speed = baseSpeed;
+        ctx.step++;
+        state.ResumeTiming();
+    }
+}
+static BenchRegistrar BM_FollowModel_reg("BM_FollowModel", BM_FollowModel, { FOLLOW_LEGACY, FOLLOW_IDM, FOLLOW_GIPPS, FOLLOW_KRAUSS });
+
+// Speed samples + blend for N vehicles (every tick)
+static void BM_UpdateEdgeTravelTimes(BenchState& state) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    VehicleStore vehicles;
+    FillVehicles(vehicles, graph, state.range());
+    for (int i = 0; i < vehicles.Size(); i++) {
+        const Node& from = graph.GetAllNodes()[i % graph.GetAllNodes().size()];
+        vehicles.edgeFromId[i] = from.nextNodes.empty() ? -1 : from.id;
+    }
+
+    while (state.KeepRunning()) {
+        UpdateEdgeTravelTimes(vehicles, graph, SimulationConfig::FIXED_TIMESTEP);
+    }
+}
+BENCHMARK_VEHICLES(BM_UpdateEdgeTravelTimes);
+
+// Rerouting work of one tick in ROUTING_DYNAMIC (EXIT_NODES_PER_TICK settled nodes),
+// independent of the vehicle count and bounded on big maps
+static void BM_UpdateExitTimes(BenchState& state) {
+    RoadGraph graph;
+    Router router;
+    SetupRouter(router, graph, state.range(), false);
+
+    while (state.KeepRunning()) {
+        router.UpdateExitTimes(graph, Router::EXIT_NODES_PER_TICK);
+    }
+}
+static BenchRegistrar BM_UpdateExitTimes_reg("BM_UpdateExitTimes", BM_UpdateExitTimes, GRID_SIDES);
+
+// One simulated second (dt = 1) of the queue engine, N vehicles on a grid with room for ~2N
+static void BM_MesoUpdate(BenchState& state) {
+    RoadGraph graph;
+    BuildGridNetwork(graph, (int)sqrtf(state.range() / 2.0f) + 2);
+    MesoEngine meso;
+    meso.Build(graph);
+
+    SimRandom::Seed(1234);
+    VehicleStore vehicles;
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+    while (vehicles.Size() < state.range()) {
+        const Node& n = nodes[SimRandom::GetValue(0, (int)nodes.size() - 1)];
+        if (n.nextNodes.empty()) continue;
+        int branch = SimRandom::GetValue(0, (int)n.nextNodes.size() - 1);
+        if (!meso.HasRoom(n.id, branch)) continue;
+        int v = vehicles.Add((VehicleType)SimRandom::GetValue(VEHICLE_CAR, VEHICLE_MOTORCYCLE), n.pos, n.nextNodes[branch]);
+        vehicles.edgeFromId[v] = n.id;
+        vehicles.edgeBranch[v] = branch;
+        meso.Insert(vehicles, v);
+    }
+
+    while (state.KeepRunning()) {
+        meso.Update(1.0f, vehicles, graph);
+        graph.UpdateTravelTimes(1.0f);
+    }
+}
+BENCHMARK_VEHICLES(BM_MesoUpdate);
+
+// Map file of the default network (0) or a side x side grid: mmap + validation, then
+// RoadGraph rebuilt from the blob (compare BM_InitializeRoadNetwork)
+static void BM_LoadRoadNetwork(BenchState& state) {
+    const char* textPath = "bench_grid.roadnet";
+    const char* binPath = "bench_grid.roadbin";
+    RoadGraph graph;
+    if (state.range() == 0) InitializeRoadNetwork(graph);
+    else BuildGridNetwork(graph, state.range());
+    RoadNetworkFile file;
+    if (!WriteRoadNetworkText(graph, textPath) || !file.LoadText(textPath) || !file.SaveBinary(binPath)) return;
+
+    while (state.KeepRunning()) {
+        file.LoadBinary(binPath);
+        file.BuildGraph(graph);
+    }
+    file.Unload();
+    remove(textPath);
+    remove(binPath);
+}
+static BenchRegistrar BM_LoadRoadNetwork_reg("BM_LoadRoadNetwork", BM_LoadRoadNetwork, GRID_SIDES);
+
+// Not parameterized: the network does not depend on the vehicle count
+static void BM_InitializeRoadNetwork(BenchState& state) {
+    RoadGraph graph;
+    while (state.KeepRunning()) {
+        graph.Clear();
+        InitializeRoadNetwork(graph);
+    }
+}
+BENCHMARK(BM_InitializeRoadNetwork);
+
+// Packing the adjacency (CSR) of a built graph; the copy of the unfrozen graph is not timed
+static void BM_GraphFreeze(BenchState& state) {
+    RoadGraph graph;
+    if (state.range() == 0) InitializeRoadNetwork(graph);
+    else BuildGridNetwork(graph, state.range());
+
+    RoadGraph copy;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        copy = graph;
+        state.ResumeTiming();
+        copy.Freeze();
+    }
+}
+static BenchRegistrar BM_GraphFreeze_reg("BM_GraphFreeze", BM_GraphFreeze, GRID_SIDES);
+
+// One sweep over every road: frozen edges vs nextNodes + id lookups (what it replaced)
+static void BM_GraphWalk(BenchState& state) {
+    RoadGraph graph;
+    if (state.range() == 0) InitializeRoadNetwork(graph);
+    else BuildGridNetwork(graph, state.range());
+    graph.Freeze();
+
+    float sum = 0.0f;
+    int count = (int)graph.GetAllNodes().size();
+    while (state.KeepRunning()) {
+        for (int k = 0; k < count; k++) {
+            for (int e = graph.GetEdgeBegin(k); e < graph.GetEdgeEnd(k); e++) {
+                sum += graph.GetEdgeLength(e) + (float)graph.GetEdgeTarget(e);
+            }
+        }
+    }
+    if (sum < 0.0f) printf("%f\n", sum); // Keep the loop
+}
+static BenchRegistrar BM_GraphWalk_reg("BM_GraphWalk", BM_GraphWalk, GRID_SIDES);
+
+static void BM_GraphWalkNodes(BenchState& state) {
+    RoadGraph graph;
+    if (state.range() == 0) InitializeRoadNetwork(graph);
+    else BuildGridNetwork(graph, state.range());
+
+    float sum = 0.0f;
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+    while (state.KeepRunning()) {
+        for (const Node& node : nodes) {
+            for (int toId : node.nextNodes) {
+                const Node& to = graph.GetNode(toId);
+                sum += Vector3Distance(node.pos, to.pos) + (float)graph.GetNodeIndex(toId);
+            }
+        }
+    }
+    if (sum < 0.0f) printf("%f\n", sum);
+}
+static BenchRegistrar BM_GraphWalkNodes_reg("BM_GraphWalkNodes", BM_GraphWalkNodes, GRID_SIDES);
+
+// =============================================================================
+//  RUNNER
+// =============================================================================
+
+struct BenchResult {
+    std::string name;
+    long iterations;
+    double realNs;  // Per iteration
+    double cpuNs;
+};
+
+// Doubles the iteration count until the run lasts at least minTime (like Google Benchmark)
+static BenchResult Run(const std::string& name, BenchFunc fn, int arg, double minTime) {
+    long iterations = 1;
+    while (true) {
+        BenchState state(iterations, arg);
+        fn(state);
+        double elapsed = state.RealSeconds();
+        if (elapsed >= minTime || iterations >= 1000000000L) {
+            return { name, iterations, state.RealSeconds() * 1e9 / iterations, state.CpuSeconds() * 1e9 / iterations };
+        }
+        // Aim a bit past minTime so the next attempt is usually the last
+        double factor = (elapsed > 0.0) ? (minTime * 1.4 / elapsed) : 10.0;
+        if (factor > 10.0) factor = 10.0;
+        if (factor < 2.0) factor = 2.0;
+        iterations = (long)(iterations * factor);
+    }
+}
+
+static void WriteJson(const char* path, const std::vector<BenchResult>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return;
+    }
+
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"executable\": \"bench_sim\",\n");
+    fprintf(f, "    \"library_build_type\": \"release\"\n  },\n");
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": \"%s\",\n", r.name.c_str());
+        fprintf(f, "      \"run_name\": \"%s\",\n", r.name.c_str());
+        fprintf(f, "      \"run_type\": \"iteration\",\n");
+        fprintf(f, "      \"iterations\": %ld,\n", r.iterations);
+        fprintf(f, "      \"real_time\": %.3f,\n", r.realNs);
+        fprintf(f, "      \"cpu_time\": %.3f,\n", r.cpuNs);
+        fprintf(f, "      \"time_unit\": \"ns\"\n");
+        fprintf(f, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = "bench_results.json";
+    const char* filter = "";
+    double minTime = 0.2;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else if (strcmp(argv[i], "--filter") == 0) filter = argv[i + 1];
+        else if (strcmp(argv[i], "--min-time") == 0) minTime = atof(argv[i + 1]);
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (minTime <= 0.0) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    printf("%-36s %15s %15s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    std::vector<BenchResult> results;
+    for (const BenchEntry& e : Registry()) {
+        std::vector<int> args = e.args;
+        bool parameterized = !args.empty();
+        if (!parameterized) args.push_back(0);
+
+        for (int arg : args) {
+            std::string name = parameterized ? e.name + "/" + std::to_string(arg) : e.name;
+            if (name.find(filter) == std::string::npos) continue;
+
+            BenchResult r = Run(name, e.fn, arg, minTime);
+            printf("%-36s %15.0f %15.0f %12ld\n", r.name.c_str(), r.realNs, r.cpuNs, r.iterations);
+            fflush(stdout);
+            results.push_back(r);
+        }
+    }
+
+    WriteJson(outPath, results);
+    printf("Results written to %s\n", outPath);
+    return 0;
+}
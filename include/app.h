@@ -6,6 +6,7 @@
 #include "interface_new.h"
 #include "ingame_menu.h"
 #include "model_manager.h"
+#include "static_scene.h"
 #include "config.h"
 
 class App {
@@ -16,6 +17,7 @@ private:
     TrafficInterface interface;
     InGameMenu pauseMenu;
     ModelManager modelManager;
+    StaticScene cityScene;      // DrawBasicMap baked into meshes at startup
 
     //Iaddthis._.
 
@@ -27,9 +29,12 @@ private:
     bool gameStarted;
     float loadingTimer;
     bool showDebugNodes;
+    bool fastForward;   // [F] runs the sim at FAST_FORWARD_SPEED
+    bool useBakedCity;  // [B] baked city meshes vs. the immediate-mode DrawBasicMap path
 
     // Private helpers
     void Update();
+    void UpdateVehiclePicking(); // Mouse hover/click on cars (input stays out of Simulation)
     void Draw();
 
 public:
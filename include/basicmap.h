@@ -1,7 +1,7 @@
 #ifndef BASICMAP_H
 #define BASICMAP_H
 
-#include "roadgraph.h"
+#include "road_network.h"
 #include "raylib.h"
 #include "draw_utils.h"
 #include "city_structures.h"
@@ -9,7 +9,9 @@
 // Gère le dessin de la partie visuelle (Basic Map)
 void DrawBasicMap();
 
-// Gère l'initialisation de tous les nœuds et arcs (Logique)
-void InitializeRoadNetwork(RoadGraph& graph);
+// The same map in two parts: roads/sidewalks/markings, then the buildings one by one
+void DrawBasicMapGround();
+int GetBuildingCount();
+void DrawBuilding(int index);
 
 #endif
\ No newline at end of file
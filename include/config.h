@@ -12,10 +12,54 @@ struct VehicleSpawnConfig {
     std::vector<int> startNodes;
 };
 
+// How the planned traffic lights (SignalPlan) pick their greens
+enum SignalControlMode {
+    SIGNAL_FIXED_TIME = 0,  // Stages in order with their planned green times
+    SIGNAL_ACTUATED,        // Green extended while vehicles keep arriving, empty stages skipped
+    SIGNAL_MAX_PRESSURE     // Stage with the largest queue minus downstream load goes next
+};
+
+// How vehicles pick their branch at DECISION / START / ARC nodes
+enum RoutingMode {
+    ROUTING_RANDOM_WALK = 0,  // Uniformly random branch (original behaviour)
+    ROUTING_TRIPS,            // Shortest route to a random exit (Router, see router.h)
+    ROUTING_DYNAMIC           // Random exit, branch with the lowest live travel time at every node
+};
+
+// Longitudinal (car-following) model, see follow_model.h
+enum FollowModel {
+    FOLLOW_BY_TYPE = -1,    // SimulationConfig only: every vehicle type keeps its own model
+    FOLLOW_LEGACY = 0,      // Original lerp between minSafeDist and the slowing distance
+    FOLLOW_IDM,             // Intelligent Driver Model (Treiber)
+    FOLLOW_GIPPS,           // Gipps (safe speed with reaction time)
+    FOLLOW_KRAUSS,          // Krauss (SUMO default, with dawdling)
+    FOLLOW_MODEL_COUNT
+};
+
+// What moves the vehicles
+enum SimulationEngine {
+    ENGINE_MICRO = 0,   // Car following + steering every tick (TrafficManager, UpdateVehicleMotion)
+    ENGINE_MESO         // Roads as FIFO queues, vehicles hop road to road on events (meso_engine.h)
+};
+
 // Main Configuration Structure
 struct SimulationConfig {
     int maxVehicles = 50;
     float simulationSpeed = 1.0f; // 1.0x = Normal, 2.0x = Fast
+    int workerThreads = 0;        // Threads for the vehicle update, 0 = one per CPU core
+    SignalControlMode signalControl = SIGNAL_FIXED_TIME;
+    RoutingMode routing = ROUTING_RANDOM_WALK;
+    FollowModel followModel = FOLLOW_BY_TYPE; // Forces one model on every vehicle
+    SimulationEngine engine = ENGINE_MICRO;
+    std::string networkPath;      // .roadnet / .roadbin map (road_network_file.h), empty = built-in network
+    // TELEPORT nodes are exits: vehicles leave the network there (slot freed for reuse) and
+    // queue again at the landing START, instead of jumping to it when the landing is clear
+    bool leaveAtExits = false;
+    std::string demandPath;       // OD matrix (demand.h) replacing vehicleConfigs' one-shot queue; vehicles leave at the exits
+
+    bool approachStats = false;   // Measure served/delay per approach with fixed-time lights too (headless report)
+
+    bool VehiclesLeaveAtExits() const { return leaveAtExits || !demandPath.empty(); }
     
     // List of all vehicle groups
     std::vector<VehicleSpawnConfig> vehicleConfigs;
@@ -32,6 +76,16 @@ struct SimulationConfig {
     static constexpr float POLICE_SPEED = 22.0f;
     static constexpr float MOTORCYCLE_SPEED = 20.0f;
     static constexpr float ARRIVAL_THRESHOLD = 2.0f;
+
+    // Fixed-step scheduler (see Simulation::Advance)
+    static constexpr float FIXED_TIMESTEP = 1.0f / 60.0f; // Every physics step uses exactly this dt
+    static const int MAX_SUBSTEPS_PER_FRAME = 240;         // Above this the backlog is dropped (no spiral of death)
+    static constexpr float FAST_FORWARD_SPEED = 100.0f;   // [F] key multiplier, beyond the 3.0x slider
+
+    // Rendering LOD: past these camera distances objects are drawn as plain boxes
+    static constexpr float LOD_VEHICLE_DISTANCE = 120.0f;
+    static constexpr float LOD_BUILDING_DISTANCE = 180.0f;
+    static constexpr float LOD_LIGHT_DISTANCE = 120.0f;
 };
 
 // Global config instance (declared here, defined in cpp)
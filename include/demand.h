@@ -0,0 +1,104 @@
+#ifndef DEMAND_H
+#define DEMAND_H
+
+#include <string>
+#include <vector>
+
+#include "roadgraph.h"
+#include "vehicle.h"
+
+// =============================================================================
+//  DEMAND (ORIGIN-DESTINATION MATRIX)
+//  Continuous arrivals instead of the one-shot queue of vehicleConfigs
+//  (SimulationConfig::demandPath). Text file, one item per line, '#' starts a comment:
+//    od      <originId> <destinationId> <vehicles per hour>
+//    profile <hour> <factor> [<hour> <factor> ...]   time-of-day multiplier, linear
+//                                                    between the points, wraps at 24h
+//    mix     <type> <weight>                         vehicle type shares
+//    start   <hour>                                  time of day at simulation time 0
+//  No profile = constant rates (plain Poisson), no mix = the counts of vehicleConfigs.
+//
+//  Every origin is a Poisson process whose rate is the sum of its rows times the
+//  profile. Candidates are drawn at the profile's peak rate and kept with probability
+//  factor / peak (thinning), so the cost follows the arrivals, not the ticks. An
+//  arrival picks its destination by the row rates and its type by the mix; the
+//  destination becomes the vehicle's trip with ROUTING_TRIPS / ROUTING_DYNAMIC
+//  (random turns ignore it). Vehicles leave the network at the exits.
+// =============================================================================
+
+struct DemandArrival {
+    double time;            // Simulation seconds
+    VehicleType type;
+    int originId;
+    int destinationId;
+};
+
+class DemandModel {
+public:
+    // false on error (see GetError); replaces the current demand
+    bool Load(const char* path);
+    const std::string& GetError() const { return error; }
+    void Clear();
+
+    // Programmatic setup (tests, tools). Same meaning as the file lines.
+    void AddTrips(int originId, int destinationId, float perHour);
+    void AddProfilePoint(float hour, float factor);
+    void AddMix(VehicleType type, float weight);
+    void SetStartHour(float hour) { startHour = hour; }
+
+    bool HasDemand() const { return !rows.empty(); }
+
+    // Keeps the rows the graph can serve (origin with a road, TELEPORT destination)
+    // and restarts the arrivals at simulation time 0. Draws from SimRandom.
+    void Prepare(const RoadGraph& graph);
+
+    // Arrivals in (clock, clock + dt], appended to 'out' in time order
+    void Generate(float dt, std::vector<DemandArrival>& out);
+
+    // Profile multiplier at a time of day (hours, any value: wraps at 24)
+    float GetFactor(float hour) const;
+    float GetTimeOfDay() const; // Hours
+    // Vehicles per hour of the prepared rows, before the profile
+    float GetTotalRate() const { return totalRate; }
+    long GetArrivalCount() const { return arrivalCount; }
+    int GetRowCount() const { return (int)activeRows.size(); }
+    int GetDroppedRowCount() const { return droppedRows; }
+
+private:
+    struct Row {
+        int originId;
+        int destinationId;
+        float perHour;
+    };
+    struct ProfilePoint {
+        float hour;
+        float factor;
+    };
+    struct Origin {
+        int nodeId;
+        int firstRow;       // Rows of this origin in activeRows
+        int rowCount;
+        float perHour;
+        double next;        // Next candidate arrival (thinning)
+    };
+
+    std::vector<Row> rows;
+    std::vector<ProfilePoint> profile;  // Sorted by hour
+    std::vector<std::pair<VehicleType, float>> mix;
+    float startHour = 8.0f;
+    std::string error;
+
+    // Prepared state
+    std::vector<Row> activeRows;        // Servable rows with a rate, grouped by origin
+    std::vector<Origin> origins;
+    std::vector<std::pair<VehicleType, float>> activeMix;
+    float peakFactor = 1.0f;
+    float totalRate = 0.0f;
+    double clock = 0.0;
+    long arrivalCount = 0;
+    int droppedRows = 0;
+
+    double NextCandidate(const Origin& o, double after) const;
+};
+
+#endif // DEMAND_H
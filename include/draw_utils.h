@@ -2,7 +2,8 @@
 #define DRAW_UTILS_H
 
 #include "raylib.h"
-#include "rlgl.h" 
+#include "rlgl.h"
+#include "map_draw.h"
 #include <vector>
 #include <cmath>
 
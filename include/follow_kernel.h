@@ -0,0 +1,53 @@
+#ifndef FOLLOW_KERNEL_H
+#define FOLLOW_KERNEL_H
+
+#include <vector>
+
+// =============================================================================
+//  CAR-FOLLOWING KERNEL
+//  The per-pair math of TrafficManager::UpdateVehicle (same-direction test,
+//  lane projection, gap, crossing check) evaluated over a batch of neighbors.
+//  Candidates are gathered into flat arrays first so the kernel can run
+//  8 (AVX2) or 4 (SSE2) pairs per instruction. Every path gives the same
+//  result as FindLeaderScalar, bit for bit.
+// =============================================================================
+
+// The vehicle looking for a leader
+struct FollowSelf {
+    float px, py, pz;     // Position
+    float fx, fy, fz;     // Forward
+    float lateralOffset;  // Yield offset (front buffer)
+    float length;
+    float range;          // Detection range (candidates further away are ignored)
+    bool checkCrossing;   // false for emergency vehicles (they ignore crossing traffic)
+};
+
+// Neighbors of FollowSelf, one entry per array (Structure of Arrays)
+struct FollowCandidates {
+    std::vector<float> px, py, pz;
+    std::vector<float> fx, fy, fz;
+    std::vector<float> lateralOffset;
+    std::vector<float> length;
+    std::vector<int> index;   // Vehicle index, returned as FollowResult::leader
+
+    void Clear();
+    void Add(int vehicleIndex, float x, float y, float z, float fwdX, float fwdY, float fwdZ, float lateral, float len);
+    int Size() const { return (int)index.size(); }
+};
+
+struct FollowResult {
+    int leader;         // Closest same-direction vehicle in our lane, -1 if none
+    float gap;          // Bumper to bumper distance to the leader (9999 if none)
+    bool crossingStop;  // A crossing vehicle is right in front of us
+};
+
+// Reference implementation (one pair at a time)
+FollowResult FindLeaderScalar(const FollowSelf& self, const FollowCandidates& cands);
+
+// Widest implementation compiled in (AVX2 with -mavx2, else SSE2 on x86, else scalar)
+FollowResult FindLeader(const FollowSelf& self, const FollowCandidates& cands);
+
+// "avx2", "sse2" or "scalar"
+const char* GetFollowKernelName();
+
+#endif // FOLLOW_KERNEL_H
@@ -0,0 +1,51 @@
+#ifndef FOLLOW_MODEL_H
+#define FOLLOW_MODEL_H
+
+#include <vector>
+
+#include "config.h"
+#include "vehicle.h"
+
+// =============================================================================
+//  LONGITUDINAL (CAR-FOLLOWING) MODELS
+//  TrafficManager::UpdateVehicle only gathers what a vehicle sees (gap and speed
+//  of its leader, distance to a stop line) into FollowInputs. The speeds are then
+//  computed model by model: the vehicles are grouped by FollowModel and each model
+//  runs one tight loop over its group, so picking a model costs one function
+//  pointer call per batch, never a virtual call per vehicle pair.
+//  Parameters (acceleration, deceleration, gap, headway...) come from the vehicle
+//  type (VehicleTypeParams::follow).
+// =============================================================================
+
+static const float NO_FOLLOW_GAP = 9999.0f; // Same as FollowResult::gap without a leader
+
+// One entry per vehicle, written by TrafficManager::UpdateVehicle
+struct FollowInputs {
+    std::vector<float> gap;          // Bumper to bumper to the leader, NO_FOLLOW_GAP if none
+    std::vector<float> leaderSpeed;  // Leader speed (front buffer), 0 without leader
+    std::vector<float> stopGap;      // To where we must stop (red light, crossing traffic), NO_FOLLOW_GAP if none
+    std::vector<unsigned char> forced; // Player "honk": ignore everything, go at FORCED_SPEED
+
+    void Resize(int count);
+};
+
+struct FollowContext {
+    float dt;
+    float minSafeDist;        // FOLLOW_LEGACY: stop below this gap
+    float startSlowingDist;   // FOLLOW_LEGACY: start slowing below this + 1.5 s * speed
+    unsigned int step;        // FOLLOW_KRAUSS: seeds the dawdling noise (same on every thread count)
+};
+
+static const float FORCED_SPEED = 18.0f; // "Angry mode" speed, whatever the model
+
+// Updates vehicles.speed[indices[k]] for k < count, all of them using the same model
+typedef void (*FollowModelFunc)(const int* indices, int count, const FollowInputs& in,
+                                const FollowContext& ctx, VehicleStore& vehicles);
+
+FollowModelFunc GetFollowModelFunc(FollowModel model);
+
+// "legacy", "idm", "gipps", "krauss" (FollowModelFromName returns FOLLOW_BY_TYPE if unknown)
+const char* GetFollowModelName(FollowModel model);
+FollowModel FollowModelFromName(const char* name);
+
+#endif // FOLLOW_MODEL_H
@@ -0,0 +1,28 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "raylib.h"
+
+// ----- View Frustum -----
+// Six planes (ax + by + cz + d >= 0 inside) taken from a view-projection matrix,
+// used to skip whatever the camera cannot see before it reaches the GPU.
+struct Frustum {
+    Vector4 planes[6];  // Left, right, bottom, top, near, far (normalized)
+};
+
+// viewProjection = MatrixMultiply(view, projection), i.e. what BeginMode3D sets up
+Frustum ExtractFrustum(Matrix viewProjection);
+
+bool SphereInFrustum(const Frustum& frustum, Vector3 center, float radius);
+bool BoxInFrustum(const Frustum& frustum, BoundingBox box);
+
+// Drawn/culled tally of one kind of object for the HUD
+struct CullCounter {
+    int drawn = 0;      // Includes lowDetail
+    int lowDetail = 0;  // Drawn with the far LOD
+    int culled = 0;
+
+    void Reset() { drawn = lowDetail = culled = 0; }
+};
+
+#endif // FRUSTUM_H
@@ -0,0 +1,53 @@
+#ifndef MAP_DRAW_H
+#define MAP_DRAW_H
+
+#include "raylib.h"
+#include <vector>
+
+// ----- Static Map Geometry -----
+// World-space triangles/lines recorded from the map drawing code (see StaticScene).
+// Colors are RGBA bytes, one per vertex.
+struct MapGeometry {
+    std::vector<float> opaqueVertices;          // 3 floats per vertex, 3 vertices per triangle
+    std::vector<unsigned char> opaqueColors;    // 4 bytes per vertex
+    std::vector<float> translucentVertices;     // Same layout, alpha < 255 (drawn after the opaque pass)
+    std::vector<unsigned char> translucentColors;
+    std::vector<float> lineVertices;            // 2 vertices per line (wires, outlines)
+    std::vector<unsigned char> lineColors;
+
+    void Clear();
+    int GetTriangleCount() const;
+    int GetLineCount() const;
+};
+
+// ----- Map Drawing Primitives -----
+// Same signatures as the raylib/rlgl calls used by basicmap, draw_utils and city_structures.
+// Normally they forward straight to raylib. Between BeginRecording/EndRecording they
+// tessellate into a MapGeometry instead (with their own matrix stack), so the static
+// city can be baked once at load.
+namespace MapDraw {
+    void BeginRecording(MapGeometry* target);
+    void EndRecording();
+    bool IsRecording();
+
+    void DrawCube(Vector3 position, float width, float height, float length, Color color);
+    void DrawCubeWires(Vector3 position, float width, float height, float length, Color color);
+    void DrawCylinder(Vector3 position, float radiusTop, float radiusBottom, float height, int slices, Color color);
+    void DrawCylinderEx(Vector3 startPos, Vector3 endPos, float startRadius, float endRadius, int sides, Color color);
+    void DrawCylinderWires(Vector3 position, float radiusTop, float radiusBottom, float height, int slices, Color color);
+    void DrawSphere(Vector3 centerPos, float radius, Color color);
+    void DrawLine3D(Vector3 startPos, Vector3 endPos, Color color);
+    void DrawPlane(Vector3 centerPos, Vector2 size, Color color);
+
+    // rlgl matrix stack / immediate vertices (rlPushMatrix, rlBegin(RL_QUADS), ...)
+    void PushMatrix();
+    void PopMatrix();
+    void Translatef(float x, float y, float z);
+    void Rotatef(float angle, float x, float y, float z);
+    void Begin(int mode);
+    void Color4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+    void Vertex3f(float x, float y, float z);
+    void End();
+}
+
+#endif // MAP_DRAW_H
@@ -0,0 +1,32 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (mmap, MapViewOfFile on Windows).
+// The pages are loaded by the OS on first touch: opening a big file costs nothing
+// until it is read. No raylib here: windows.h and raylib.h do not mix.
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const char* path); // false if missing, empty or not mappable
+    void Close();
+
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;       // HANDLE
+    void* mapping = nullptr;    // HANDLE
+#endif
+};
+
+#endif // MAPPED_FILE_H
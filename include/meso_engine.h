@@ -0,0 +1,113 @@
+#ifndef MESO_ENGINE_H
+#define MESO_ENGINE_H
+
+#include <vector>
+#include <queue>
+
+#include "roadgraph.h"
+#include "vehicle.h"
+
+class Router; // router.h
+
+// =============================================================================
+//  MESOSCOPIC (QUEUE) ENGINE
+//  SimulationConfig::engine == ENGINE_MESO replaces TrafficManager::UpdateVehicles +
+//  UpdateVehicleMotion. Every road (node -> nextNodes[k]) is a FIFO queue:
+//    - a vehicle entering at t can leave at t + length / desiredSpeed at the earliest,
+//    - it holds JAM_SPACING meters of storage: a full road refuses new vehicles (spillback),
+//    - the head leaves at most once every SATURATION_HEADWAY seconds (1800 veh/h),
+//      never on red/yellow (emergency vehicles excepted).
+//  Work is only done on events (a head becoming ready, a light turning green, room freed
+//  downstream), so the cost follows the number of road changes, not ticks x vehicles.
+//  Branch choices, trips and teleports follow the same rules as the micro engine; the
+//  positions written back to the VehicleStore (lights, drawing) are interpolated.
+// =============================================================================
+
+class MesoEngine {
+public:
+    static constexpr float JAM_SPACING = 7.5f;          // Meters of road per stored vehicle
+    static constexpr float SATURATION_HEADWAY = 2.0f;   // Seconds between two departures from a road
+    static constexpr float STUCK_TIME = 10.0f;          // Blocked head pushes in anyway after this (no gridlock)
+
+    // Roads and capacities from the graph; drops every vehicle
+    void Build(const RoadGraph& graph);
+    void Clear();
+
+    // Spawner: room left on the road fromId -> nextNodes[branch]
+    bool HasRoom(int fromId, int branch) const;
+    // Puts vehicle i at the tail of its road (vehicles.edgeFromId / edgeBranch)
+    void Insert(VehicleStore& vehicles, int i);
+
+    // Runs the events up to clock + dt, then places the vehicles on their roads.
+    // router != nullptr: live fastest branch (ROUTING_DYNAMIC), like UpdateVehicleMotion.
+    void Update(float dt, VehicleStore& vehicles, RoadGraph& graph, const Router* router = nullptr);
+
+    double GetClock() const { return clock; }
+    long GetTripCount() const { return tripCount; }    // Teleports passed (end of a trip)
+    long GetMoveCount() const { return moveCount; }    // Road changes
+    long GetStuckCount() const { return stuckCount; }  // Entries forced into a full road
+    int GetRoadCount() const { return (int)edgeTo.size(); }
+
+private:
+    struct Event {
+        double time;
+        int edge;
+    };
+    struct LaterEvent {
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.time != b.time) return a.time > b.time;
+            return a.edge > b.edge; // Same time: road order, the run does not depend on the heap
+        }
+    };
+
+    // --- Roads (slot = graph edge index = edgeBase[from id] + branch) ---
+    std::vector<int> edgeBase;          // Node id -> slot of its first road, -1 if unknown
+    std::vector<int> edgeFrom;
+    std::vector<int> edgeBranch;
+    std::vector<int> edgeTo;
+    std::vector<int> edgeExit;          // Roads into a TELEPORT: the landing road, -1 otherwise/broken
+    std::vector<float> edgeLength;
+    std::vector<int> edgeCapacity;      // Vehicles the road stores
+
+    // Queue of each road: singly linked list through vehNext
+    std::vector<int> queueHead;
+    std::vector<int> queueTail;
+    std::vector<int> queueCount;
+    std::vector<double> nextDeparture;  // Saturation flow: the head cannot leave before this
+
+    // Pending work per road
+    std::vector<double> eventTime;      // Earliest pending event, NO_EVENT if none (older heap entries are stale)
+    std::vector<int> waitingOn;         // Road whose room we wait for, -1 if none
+    std::vector<int> waitNext;          // Next road waiting on the same one
+    std::vector<int> waitHead;          // First road waiting for room here
+    std::vector<unsigned char> lightBlocked;
+    std::vector<int> lightWaiting;      // Heads held by a red light, checked every Update
+    std::priority_queue<Event, std::vector<Event>, LaterEvent> events;
+
+    // --- Vehicles (VehicleStore index) ---
+    std::vector<int> vehEdge;           // Road, -1 if not inserted
+    std::vector<int> vehNext;           // Next vehicle in the same queue
+    std::vector<double> vehEnter;
+    std::vector<double> vehReady;       // Free-flow arrival at the end of the road
+    std::vector<double> vehBlocked;     // Since when the head waits for room downstream, -1 if not
+    std::vector<int> vehChoice;         // Branch picked at the end of the road, -1 = not yet
+    std::vector<unsigned char> vehJumped; // Teleported this tick (no render interpolation)
+
+    double clock = 0.0;
+    long tripCount = 0;
+    long moveCount = 0;
+    long stuckCount = 0;
+
+    int FindEdge(int fromId, int branch) const;
+    void Schedule(int edge, double time);
+    void StopWaiting(int edge); // Off the wait list of the road it waits on
+    void Discharge(int edge, double time, VehicleStore& vehicles, RoadGraph& graph, const Router* router);
+    void Move(int v, int from, int to, double time, VehicleStore& vehicles, RoadGraph& graph);
+    void Dequeue(int v, int from, double time, VehicleStore& vehicles, RoadGraph& graph);
+    // Head v of 'from' leaves the network (SimulationConfig::VehiclesLeaveAtExits): its slot is freed
+    void Leave(int v, int from, double time, VehicleStore& vehicles, RoadGraph& graph);
+    void PlaceVehicles(VehicleStore& vehicles, const RoadGraph& graph);
+    void ResizeVehicles(int count);
+};
+
+#endif // MESO_ENGINE_H
@@ -0,0 +1,75 @@
+#ifndef OSM_IMPORT_H
+#define OSM_IMPORT_H
+
+#include <string>
+#include <vector>
+
+#include "roadgraph.h"
+#include "road_network_file.h"
+
+// =============================================================================
+//  OPENSTREETMAP IMPORT
+//  Offline: reads a local OSM XML extract (.osm) and builds a drivable network
+//  in the simulator's conventions (right-hand traffic, lanes 2.5m / 6.75m off
+//  the centreline like the built-in map).
+//
+//  The file is streamed twice through a fixed-size buffer, the way osmium and
+//  friends do it: pass 1 keeps the highway ways (node refs + a few tags),
+//  pass 2 keeps the coordinates of the nodes those ways use and stops at the
+//  first way. Memory follows the size of the road network, not of the file
+//  (buildings, landuse, relations... are skipped while reading).
+//
+//  Geometry:
+//    - ways are split into links at junctions (nodes shared by several ways)
+//    - every carriageway gets its lanes, offset to the right, trimmed back
+//      from the junctions; interior polyline points become ARC nodes
+//    - junction turns are curved ARC chains from each stop line (DECISION) to
+//      the lanes leaving the junction (right turns from the right lane, left
+//      turns from the left one, straight on from all)
+//    - dead ends are the boundary: lanes leaving the map end on a TELEPORT,
+//      lanes entering it start on a START
+//    - highway=traffic_signals junctions get one controller per approach and
+//      a two-stage plan (approaches grouped by axis)
+//  Lanes and turns are generated in parallel (WorkerPool), ids are assigned in
+//  a serial pass in between, so the output does not depend on the thread count.
+//
+//  PBF extracts are not read (zlib + protobuf): convert them first, e.g.
+//  "osmium cat city.osm.pbf -o city.osm".
+// =============================================================================
+
+struct OsmImportOptions {
+    int threads = 0;                // 0 = hardware concurrency
+    float junctionRadius = 10.0f;   // Lanes stop this far from the junction node (turn room)
+    int turnSegments = 4;           // ARC segments per curved turn
+    float signalGreen = 20.0f;      // Green per stage of the generated plans
+    float signalYellow = 3.0f;
+    float signalAllRed = 2.0f;
+};
+
+struct OsmImportStats {
+    long long bytesRead = 0;        // Both passes
+    int roadWays = 0;               // Highway ways kept
+    int skippedWays = 0;            // Other ways (buildings, footways...)
+    int osmNodes = 0;               // Nodes used by the kept ways
+    int junctions = 0;
+    int boundaries = 0;             // Dead ends (START/TELEPORT pairs)
+    int links = 0;
+    int lanes = 0;
+    int turns = 0;
+    int signals = 0;                // Signalised junctions
+    double readMs = 0.0;
+    double geometryMs = 0.0;
+};
+
+// An imported network, ready for WriteRoadNetworkText or direct use
+struct OsmNetwork {
+    RoadGraph graph;
+    std::vector<NetworkLight> lights;
+    std::vector<NetworkPlan> plans;
+};
+
+// false on error (message in error). stats is optional
+bool ImportOsm(const char* path, const OsmImportOptions& options, OsmNetwork& out,
+               std::string& error, OsmImportStats* stats = nullptr);
+
+#endif // OSM_IMPORT_H
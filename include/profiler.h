@@ -0,0 +1,68 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// =============================================================================
+//  FRAME PROFILER
+//  Scoped timers for the main loop: PROFILE_SCOPE("UpdateVehicles") measures
+//  until the end of the enclosing block. When the profiler is off a scope costs
+//  one bool test; building with -DTRAFFIC_PROFILER_DISABLED removes it entirely.
+//  Main thread only (worker pool chunks are not timed individually).
+// =============================================================================
+
+namespace Profiler {
+    // Rolling statistics of one named section
+    struct SectionStats {
+        const char* name;
+        float avgMs;    // Average time per frame over the last HISTORY_FRAMES frames
+        float maxMs;    // Worst frame in that window
+        int calls;      // Calls in the last completed frame
+    };
+
+    const int HISTORY_FRAMES = 120;
+
+    extern bool enabled;
+
+    void SetEnabled(bool on);
+    inline bool IsEnabled() { return enabled; }
+
+    // Closes the current frame (call once per rendered frame)
+    void EndFrame();
+
+    // Sections in first-seen order
+    int GetSectionCount();
+    SectionStats GetSection(int index);
+
+    // Chrome trace capture (chrome://tracing or ui.perfetto.dev).
+    // BeginTrace also enables the profiler; EndTrace writes the file and returns false on I/O error.
+    void BeginTrace();
+    bool IsTracing();
+    bool EndTrace(const char* path);
+
+    // Rolling HUD (profiler_draw.cpp, not part of the headless core)
+    void DrawHud(int x, int y, int fontSize);
+
+    // --- Internals used by Scope ---
+    long long NowNs();
+    void Record(const char* name, long long startNs, long long endNs);
+
+    class Scope {
+    public:
+        explicit Scope(const char* sectionName) : name(sectionName), start(enabled ? NowNs() : 0) {}
+        ~Scope() { if (start != 0) Record(name, start, NowNs()); }
+    private:
+        const char* name;
+        long long start;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef TRAFFIC_PROFILER_DISABLED
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+// name must be a string literal (sections are keyed by pointer)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,14 @@
+#ifndef ROAD_NETWORK_H
+#define ROAD_NETWORK_H
+
+#include "roadgraph.h"
+#include <utility>
+
+// Builds a chain of ARC nodes along a circle (entry/exit are DECISION nodes)
+// Returns {firstNodeID, lastNodeID}
+std::pair<int, int> addArcPath(RoadGraph& graph, Vector3 center, float radius, float startAngle, float endAngle, int segments);
+
+// Gère l'initialisation de tous les nœuds et arcs (Logique)
+void InitializeRoadNetwork(RoadGraph& graph);
+
+#endif
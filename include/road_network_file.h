@@ -0,0 +1,148 @@
+#ifndef ROAD_NETWORK_FILE_H
+#define ROAD_NETWORK_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "roadgraph.h"
+#include "mapped_file.h"
+
+class TrafficManager; // traffic_manager.h
+
+// =============================================================================
+//  ROAD NETWORK FILES
+//  Text (.roadnet): one item per line, '#' starts a comment. Ids are node ids
+//  (controller ids for plan/stage). Angles in degrees, times in seconds.
+//    node     <id> <x> <y> <z> <start|teleport|decision|arc>
+//    arc      <firstId> <cx> <cy> <cz> <radius> <startAngle> <endAngle> <segments>
+//             (nodes firstId..firstId+segments along the circle, chained, like addArcPath)
+//    connect  <from> <to> [<to> ...]       (branch order = order of appearance)
+//    teleport <node> <target>
+//    light    <controllerId> <x> <y> <z> <rotation> <startRed> <green> <yellow> <red> <nodeId> [...]
+//    plan     <planId> <yellow> <allRed> <offset> <controllerId> [...]
+//    stage    <planId> <green> <controllerId> [...]
+//
+//  Binary (.roadbin): the compiled form, a flat little-endian blob that is mmapped
+//  and read in place (no parsing). Header, then the sections below back to back.
+//  Edges are CSR: node k's successors are edges[nodes[k].firstEdge .. + edgeCount].
+// =============================================================================
+
+namespace RoadNetBlob {
+    const char MAGIC[8] = { 'R', 'O', 'A', 'D', 'N', 'E', 'T', '1' };
+    const uint32_t VERSION = 1;
+
+    // Node ids index dense tables (RoadGraph, lights, spawner): a map of N nodes may use
+    // ids up to 4N + 1024, so a stray huge id cannot make the loader allocate gigabytes
+    inline bool IsNodeIdInRange(int64_t id, uint64_t nodeCount) {
+        return id >= 0 && (uint64_t)id < 4 * nodeCount + 1024;
+    }
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t fileSize;
+        uint32_t nodeCount;
+        uint32_t edgeCount;
+        uint32_t controllerCount;
+        uint32_t planCount;
+        uint32_t stageCount;
+        uint32_t idCount;           // Shared id list (controller nodes, plan/stage controllers)
+    };
+
+    struct NodeRecord {
+        int32_t id;
+        float x, y, z;
+        int32_t type;               // NodeType
+        int32_t teleportTarget;
+        uint32_t firstEdge;
+        uint32_t edgeCount;
+    };
+
+    struct ControllerRecord {
+        int32_t id;
+        float x, y, z;
+        float rotation;
+        float startRed, green, yellow, red;
+        uint32_t firstId, idCount;  // Managed node ids
+    };
+
+    struct PlanRecord {
+        int32_t id;
+        float yellow, allRed, offset;
+        uint32_t firstId, idCount;  // Signal groups (controller ids)
+        uint32_t firstStage, stageCount;
+    };
+
+    struct StageRecord {
+        float green;
+        uint32_t firstId, idCount;  // Controllers turned green
+    };
+}
+
+class RoadNetworkFile {
+public:
+    // Text or binary, picked from the first bytes. false on error (see GetError)
+    bool Load(const char* path);
+    bool LoadText(const char* path);
+    bool LoadBinary(const char* path);   // mmap, validated but not copied
+    bool SaveBinary(const char* path) const;
+    void Unload();
+
+    bool IsLoaded() const { return header != nullptr; }
+    const std::string& GetError() const { return error; }
+    int GetNodeCount() const { return header ? (int)header->nodeCount : 0; }
+    int GetEdgeCount() const { return header ? (int)header->edgeCount : 0; }
+    int GetControllerCount() const { return header ? (int)header->controllerCount : 0; }
+    size_t GetByteSize() const { return header ? header->fileSize : 0; }
+
+    // Replaces the graph's nodes with the file's (one pass over the blob)
+    void BuildGraph(RoadGraph& graph) const;
+    // Adds the controllers, then the signal plans with their stages and offsets
+    void ConfigureLights(TrafficManager& lights) const;
+
+private:
+    MappedFile mapped;                  // Binary files
+    std::vector<uint32_t> owned;        // Compiled text files (uint32_t keeps the records aligned)
+    std::string error;
+
+    // Views into the blob
+    const RoadNetBlob::Header* header = nullptr;
+    const RoadNetBlob::NodeRecord* nodes = nullptr;
+    const int32_t* edges = nullptr;
+    const RoadNetBlob::ControllerRecord* controllers = nullptr;
+    const RoadNetBlob::PlanRecord* plans = nullptr;
+    const RoadNetBlob::StageRecord* stages = nullptr;
+    const int32_t* ids = nullptr;
+
+    bool Attach(const unsigned char* data, size_t size);
+};
+
+// Lights and plans as written to text files (generated maps, see osm_import.h)
+struct NetworkLight {
+    int id;
+    Vector3 position;
+    float rotation;
+    float startRed, green, yellow, red;
+    std::vector<int> nodeIds;
+};
+
+struct NetworkStage {
+    float green;
+    std::vector<int> controllerIds;
+};
+
+struct NetworkPlan {
+    int id;
+    float yellow, allRed, offset;
+    std::vector<int> controllerIds;
+    std::vector<NetworkStage> stages;
+};
+
+// Writes the nodes, connections and teleports of a graph in the text format,
+// then the lights and plans if any
+bool WriteRoadNetworkText(const RoadGraph& graph, const char* path,
+                          const std::vector<NetworkLight>& lights = std::vector<NetworkLight>(),
+                          const std::vector<NetworkPlan>& plans = std::vector<NetworkPlan>());
+
+#endif // ROAD_NETWORK_FILE_H
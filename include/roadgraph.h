@@ -14,40 +14,107 @@ enum LightState {
     LIGHT_RED
 };
 
+// Id returned by lookups that did not find a node
+const int INVALID_NODE_ID = -1;
+
+// Live travel time of one road (one per edge of the frozen adjacency).
+// travelTime is an exponential average of length / mean speed of the vehicles on the
+// road; with nobody on it the estimate drifts back to freeFlowTime (applied lazily on read).
+struct EdgeTraffic {
+    float freeFlowTime = 0.0f;  // Length / RoadGraph::FREE_FLOW_SPEED
+    float travelTime = 0.0f;
+    double lastUpdate = 0.0;    // RoadGraph travel clock of the last blend
+    float speedSum = 0.0f;      // Samples of the current tick
+    int samples = 0;
+};
+
 struct Node {
     int id;
     Vector3 pos;
     NodeType type;
     LightState lightState = LIGHT_NONE;
-    std::vector<int> nextNodes;
+    std::vector<int> nextNodes;         // Construction; RoadGraph::Freeze() packs them as CSR edges
     int teleportTargetId;
 
 
     Node(int id = 0, Vector3 p = {0,0,0}, NodeType t = DECISION) 
         : id(id), pos(p), type(t), lightState(LIGHT_NONE), teleportTargetId(-1) {}
+
+    bool IsValid() const { return id != INVALID_NODE_ID; }
 };
 
 class RoadGraph {
 private:
     std::vector<Node> nodes; // Conteneur interne des noeuds
+    std::vector<int> indexById; // id -> index in 'nodes' (-1 if the id is unused)
+    Node invalidNode;           // Returned by GetNode() when the id does not exist
+
+    // Frozen adjacency (CSR), rebuilt by Freeze() after AddNode/ConnectNodes/Clear.
+    // A derived cache: mutable so const readers (Router::Build...) can freeze on first use.
+    mutable bool frozen = false;
+    mutable std::vector<int> edgeBegin;             // Node index -> first edge (size = nodes + 1)
+    mutable std::vector<int> edgeTarget;            // Edge -> target node index, -1 if the id is unknown
+    mutable std::vector<float> edgeLength;
+    mutable std::vector<EdgeTraffic> edgeTraffic;
+
+    // Travel times: roads (edges) sampled this tick
+    std::vector<int> sampledEdges;
+    double travelClock = 0.0;   // Seconds; a float stops advancing by 1/60 after ~6 simulated days
 
 public:
+    static constexpr float FREE_FLOW_SPEED = 15.0f;     // Reference speed of an empty road (CAR_SPEED)
+    static constexpr float TRAVEL_TIME_MEMORY = 10.0f;  // Seconds for an estimate to fade (EWMA time constant)
+    static constexpr float MIN_SAMPLE_SPEED = 1.0f;     // Stopped vehicles count as crawling (no infinite times)
+
     RoadGraph();
     ~RoadGraph();
 
     // Allow cleaning the graph
     void Clear();
+    void Reserve(int nodeCount); // Before a bulk load (RoadNetworkFile::BuildGraph)
 
     // Méthodes de gestion (Mélange de votre logique et celle du collègue)
-    void AddNode(int id, Vector3 pos, NodeType type);
+    // false (nothing added) for a negative or already used id
+    bool AddNode(int id, Vector3 pos, NodeType type);
     void ConnectNodes(int fromId, int toId);
-    Node& GetNode(int id); // Accès sécurisé au noeud
+    Node& GetNode(int id); // O(1). Returns a node with id == INVALID_NODE_ID if missing
+    const Node& GetNode(int id) const;
+    Node* FindNode(int id); // O(1). nullptr if missing
+    const Node* FindNode(int id) const;
+    bool HasNode(int id) const;
     const std::vector<Node>& GetAllNodes() const;
+    int GetNodeIndex(int id) const; // Index in GetAllNodes(), -1 if missing
+
+    // ----- Frozen adjacency (CSR) -----
+    // Node index k owns the edges [GetEdgeBegin(k), GetEdgeEnd(k)), in nextNodes order
+    // (edge - GetEdgeBegin(k) = branch). One array per attribute, no per-node allocation.
+    // Freeze() packs them once the graph is built (no-op when up to date); the accessors
+    // below expect a frozen graph. Freeze before sharing the graph between threads.
+    void Freeze() const;
+    bool IsFrozen() const { return frozen; }
+    int GetEdgeCount() const { return (int)edgeTarget.size(); }
+    int GetEdgeBegin(int index) const { return edgeBegin[index]; }
+    int GetEdgeEnd(int index) const { return edgeBegin[index + 1]; }
+    int GetEdgeTarget(int edge) const { return edgeTarget[edge]; }
+    float GetEdgeLength(int edge) const { return edgeLength[edge]; }
+    int GetEdge(int fromId, int branch) const; // -1 if there is no such road (freezes if needed)
     
+    // ----- Live travel times (seconds) -----
+    // 'branch' is the index in the source node's nextNodes. Unknown roads return 0.
+    float GetEdgeTravelTime(int fromId, int branch) const;
+    float GetEdgeFreeFlowTime(int fromId, int branch) const;
+    float GetEdgeTravelTime(int edge) const; // Frozen edge index, no lookup
+    // A vehicle driving on the road this tick, at 'speed'
+    void AddEdgeSpeedSample(int fromId, int branch, float speed);
+    void AddEdgeSpeedSample(int edge, float speed);
+    // Blends this tick's samples into the sampled roads (cost = sampled roads only)
+    void UpdateTravelTimes(float dt);
+    double GetTravelClock() const { return travelClock; }
+
     // Pour votre logique de téléportation
     void SetTeleportTarget(int nodeId, int targetId);
 
-    // DESSIN DES SPHÈRES ET DES LIGNES (Dans le monde 3D)
+    // DESSIN DES SPHÈRES ET DES LIGNES (Dans le monde 3D) -> roadgraph_draw.cpp
     void DrawNodes();
 
     // DESSIN DES TEXTES (IDs)
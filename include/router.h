@@ -0,0 +1,127 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include "raylib.h"
+#include <vector>
+
+#include "roadgraph.h"
+
+class VehicleStore;
+
+// Shortest paths (by driven length) over a RoadGraph.
+// Teleports are free jumps: the edge goes from the TELEPORT node straight to the
+// first node after its target (where the vehicle logic sends the car), so a path
+// never has to "choose" anything at the landing node.
+//
+// Queries run A* with a Euclidean heuristic. Because a teleport can beat the straight
+// line, the heuristic is min(straight line, distance to the nearest teleport + distance
+// from the nearest landing point to the goal), which stays admissible.
+// BuildContractionHierarchy() adds a preprocessing step for big maps; FindRoute then
+// uses the bidirectional upward search instead.
+//
+// Queries reuse internal scratch buffers: one Router per thread.
+class Router {
+public:
+    static const int CH_MIN_NODES = 2000;  // Simulation builds the hierarchy above this size
+
+    // Rebuilds the tables from the graph (and drops any hierarchy)
+    void Build(const RoadGraph& graph);
+    void BuildContractionHierarchy();
+    bool HasContractionHierarchy() const { return hasHierarchy; }
+
+    // Node ids from 'fromId' to 'toId', both included. False if unreachable.
+    bool FindRoute(int fromId, int toId, std::vector<int>& path);
+    bool FindRouteAStar(int fromId, int toId, std::vector<int>& path);
+    bool FindRouteCH(int fromId, int toId, std::vector<int>& path);
+    float GetLastCost() const { return lastCost; } // Length of the last route found
+
+    // Trip destinations: the TELEPORT nodes (map exits)
+    const std::vector<int>& GetExitNodes() const { return exitNodes; }
+    int GetNodeCount() const { return (int)nodeIds.size(); }
+    int GetShortcutCount() const { return shortcutCount; }
+
+    // ----- Live times to the exits (ROUTING_DYNAMIC) -----
+    // One table per exit: travel time (RoadGraph live estimates) from every node to it.
+    // UpdateExitTimes refreshes the tables round robin but settles at most 'nodeBudget'
+    // nodes per call (a refresh can span several ticks), and refreshes each table at most
+    // once per call. The rerouting cost per tick depends neither on the vehicle count nor
+    // on the map size.
+    static const int EXIT_NODES_PER_TICK = 256;
+    void UpdateExitTimes(const RoadGraph& graph, int nodeBudget);
+    float GetTimeToExit(int exitId, int nodeId) const; // FLT_MAX if unreachable or not computed
+    // Branch of 'nodeId' with the lowest live time to 'exitId', -1 without data
+    int ChooseFastestBranch(const RoadGraph& graph, int nodeId, int exitId) const;
+
+private:
+    struct Edge {
+        int to;
+        float cost;
+        int middle;     // Contracted node a shortcut skips over, -1 for a real road
+    };
+
+    // Graph in dense indices (CSR: edges of node n are [firstEdge[n], firstEdge[n+1]))
+    std::vector<int> nodeIds;           // Dense index -> node id
+    std::vector<int> indexById;         // Node id -> dense index, -1 if none
+    std::vector<Vector3> positions;
+    std::vector<int> firstEdge;
+    std::vector<Edge> edges;
+    std::vector<int> exitNodes;
+    std::vector<int> exitIndexById;     // Node id -> index in exitNodes, -1 if not an exit
+
+    // Where each edge reads its live time: the graph's frozen edge
+    // (for a teleport edge, the road leaving its landing point)
+    std::vector<int> edgeRoad;
+    std::vector<int> reverseFirst;      // CSR of the reversed graph
+    std::vector<int> reverseEdges;      // Forward edge index, grouped by its destination
+    std::vector<int> edgeSource;
+
+    std::vector<std::vector<float>> exitTimes; // [exit][node index]
+    int nextExitTable = 0;
+    int pendingExit = -1;               // Table being refreshed, -1 = none
+    std::vector<float> pendingTimes;
+    std::vector<std::pair<float, int>> pendingOpen; // Min-heap of the refresh in progress
+
+    // Teleport-aware heuristic
+    std::vector<float> teleportDistance; // Straight line to the nearest TELEPORT node
+    std::vector<Vector3> landingPoints;  // Where the teleports put vehicles
+
+    // Contraction hierarchy: upward edges (forward) and reversed downward edges (backward)
+    bool hasHierarchy = false;
+    int shortcutCount = 0;
+    std::vector<int> rank;
+    std::vector<int> upFirst, downFirst;
+    std::vector<Edge> upEdges, downEdges;
+    std::vector<std::vector<Edge>> hierarchyOut;     // All edges incl. shortcuts (for unpacking)
+
+    // Query scratch (stamped so a query does not clear O(N) arrays)
+    std::vector<float> distFwd, distBwd;
+    std::vector<int> parentFwd, parentBwd;
+    std::vector<int> parentEdgeMiddleFwd, parentEdgeMiddleBwd;
+    std::vector<unsigned int> stampFwd, stampBwd;
+    unsigned int stamp = 0;
+    float lastCost = 0.0f;
+
+    // AssignTrips scratch (per Router, like the query buffers)
+    std::vector<int> tripPath;
+    std::vector<unsigned char> tripChoices;
+    friend void AssignTrips(VehicleStore& vehicles, const RoadGraph& graph, Router& router, bool storeRoutes);
+
+    int IndexOf(int nodeId) const {
+        return (nodeId >= 0 && nodeId < (int)indexById.size()) ? indexById[nodeId] : -1;
+    }
+    void NextStamp();
+    void UnpackEdge(int from, int to, int middle, std::vector<int>& out) const;
+};
+
+// ----- Trips -----
+// Routed vehicles drive from their current target to an exit and follow the branch
+// choices stored in the VehicleStore. Vehicles without a trip get one here (serial: their
+// tripRequest exit if reachable, else SimRandom picks one). Vehicles with no reachable exit
+// fall back to random turns.
+// storeRoutes = false only sets the destination (ROUTING_DYNAMIC picks branches on arrival).
+void AssignTrips(VehicleStore& vehicles, const RoadGraph& graph, Router& router, bool storeRoutes = true);
+
+// Branch index to take at every node of 'path' that has a choice (compact route)
+void MakeRouteChoices(const RoadGraph& graph, const std::vector<int>& path, std::vector<unsigned char>& choices);
+
+#endif // ROUTER_H
@@ -0,0 +1,15 @@
+#ifndef SIM_RANDOM_H
+#define SIM_RANDOM_H
+
+// Random numbers for the simulation core.
+// Replaces raylib's GetRandomValue() so the core does not need raylib's runtime
+// and a given seed always replays the same scenario (headless batch runs).
+namespace SimRandom {
+    // Reset the generator (same seed -> same sequence)
+    void Seed(unsigned int seed);
+
+    // Random integer in [min, max] (both included, like GetRandomValue)
+    int GetValue(int min, int max);
+}
+
+#endif
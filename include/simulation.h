@@ -3,28 +3,77 @@
 
 #include "raylib.h"
 #include <vector>
-#include <memory>
 
 #include "roadgraph.h"
 #include "vehicle.h"
 #include "traffic_manager.h"
 #include "spawner.h"
+#include "worker_pool.h"
+#include "frustum.h"
+#include "router.h"
+#include "meso_engine.h"
+#include "road_network_file.h"
+#include "demand.h"
 
+class StaticScene; // Render side (static_scene.h), only used by Draw3D
+
+// What the last Draw3D culled / simplified (HUD)
+struct RenderStats {
+    CullCounter vehicles;
+    CullCounter buildings;
+    CullCounter lights;
+};
+
+// The simulation core: no window, input or GetFrameTime() in here so it can run headless.
+// Draw3D/DrawOverlay live in simulation_draw.cpp and are only linked by the game.
 class Simulation {
 private:
     RoadGraph roadGraph;
     TrafficManager trafficMgr;
     VehicleSpawner spawner;
-    std::vector<std::unique_ptr<Vehicle>> vehicles;
+    VehicleStore vehicles;
+    Router router;                  // Rebuilt from roadGraph in ApplyConfiguration
+    MesoEngine meso;                // Moves the vehicles instead of trafficMgr + physics with ENGINE_MESO
+    RoadNetworkFile networkFile;    // globalConfig.networkPath, loaded by Init (kept: Apply rebuilds from it)
+    DemandModel demand;             // globalConfig.demandPath, loaded by Init; empty = one-shot spawn queue
+    std::vector<DemandArrival> arrivals;
+    WorkerPool workers;             // Sized from globalConfig.workerThreads in ApplyConfiguration
+
+    // Fixed-step scheduler state
+    double accumulator = 0.0;       // Simulated time not yet consumed by a fixed step
+    float interpolationAlpha = 1.0f; // Fraction of a step between the previous and current state
+    long stepCount = 0;
+
+    const StaticScene* bakedMap = nullptr; // Baked city geometry, nullptr = immediate-mode DrawBasicMap
+    RenderStats renderStats;
 
 public:
     Simulation();
     void Init();
     void ApplyConfiguration();
-    void Update(float dt, Camera3D camera);
-    void Draw3D(bool showDebugNodes); 
+    void Update(float dt);
+
+    // Accumulates frameTime * speed and runs as many FIXED_TIMESTEP updates as needed.
+    // Returns the number of steps run this frame.
+    int Advance(float frameTime, float speed);
+    float GetInterpolationAlpha() const;
+    long GetStepCount() const;
+    void Draw3D(bool showDebugNodes, Camera3D camera); // Between BeginMode3D(camera) and EndMode3D
+    void SetBakedMap(const StaticScene* scene) { bakedMap = scene; }
+    const RenderStats& GetRenderStats() const { return renderStats; }
     void DrawOverlay(bool showDebugNodes, Camera3D camera);
     int GetVehicleCount() const;
+    int GetThreadCount() const { return workers.GetThreadCount(); }
+    const VehicleStore& GetVehicles() const;
+    const TrafficManager& GetTrafficManager() const { return trafficMgr; }
+    const Router& GetRouter() const { return router; }
+    const MesoEngine& GetMesoEngine() const { return meso; }
+    // Map file given by globalConfig.networkPath; not loaded (see GetError) = built-in network
+    const RoadNetworkFile& GetNetworkFile() const { return networkFile; }
+    // OD demand given by globalConfig.demandPath; not loaded (see GetError) = vehicleConfigs
+    const DemandModel& GetDemand() const { return demand; }
+    const VehicleSpawner& GetSpawner() const { return spawner; }
+    void ForceMoveVehicle(VehicleHandle handle, float seconds); // Player "honk": vehicle ignores obstacles for a while
     void Clear();
 };
 
@@ -0,0 +1,44 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "raylib.h"
+#include <vector>
+
+// Forward declaration (the grid only reads positions)
+class VehicleStore;
+
+// Uniform grid over the XZ plane used to answer "who is near me?" queries.
+// It is rebuilt once per tick (counting sort into hashed buckets), so the
+// cost of a tick is O(N) to build + O(neighbors) per query instead of O(N²).
+class SpatialGrid {
+private:
+    float cellSize;
+    float invCellSize;
+
+    // Hashed buckets: entries of bucket b live in [bucketStart[b], bucketStart[b+1])
+    unsigned int bucketMask;
+    std::vector<int> bucketStart;
+    std::vector<int> entries;       // Vehicle indices, grouped by bucket
+
+    // Cell coordinates of every vehicle (used to reject hash collisions)
+    std::vector<int> cellX;
+    std::vector<int> cellZ;
+    std::vector<Vector3> positions;
+
+    int CellCoord(float v) const;
+    unsigned int Bucket(int cx, int cz) const;
+
+public:
+    explicit SpatialGrid(float cellSize = 25.0f);
+
+    // Rebuild the index from the current vehicle positions (finished vehicles are skipped)
+    void Build(const VehicleStore& vehicles);
+
+    // Fills 'out' with the indices of every vehicle within 'radius' of 'center'.
+    // Indices are returned in ascending order so callers iterate like the old full scan.
+    void Query(Vector3 center, float radius, std::vector<int>& out) const;
+
+    float GetCellSize() const { return cellSize; }
+};
+
+#endif // SPATIAL_GRID_H
@@ -1,37 +1,80 @@
 #ifndef SPAWNER_H
 #define SPAWNER_H
 
+#include <deque>
 #include <vector>
-#include <string>
-#include <memory>
 #include "vehicle.h"
 #include "roadgraph.h"
 #include "config.h"
+#include "spatial_grid.h"
+
+class MesoEngine; // meso_engine.h
 
 // Helper struct for the queue
 struct QueuedVehicle {
-    std::string type;
+    VehicleType type;       // VEHICLE_GENERIC = unknown name in the config, never spawned
     int startNodeId;
+    int destinationId = -1; // Exit asked by the demand (VehicleStore::tripRequest), -1 = any
 };
 
+// Waiting vehicles are kept in one FIFO per start node: only the head of each can
+// spawn, and the heads are tried in arrival order (what the old single queue did),
+// so a long queue at a busy entry costs nothing while it is blocked.
 class VehicleSpawner {
 private:
-    std::vector<QueuedVehicle> spawnQueue;
+    struct Waiting {
+        QueuedVehicle vehicle;
+        long order;                     // Arrival number (heads are tried in this order)
+    };
+    struct StartQueue {
+        int nodeId;
+        std::deque<Waiting> fifo;
+    };
+    std::vector<StartQueue> queues;
+    std::vector<int> queueByNode;       // Start node id -> index in queues, -1 if none yet
+    long nextOrder = 0;
+    int waitingCount = 0;
+    long spawnedCount = 0;
+
+    // Clearance: vehicles within SPAWN_CLEARANCE of a start node block it
+    SpatialGrid grid;
+    std::vector<int> nearby;
+    std::vector<Vector3> spawnedNow;    // This pass (not in the grid yet)
+    std::vector<std::pair<long, int>> heads;
 
-    // The "Factory" helper function
-    std::unique_ptr<Vehicle> CreateVehicle(const std::string& type, Vector3 pos, int targetNodeId);
+    bool IsClear(Vector3 pos, const VehicleStore& vehicles);
+    void Spawn(const QueuedVehicle& q, const Node& n, RoadGraph& graph, VehicleStore& vehicles, MesoEngine* meso);
+    void DropQueue(StartQueue& q);
 
 public:
+    static constexpr float SPAWN_CLEARANCE = 8.0f; // Natural "following distance" gap
+
     VehicleSpawner();
 
     // Reloads the queue from Global Config
     void LoadFromConfig();
+    // Same for a map file: configured start nodes that are not START nodes of
+    // this graph are replaced by the graph's own START nodes
+    void LoadFromConfig(const RoadGraph& graph);
+
+    // Adds one vehicle behind the others waiting at its start node (generic types are dropped)
+    void Enqueue(const QueuedVehicle& q);
+
+    // Vehicles that left at an exit come back as new ones at the exit's landing START
+    // (SimulationConfig::leaveAtExits); broken teleports drop them
+    void Requeue(const std::vector<VehicleExit>& exits, const RoadGraph& graph);
+
+    // Spawns the queue heads whose start node is clear (cost: start nodes + vehicles nearby)
+    void Update(RoadGraph& graph, VehicleStore& vehicles);
+
+    // Mesoscopic engine: a vehicle spawns when its first road has room
+    void UpdateMeso(RoadGraph& graph, VehicleStore& vehicles, MesoEngine& meso);
+
+    int GetWaitingCount() const { return waitingCount; }
+    long GetSpawnedCount() const { return spawnedCount; }
 
-    // Checks timers and adds new vehicles to the list if possible
-    void Update(RoadGraph& graph, std::vector<std::unique_ptr<Vehicle>>& vehicles);
-    
     // Clears the queue
     void Clear();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,61 @@
+#ifndef STATIC_SCENE_H
+#define STATIC_SCENE_H
+
+#include "raylib.h"
+#include <vector>
+
+#include "map_draw.h"
+#include "frustum.h"
+
+// ----- Baked Static Scene -----
+// The city (roads, sidewalks, buildings) never moves, so instead of re-issuing
+// hundreds of DrawCube/DrawCylinder calls every frame it is recorded once through
+// MapDraw and uploaded as vertex-colored meshes, one per material.
+// The ground is a single part; every building is its own part with a bounding box,
+// so it can be culled or replaced by a plain box when far away.
+class StaticScene {
+private:
+    struct Part {
+        std::vector<Model> models;  // Opaque first, then translucent
+        int opaqueCount = 0;        // models[0, opaqueCount) are opaque
+        int firstLine = 0;          // Range in 'lines' (wires stay on the rlgl line batch)
+        int lineCount = 0;
+    };
+
+    struct BakedObject {
+        Part part;
+        BoundingBox bounds;
+        Color lodColor;             // Area-weighted average color, for the far box
+    };
+
+    Part ground;
+    std::vector<BakedObject> objects;
+    MapGeometry lines;              // Only the line part is used
+    int meshCount = 0;
+    int triangleCount = 0;
+    bool built = false;
+    mutable std::vector<const Part*> translucentParts; // Draw scratch: near parts, for the last pass
+
+    Part BakePart(MapGeometry& geometry);
+    void AddModel(Part& part, const std::vector<float>& vertices, const std::vector<unsigned char>& colors);
+    void DrawPart(const Part& part) const;         // Opaque models and wires
+    void DrawTranslucent(const Part& part) const;  // After every opaque part (glass must not hide them)
+
+public:
+    // Records drawGround once and drawObject(i) for every object, then uploads. Needs a GL context.
+    void Build(void (*drawGround)(), int objectCount, void (*drawObject)(int index));
+
+    // Everything at full detail
+    void Draw() const;
+    // Skips objects outside the frustum, draws the ones beyond lodDistance as boxes
+    void Draw(const Frustum& frustum, Vector3 cameraPos, float lodDistance, CullCounter& counter) const;
+    void Unload();
+
+    bool IsBuilt() const { return built; }
+    int GetMeshCount() const { return meshCount; }
+    int GetObjectCount() const { return (int)objects.size(); }
+    int GetTriangleCount() const { return triangleCount; }
+    int GetLineCount() const { return lines.GetLineCount(); }
+};
+
+#endif // STATIC_SCENE_H
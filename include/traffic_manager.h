@@ -5,12 +5,28 @@
 #include "raymath.h"
 #include "rlgl.h"
 #include <vector>
-#include <memory>
+#include <queue>
 #include "roadgraph.h"
+#include "spatial_grid.h"
+#include "follow_model.h"
+#include "vehicle.h"
+#include "worker_pool.h"
+#include "follow_kernel.h"
+#include "frustum.h"
 
-// Forward declaration to avoid circular includes
-// (We only need to know 'Vehicle' exists here)
-class Vehicle; 
+// Measured on the vehicles heading for the managed nodes (refreshed every UpdateLights)
+struct ApproachStats {
+    int approaching = 0;        // Vehicles whose target is a managed node
+    int detected = 0;           // ...within the detector distance of the stop line
+    int queued = 0;             // ...of those, stopped (< 1 m/s)
+    int downstream = 0;         // Vehicles heading for the nodes right after the stop line
+    float arrivalRate = 0.0f;   // Vehicles/s joining the approach (smoothed over ~10s)
+
+    // Accumulated since the last ResetApproachStats
+    long served = 0;            // Vehicles that crossed the stop line
+    double totalDelay = 0.0;    // Seconds lost against free flow while on the approach
+    float GetAverageDelay() const { return served > 0 ? (float)(totalDelay / served) : 0.0f; }
+};
 
 // Separated Traffic Controller Struct
 struct TrafficController {
@@ -22,8 +38,14 @@ struct TrafficController {
     
     // State
     LightState currentState;
-    float timer;
+    double phaseStart;         // Scheduler clock when the current state began
+    double frozenElapsed;      // Time spent in the current state when an emergency override froze it
+    unsigned int eventGeneration = 0; // Bumped to cancel the pending phase-change event
     bool isEmergencyOverride = false; // .-. ._.
+    bool inStartDelay = false; // First red is startRedTime long, then durationRed
+    int plan = -1;             // Index of the SignalPlan driving the timings, -1 = own timings
+    double lastDetection = -1.0e9; // Light clock when a vehicle was last inside the detector zone
+    ApproachStats stats;
     
     // Timings
     float startRedTime;// Delay before starting (or initial Red duration)
@@ -32,6 +54,37 @@ struct TrafficController {
     float durationRed;
 };
 
+// ----- Signal Plans -----
+// The controllers (signal groups) of one intersection share a cycle. The cycle is a list
+// of stages, each stage turns a set of non-conflicting groups green; between two stages
+// the groups that stop get yellow, then everyone gets the all-red clearance.
+// A group is green for one run of consecutive stages.
+struct SignalStage {
+    std::vector<int> controllerIds;
+    float green;
+};
+
+struct SignalPlan {
+    int id;
+    std::vector<int> controllerIds;         // Signal groups of the intersection
+    std::vector<unsigned char> conflicts;   // controllerIds.size()^2, 1 = movements cross/merge
+    std::vector<SignalStage> stages;
+    float yellow = 3.0f;
+    float allRed = 1.0f;
+    float offset = 0.0f;                    // Start of the cycle on the light clock (green waves)
+    std::vector<int> controllerIndex;       // Same order as controllerIds, index in the manager
+
+    // Actuated / max-pressure state: the running stage and where it is
+    int activeStage = 0;
+    LightState stageState = LIGHT_RED;      // GREEN, YELLOW, or RED = all-red clearance / rest
+    double stageStart = 0.0;
+
+    float GetCycleLength() const;
+    bool Conflicts(int controllerA, int controllerB) const;
+    // Green window of a group inside the cycle, false if no stage serves it
+    bool GetGreenWindow(int controllerId, float& greenStart, float& greenTime) const;
+};
+
 // The TrafficManager handles collision avoidance and speed regulation.
 // It acts as the "brain" for the simulation's traffic rules.
 class TrafficManager {
@@ -42,15 +95,107 @@ private:
     float detectionRange;   
 
     std::vector<TrafficController> controllers; 
+    std::vector<SignalPlan> plans;
+    SignalControlMode controlMode = SIGNAL_FIXED_TIME;
+    float actuatedMinGreen = 5.0f;
+    float actuatedMaxGreen = 30.0f;
+    float actuatedGap = 3.0f;               // Green ends this long after the last detection
+    float detectorDistance = 30.0f;         // Detector zone before the stop line
+
+    // --- Light Scheduler ---
+    // Lights only do work when a phase ends: one event per controller in a min-heap,
+    // keyed by the scheduler clock. Ticks without a due event only advance the clock.
+    struct LightEvent {
+        double time;
+        int controller;             // Index in 'controllers'
+        unsigned int generation;    // Stale if != controller.eventGeneration
+    };
+    struct LaterEvent {
+        bool operator()(const LightEvent& a, const LightEvent& b) const {
+            if (a.time != b.time) return a.time > b.time;
+            return a.controller > b.controller; // Same time: controller order, like the old loop
+        }
+    };
+    std::priority_queue<LightEvent, std::vector<LightEvent>, LaterEvent> lightEvents;
+    std::vector<LightEvent> dueEvents;  // Scratch
+    double lightClock = 0.0;
+    bool lightsScheduled = false;       // Events are pushed on the first UpdateLights
+    bool nodeLightsDirty = false;       // Plan edits change states outside UpdateLights
+    int overriddenCount = 0;            // Controllers currently held by an emergency vehicle
+    std::vector<int> controllerByNode;  // Node id -> controller index, -1 if not signalized
+    std::vector<int> downstreamByNode;  // Node id -> controller whose stop line leads to it
+    bool downstreamDirty = true;
+    std::vector<int> lastTarget;        // Per vehicle, to count arrivals/departures
+    std::vector<int> arrivals;          // Per controller, scratch
+    bool approachStats = false;         // Measure with fixed-time lights too (see SetApproachStats)
+
+    // --- Neighbor Search ---
+    SpatialGrid grid;               // Rebuilt every tick in UpdateVehicles
+    struct WorkerScratch {
+        std::vector<int> neighbors;     // Grid query results
+        FollowCandidates candidates;    // Neighbors gathered for FindLeader
+    };
+    std::vector<WorkerScratch> workerScratch; // One per thread
+    std::vector<char> yieldRight;   // Per-vehicle flag: an emergency vehicle is right behind us
+
+    // --- Road Occupancy (leader lookup) ---
+    // Every road (frozen edge of the graph, slot = edge index) lists the vehicles driving on
+    // it, ordered by how far along it they are. The leader is the next one on the same road,
+    // or the first one on the roads ahead. Rebuilt every tick in UpdateVehicles.
+    static const int MAX_LANE_LOOKAHEAD = 16;  // Roads followed ahead (arcs are made of short ones)
+    static constexpr float MAX_VEHICLE_LENGTH = 10.0f; // Truck, bounds the crossing check
+    std::vector<int> laneStart;         // Slot -> first entry in laneVehicles (CSR, size slots + 1)
+    std::vector<int> laneVehicles;      // Vehicles grouped by road, by progress
+    std::vector<int> laneSlot;          // Per vehicle, its road (-1 = not on a known road)
+    std::vector<int> lanePos;           // Per vehicle, its entry in laneVehicles
+    std::vector<float> laneProgress;    // Per vehicle, distance driven along its road
+    const Router* laneRouter = nullptr; // ROUTING_DYNAMIC branch picks (set by UpdateVehicles)
+
+    // --- Car-Following Models ---
+    FollowInputs followInputs;          // Written by UpdateVehicle, read by the model pass
+    std::vector<int> modelStart;        // Model -> first entry in modelVehicles (size FOLLOW_MODEL_COUNT + 1)
+    std::vector<int> modelVehicles;     // Vehicles grouped by model
+    std::vector<int> modelCursor;       // Scratch
+    unsigned int followStep = 0;
+
+    // --- Front Buffer ---
+    // Copy of the state taken at the start of UpdateVehicles. Reads of OTHER vehicles go here,
+    // writes go to the VehicleStore, so vehicles can be updated in any order / in parallel.
+    std::vector<float> frontSpeed;
+    std::vector<float> frontLateralOffset;
 
     // --- Internal Helper Functions ---
     float GetDistance(const Vector3& a, const Vector3& b);  // Calculates Euclidean distance between two 3D points
     bool AreSameDirection(const Vector3& dir1, const Vector3& dir2);  // Direction Check (Are we parallel?)
-    bool IsInMyLane(Vehicle* me, Vehicle* other);  // Lane Check (Only for parallel cars)
+    bool IsInMyLane(const VehicleStore& vs, int me, int other);  // Lane Check (Only for parallel cars)
     float Lerp(float start, float end, float amount);   // Linear Interpolation helper for smooth braking
+    float GetPhaseDuration(const TrafficController& ctrl) const;
+    void ScheduleLight(int index);      // Pushes the end of the current phase
+    void ApplyLightState(int index, RoadGraph& map);
+    void StartLightScheduler(RoadGraph& map);
+    int FindController(int controllerId) const;
+    SignalPlan* FindPlan(int planId);
+    void SyncPlanLights(int planIndex);     // Puts the plan's groups where its cycle is now
+    bool IsActuated(const TrafficController& ctrl) const { return controlMode != SIGNAL_FIXED_TIME && ctrl.plan != -1; }
+    bool MeasuresApproaches() const { return controlMode != SIGNAL_FIXED_TIME || approachStats; }
+    void MeasureApproaches(float dt, const RoadGraph& map, const VehicleStore& vehicles);
+    void ResetActuatedPlan(int planIndex);
+    void UpdateActuatedPlan(int planIndex, RoadGraph& map);
+    int GetStageDemand(const SignalPlan& plan, int stage) const;
+    int GetStagePressure(const SignalPlan& plan, int stage) const;
+    bool ShouldEndStage(const SignalPlan& plan, double elapsed) const;
+    int PickNextStage(const SignalPlan& plan) const;
+    void UpdateVehicle(int i, float dt, VehicleStore& vehicles, const RoadGraph& map, WorkerScratch& scratch);
+    void BuildLanes(const VehicleStore& vehicles, const RoadGraph& map);
+    FollowResult FindLaneLeader(int i, float range, const VehicleStore& vehicles, const RoadGraph& map) const;
+    void ScanLanesAhead(int i, int node, float distance, float range, int depth, int choicesAhead,
+                        const VehicleStore& vehicles, const RoadGraph& map, FollowResult& best) const;
+    int GetPlannedBranch(int i, const Node& node, int choicesAhead, const VehicleStore& vehicles, const RoadGraph& map) const;
+    bool IsPassable(int me, int other) const; // 'other' has moved out of our lane (yielding)
 
-    // NEW: Specific rendering function for lights
+    // NEW: Specific rendering function for lights (traffic_manager_draw.cpp)
     void DrawTrafficLightModel(Vector3 pos, float angleY, LightState state);
+    void DrawTrafficLightSimple(Vector3 pos, float angleY, LightState state); // Far LOD: pole + lit box
 
 public:
     // Constructor with default safety values
@@ -60,12 +205,57 @@ public:
     void AddController(int id, std::vector<int> nodeIds);
     void ConfigureTrafficLight(int controllerId, Vector3 position, float rotation, float startRedTime, float greenTime, float yellowTime, float redTime);
     
-    // Draw Loop
-    void Draw();
+    // Phase plans (see SignalPlan). Add the controllers first; a controller
+    // belongs to one plan, which replaces its ConfigureTrafficLight timings.
+    void AddSignalPlan(int planId, std::vector<int> controllerIds, float yellow = 3.0f, float allRed = 1.0f);
+    void SetConflict(int planId, int controllerA, int controllerB);
+    bool AddStage(int planId, std::vector<int> controllerIds, float green); // false if two groups conflict
+    void SetPlanOffset(int planId, float offset);
+    const SignalPlan* GetSignalPlan(int planId) const;
+
+    // Actuated / max-pressure control of the planned lights (own-timing controllers stay fixed)
+    void SetControlMode(SignalControlMode mode);
+    SignalControlMode GetControlMode() const { return controlMode; }
+    void SetActuatedTimings(float minGreen, float maxGreen, float gap, float detectorDist = 30.0f);
+
+    // Leader on the road occupancy lists built by the last UpdateVehicles, -1 if none.
+    // Searched again within detectionRange + 2 s at the current speed, not the tick's own range.
+    int GetLaneLeader(const VehicleStore& vehicles, const RoadGraph& map, int i) const;
+
+    // Per-approach measurements
+    int GetControllerCount() const { return (int)controllers.size(); }
+    const TrafficController& GetController(int index) const { return controllers[index]; }
+    void ResetApproachStats();
+    // Fixed-time lights skip the per-approach scan (it walks every vehicle each tick);
+    // turn it on to get served/delay figures anyway. Actuated modes always measure.
+    void SetApproachStats(bool enabled);
+
+    // Green wave: shifts the plan offsets along a corridor (signalized nodes in driving order)
+    // so a platoon leaving the reference stop line at the start of green, at progressionSpeed,
+    // reaches every other stop line as it turns green. Distances follow the road graph.
+    // Plans on the corridor must share a cycle length; returns false otherwise (or no path).
+    bool SolveGreenWave(const RoadGraph& map, const std::vector<int>& corridorNodes, float progressionSpeed, int referenceIndex = 0);
+
+    // Controller managing nodeId (index in the controller list), -1 if none. O(1).
+    int GetControllerForNode(int nodeId) const {
+        return (nodeId >= 0 && nodeId < (int)controllerByNode.size()) ? controllerByNode[nodeId] : -1;
+    }
+    LightState GetLightStateForNode(int nodeId) const {
+        int c = GetControllerForNode(nodeId);
+        return c >= 0 ? controllers[c].currentState : LIGHT_NONE;
+    }
+
+    // Rewrites node.lightState for every managed node (after the graph was rebuilt)
+    void SyncNodeLights(RoadGraph& map);
+
+    // Draw Loop (traffic_manager_draw.cpp, not part of the headless core)
+    // Lights outside the frustum are skipped, far ones use the simple model
+    void Draw(const Frustum& frustum, Vector3 cameraPos, CullCounter& counter);
     
     // Update Loops
-    void UpdateLights(float dt, RoadGraph& map, const std::vector<std::unique_ptr<Vehicle>>& vehicles); 
-    void UpdateVehicles(std::vector<std::unique_ptr<Vehicle>>& vehicles, const RoadGraph& map);
+    void UpdateLights(float dt, RoadGraph& map, const VehicleStore& vehicles); 
+    // router != nullptr: live fastest branches (ROUTING_DYNAMIC), like UpdateVehicleMotion
+    void UpdateVehicles(float dt, VehicleStore& vehicles, const RoadGraph& map, WorkerPool* pool = nullptr, const Router* router = nullptr);
 };
 
 #endif // TRAFFIC_MANAGER_H
\ No newline at end of file
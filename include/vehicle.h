@@ -3,128 +3,195 @@
 
 #include "raylib.h"
 #include <vector>
+#include <string>
 #include <cmath>
-#include <memory>
 
 #include "config.h"    // Pour CONFIG::TRUCK_SPEED, etc.
 #include "roadgraph.h" // Pour la classe RoadGraph et la structure Node
-#include "model_manager.h" // Pour la gestion des modèles 3D
+#include "worker_pool.h"
+#include "spatial_grid.h"
+
+class Router; // router.h
+
+// Type tag: indexes the parameter table below (and picks the model in vehicle_draw.cpp)
+enum VehicleType {
+    VEHICLE_GENERIC = 0,
+    VEHICLE_CAR,
+    VEHICLE_BUS,
+    VEHICLE_TRUCK,
+    VEHICLE_TAXI,
+    VEHICLE_POLICE,
+    VEHICLE_MOTORCYCLE,
+    VEHICLE_AMBULANCE,
+    VEHICLE_TYPE_COUNT
+};
 
-// ----- Classes de Base -----
-class Vehicle {
-public:
-    Vector3 position;
-    Vector3 forward;
-    float speed;
+// Car-following parameters (follow_model.h). FOLLOW_LEGACY ignores them.
+struct FollowParams {
+    FollowModel model;
+    float maxAccel;       // m/s^2
+    float comfortDecel;   // m/s^2, IDM b / Gipps and Krauss braking
+    float maxDecel;       // m/s^2, hard limit of any model
+    float minGap;         // m, standstill gap (IDM s0)
+    float timeHeadway;    // s, IDM T
+    float reactionTime;   // s, Gipps and Krauss tau
+    float sigma;          // Krauss dawdling (0 = perfect driver)
+};
+
+// ----- Per-Type Parameters -----
+// Everything that used to differ between the Car/Bus/Truck/... subclasses.
+struct VehicleTypeParams {
+    const char* name;       // Name used by the spawn config ("Car", "Police", ...)
+    const char* modelName;  // ModelManager key
+    Color color;
     float desiredSpeed;
     float length;
-    int targetNodeId;
-    Color color;
-    Color originalColor;
-    bool finished = false;
-    float forceMoveTimer = 0.0f;
-
-    //.-. yielding 
-    float lateralOffset = 0.0f;
-
-    // Static model manager (shared by all vehicles)
-    static ModelManager* modelManager;
+    float drawScale;
+    bool isEmergency;
 
-    // NEW: Model type identifier
-    std::string modelType;
+    // Siren: color alternates every 0.25s between flashColorA and flashColorB
+    bool hasSiren;
+    Color flashColorA;
+    Color flashColorB;
 
-    // Constructeur
-    Vehicle(Vector3 pos, int initialTargetId);
-
-    virtual ~Vehicle();
-
-    // NEW: Virtual method to identify emergency vehicles
-    virtual bool IsEmergency() const { return false; }
-
-    // MISE À JOUR : Utilise RoadGraph au lieu de std::vector<Node>
-    virtual void update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>>& allVehicles);
-
-    virtual void draw();
+    FollowParams follow;
 };
 
-class Car : public Vehicle {
-public:
-    // Pass pos and targetId to the base Vehicle constructor
-    Car(Vector3 pos, int targetId);
-
-    // Override the draw function to render a detailed car
-    void draw() override;
-};
+const VehicleTypeParams& GetVehicleTypeParams(VehicleType type);
 
-class Bus : public Vehicle {
-public:
-    // Pass pos and targetId to the base Vehicle constructor
-    Bus(Vector3 pos, int targetId);
+// Returns VEHICLE_GENERIC for unknown names
+VehicleType VehicleTypeFromName(const std::string& name);
 
-    void draw() override;
+// Stable reference to a vehicle: its slot plus the slot's generation when it was taken.
+// Once the vehicle is removed (and the slot maybe reused) the handle resolves to -1.
+struct VehicleHandle {
+    int index = -1;
+    unsigned generation = 0;
 };
 
-class Truck : public Vehicle {
-public:
-    Truck(Vector3 pos, int targetId);
-
-    void draw() override;
+// A vehicle that left the network at an exit (TELEPORT node)
+struct VehicleExit {
+    VehicleType type;
+    int exitNodeId;
 };
 
-class Taxi : public Vehicle {
-private:
-    float signBlinkTimer = 0.0f;
-    
-public:
-    // Constructeur adapté à votre système (position + cible)
-    Taxi(Vector3 pos, int targetId);
-
-    // Mise à jour de la logique spécifique (clignotant du toit)
-    void update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) override;
-
-    void draw() override;
+// Slot usage of a VehicleStore (HUD, headless report)
+struct VehiclePoolStats {
+    int slots = 0;              // Size(): live + free
+    int live = 0;
+    int freeSlots = 0;
+    long long spawned = 0;      // Add() calls since the last Clear()
+    long long recycled = 0;     // ... that reused a freed slot
+    long long removed = 0;
+    size_t bytes = 0;           // Reserved by the per-vehicle arrays
 };
 
-//.-. Ambulance Class
-class Ambulance : public Vehicle {
-private:
-    float sirenTimer = 0.0f;
+// ----- Vehicle Storage (Structure of Arrays) -----
+// Vehicle i is the i-th entry of every array. Hot loops read only the arrays they need,
+// contiguously, instead of chasing one heap object per vehicle.
+//
+// Slots are pooled: a vehicle keeps its index for its whole life, Remove() frees it
+// (finished = 1, loops skip it) and Add() takes the most recently freed slot before
+// growing the arrays. Both are O(1); the store only grows with the peak vehicle count.
+class VehicleStore {
 public:
-    Ambulance(Vector3 pos, int targetId);
-    void update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) override;
-    void draw() override;
-    bool IsEmergency() const override { return true; }
-};
+    std::vector<Vector3> position;
+    std::vector<Vector3> forward;
+    std::vector<Vector3> prevPosition;  // State before the last fixed step (render interpolation)
+    std::vector<Vector3> prevForward;
+    std::vector<float> speed;
+    std::vector<float> desiredSpeed;
+    std::vector<float> length;
+    std::vector<float> lateralOffset;   //.-. yielding
+    std::vector<float> forceMoveTimer;
+    std::vector<float> effectTimer;     // Clock for visual effects (siren flashing, taxi sign blink)
+    std::vector<int> targetNodeId;
+    std::vector<int> edgeFromId;        // Road being driven: edgeFromId's nextNodes[edgeBranch] (-1 = unknown, just spawned)
+    std::vector<int> edgeBranch;
+    std::vector<VehicleType> type;
+    std::vector<Color> color;
+    std::vector<unsigned char> finished;    // Free slot (removed vehicle, waiting for reuse)
+    std::vector<unsigned char> followModel; // FollowModel (type default unless SimulationConfig::followModel)
+
+    // ----- Trips (SimulationConfig::routing == ROUTING_TRIPS, see router.h) -----
+    // The route is stored compactly: one byte per node with a choice (branch index),
+    // in a pool shared by all vehicles. [routeCursor, routeEnd) is what is left to drive.
+    static const int TRIP_NONE = -1;    // Needs a trip (AssignTrips)
+    static const int TRIP_RANDOM = -2;  // No reachable exit: random turns until the next teleport
+    std::vector<int> tripDestination;
+    std::vector<int> tripRequest;       // Exit asked by the demand (OD matrix) for the next trip, -1 = any
+    std::vector<int> routeCursor;
+    std::vector<int> routeEnd;
+
+    // Vehicles that left at an exit since the last Simulation::Update (re-queued by the spawner)
+    std::vector<VehicleExit> exits;
+
+    // Adds a vehicle with its type defaults, returns its index
+    int Add(VehicleType vehicleType, Vector3 pos, int initialTargetId);
+    // Frees slot i (no-op if already free); handles to it go stale
+    void Remove(int i);
+    void Clear();
+    int Size() const { return (int)position.size(); } // Slots, free ones included
+    int GetLiveCount() const { return Size() - (int)freeSlots.size(); }
+    VehicleHandle GetHandle(int i) const { return { i, generation[i] }; }
+    // Index of the handle's vehicle, -1 if it was removed
+    int Resolve(VehicleHandle handle) const {
+        if (handle.index < 0 || handle.index >= Size()) return -1;
+        if (generation[handle.index] != handle.generation || finished[handle.index]) return -1;
+        return handle.index;
+    }
+    VehiclePoolStats GetPoolStats() const;
+    bool IsEmergency(int i) const { return GetVehicleTypeParams(type[i]).isEmergency; }
+    int GetEmergencyCount() const { return emergencyCount; } // Lets UpdateLights skip its scan
+
+    // Replaces the route of vehicle i
+    void SetRoute(int i, int destination, const std::vector<unsigned char>& choices);
+    // Next branch index of vehicle i's route, -1 once the route is used up
+    int NextRouteChoice(int i) {
+        if (routeCursor[i] >= routeEnd[i]) return -1;
+        return routeChoices[routeCursor[i]++];
+    }
+    // Branch of the route 'ahead' choices after the next one (0 = what NextRouteChoice returns), -1 past its end
+    int PeekRouteChoice(int i, int ahead) const {
+        int k = routeCursor[i] + ahead;
+        return k < routeEnd[i] ? routeChoices[k] : -1;
+    }
+    int GetRoutePoolSize() const { return (int)routeChoices.size(); }
 
-class PoliceCar : public Vehicle {
 private:
-    float sirenTimer = 0.0f;
-    
-public:
-    // Constructeur adapté : prend la position de départ et l'ID du premier noeud cible
-    PoliceCar(Vector3 pos, int targetId);
-
-    // Mise à jour de la sirène et de la navigation
-    void update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) override;
-
-    void draw() override;
-
-    bool IsEmergency() const override { return true; }
+    int emergencyCount = 0;
+
+    // Pool
+    std::vector<unsigned> generation;   // Bumped by Remove()
+    std::vector<int> freeSlots;         // LIFO: the warmest slot is reused first
+    long long spawnedCount = 0;
+    long long recycledCount = 0;
+    long long removedCount = 0;
+    std::vector<unsigned char> routeChoices; // Shared route pool
+    int routeWaste = 0;                      // Bytes of the pool no vehicle points to any more
+
+    // Scratch buffers for UpdateVehicleMotion (kept to avoid reallocating every tick)
+    std::vector<Vector3> steerDir;
+    std::vector<float> moving;
+    std::vector<unsigned char> arrived;
+    SpatialGrid landingGrid{ 8.0f };    // Teleport landing checks, built on the first one of a tick
+    std::vector<int> landingNearby;
+    std::vector<Vector3> landedNow;     // Teleported this tick (the grid has their old position)
+
+    friend void UpdateVehicleMotion(VehicleStore& vehicles, float dt, RoadGraph& graph, WorkerPool* pool, const Router* router);
 };
 
-class Motorcycle : public Vehicle {
-private:
-    float tiltAngle = 0.0f;
-    Vector3 lastForward = {1, 0, 0};
-    
-public:
-    // Constructeur adapté : position de départ et ID du premier nœud cible
-    Motorcycle(Vector3 pos, int targetId);
+// Navigation + steering + integration for every vehicle (was Vehicle::update)
+// pool == nullptr runs everything on the calling thread (same result either way)
+// router != nullptr: vehicles with a destination take the branch with the lowest live
+// time to it (ROUTING_DYNAMIC) instead of a stored or random one.
+void UpdateVehicleMotion(VehicleStore& vehicles, float dt, RoadGraph& graph, WorkerPool* pool = nullptr, const Router* router = nullptr);
 
-    // Mise à jour de l'inclinaison et de la navigation
-    void update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) override;
+// Branch (index in node.nextNodes, which must not be empty) vehicle i takes at 'node':
+// live fastest branch (router), next stored route choice, or a random one
+int ChooseNextBranch(VehicleStore& vehicles, int i, const Node& node, const RoadGraph& graph, const Router* router);
 
-    void draw() override;
-};
+// Feeds the speed of every vehicle to the road it is on, then blends the live travel times
+void UpdateEdgeTravelTimes(const VehicleStore& vehicles, RoadGraph& graph, float dt);
 
-#endif // VEHICLE_H
\ No newline at end of file
+#endif // VEHICLE_H
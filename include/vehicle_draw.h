@@ -0,0 +1,36 @@
+#ifndef VEHICLE_DRAW_H
+#define VEHICLE_DRAW_H
+
+#include "vehicle.h"
+#include "model_manager.h"
+#include "frustum.h"
+
+// Rendering is kept out of the VehicleStore so the simulation core
+// can be built and linked without raylib's drawing/window code.
+
+// Connects the loaded models (call once after ModelManager::LoadModels)
+void SetVehicleModelManager(ModelManager* manager);
+
+// Draws vehicle i with the model matching its type
+// alpha: 0 = state before the last fixed step, 1 = current state
+void DrawVehicle(const VehicleStore& vehicles, int i, float alpha = 1.0f);
+
+// ----- Instanced Renderer -----
+// Groups the vehicles by model and draws each mesh once with DrawMeshInstanced,
+// with the vehicle color as a per-instance tint. Falls back to DrawVehicle per
+// vehicle when the instancing shader is not available.
+struct VehicleDrawStats {
+    int drawCalls;  // DrawMeshInstanced calls (or DrawVehicle calls on the fallback path)
+    int instances;  // Vehicles + roof lights submitted
+    bool instanced;
+};
+
+// Call after SetVehicleModelManager (needs the GL context), unload before closing the window
+void InitVehicleRenderer();
+void UnloadVehicleRenderer();
+
+// Vehicles outside the frustum are skipped, the ones past LOD_VEHICLE_DISTANCE are drawn as boxes
+void DrawVehicles(const VehicleStore& vehicles, float alpha, const Frustum& frustum, Vector3 cameraPos, CullCounter& counter);
+VehicleDrawStats GetVehicleDrawStats(); // Last DrawVehicles call
+
+#endif
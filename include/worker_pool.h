@@ -0,0 +1,53 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed set of threads that run one ParallelFor at a time.
+// [0, count) is cut into one contiguous chunk per thread; the calling thread
+// works on chunk 0 and ParallelFor returns once every chunk is done.
+// Callers must make each index independent of the others (read a snapshot,
+// write only their own slot) so the result does not depend on the thread count.
+class WorkerPool {
+public:
+    // fn(begin, end, worker): worker is in [0, GetThreadCount()) and can index per-thread scratch
+    typedef std::function<void(int begin, int end, int worker)> RangeFunc;
+
+    // threadCount <= 0 -> one thread per hardware core
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    // Restarts the pool with a new thread count (no-op if unchanged)
+    void Resize(int threadCount);
+
+    // Number of threads taking part in a ParallelFor, the caller included
+    int GetThreadCount() const { return (int)threads.size() + 1; }
+
+    // Below minChunk items per thread the work runs on the caller only
+    void ParallelFor(int count, const RangeFunc& fn, int minChunk = 32);
+
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+
+    // Current job (guarded by mutex)
+    const RangeFunc* job = nullptr;
+    int jobCount = 0;
+    int jobChunks = 0;
+    int pending = 0;            // Chunks still running
+    unsigned long generation = 0; // Bumped for every job so sleeping threads know there is new work
+    bool stopping = false;
+
+    void Start(int threadCount);
+    void Stop();
+    void WorkerLoop(int worker, unsigned long seen); // seen = generation when the thread started
+    void RunChunk(const RangeFunc& fn, int count, int chunks, int chunk);
+};
+
+#endif // WORKER_POOL_H
@@ -1,8 +1,14 @@
 #include "app.h"
 #include "window.h"
 #include "camera_controller.h" //.-. camera
+#include "sim_random.h"
+#include "vehicle_draw.h"
+#include "profiler.h"
+#include "basicmap.h"
 #include <iostream>
 #include <algorithm> // For std::min idoaddit.-.
+#include <cmath> // Needed for fabs
+#include <ctime>
 
 App::App() {
     // 1. Window & System Setup
@@ -14,7 +20,11 @@ App::App() {
     //endof.-.
     // Load 3D models BEFORE simulation
     modelManager.LoadModels();
-    Vehicle::modelManager = &modelManager;  // Connect to vehicles
+    SetVehicleModelManager(&modelManager);  // Connect to vehicles
+    InitVehicleRenderer();
+
+    // Bake the static city once (needs the GL context)
+    cityScene.Build(DrawBasicMapGround, GetBuildingCount(), DrawBuilding);
 
     // 2. Camera Setup ._. start
     camera = { 0 };
@@ -30,6 +40,7 @@ App::App() {
     CameraController::Init(camera); //.-. end
 
     // 3. Module Initialization
+    SimRandom::Seed((unsigned int)time(nullptr)); // A different traffic pattern every run
     globalConfig = GetDefaultConfig();
     simulation.Init();
     simulation.ApplyConfiguration();
@@ -39,9 +50,14 @@ App::App() {
     gameStarted = false;
     loadingTimer = 0.0f;
     showDebugNodes = true;
+    fastForward = false;
+    useBakedCity = true;
+    simulation.SetBakedMap(&cityScene);
 }
 
 App::~App() { //.-.
+    cityScene.Unload();
+    UnloadVehicleRenderer();
     UnloadRenderTexture(renderTarget); // Clean up memory
     GameWindow::Close();
 }
@@ -51,6 +67,7 @@ void App::Run() {
     while (!WindowShouldClose()) {
         Update();
         Draw();
+        Profiler::EndFrame();
         
         // Check if the exit button was pressed in the menu
         if (interface.shouldExit) break; 
@@ -90,6 +107,23 @@ void App::Update() {
         // [N] Toggle Debug Nodes
         if (IsKeyPressed(KEY_N)) showDebugNodes = !showDebugNodes;
 
+        // [F] Toggle Fast-Forward
+        if (IsKeyPressed(KEY_F)) fastForward = !fastForward;
+
+        // [B] Toggle Baked City (compare with the immediate-mode path)
+        if (IsKeyPressed(KEY_B)) {
+            useBakedCity = !useBakedCity;
+            simulation.SetBakedMap(useBakedCity ? &cityScene : nullptr);
+        }
+
+        // [F3] Toggle Profiler HUD, [F4] Start/Stop a Chrome trace capture
+        if (IsKeyPressed(KEY_F3)) Profiler::SetEnabled(!Profiler::IsEnabled());
+        if (IsKeyPressed(KEY_F4)) {
+            if (!Profiler::IsTracing()) Profiler::BeginTrace();
+            else if (Profiler::EndTrace("profile_trace.json")) TraceLog(LOG_INFO, "PROFILER: Trace written to profile_trace.json");
+            else TraceLog(LOG_WARNING, "PROFILER: Could not write profile_trace.json");
+        }
+
         // Camera Controls (only if not paused) //.-.
         if (!pauseMenu.isVisible) {
             // Define settings
@@ -110,20 +144,85 @@ void App::Update() {
 
         // Simulation Update
         if (interface.IsInSimulation()) {
-            float dt = GetFrameTime() * globalConfig.simulationSpeed;
-            simulation.Update(dt, camera);
+            {
+                PROFILE_SCOPE("Picking");
+                UpdateVehiclePicking();
+            }
+
+            // Fixed-step scheduler: a frame hitch or a high speed only adds substeps
+            float speed = fastForward ? SimulationConfig::FAST_FORWARD_SPEED : globalConfig.simulationSpeed;
+            simulation.Advance(GetFrameTime(), speed);
+        }
+    }
+}
+
+void App::UpdateVehiclePicking() {
+    Vector2 mouse = GetMousePosition();
+    Vector2 scaledMouse = mouse;
+    scaledMouse.x = mouse.x * ((float)SimulationConfig::SCREEN_WIDTH / GetScreenWidth());
+    scaledMouse.y = mouse.y * ((float)SimulationConfig::SCREEN_HEIGHT / GetScreenHeight());
+    
+    Ray ray = GetMouseRay(scaledMouse, camera);
+    
+    int hoveredVehicle = -1;
+    float minHitDist = 9999.0f; // Track closest hit
+
+    const VehicleStore& vehicles = simulation.GetVehicles();
+    for (int v = 0; v < vehicles.Size(); v++) {
+        if (vehicles.finished[v]) continue; // Free slot
+        Vector3 pos = vehicles.position[v];
+        Vector3 fwd = vehicles.forward[v];
+        float length = vehicles.length[v];
+
+        // --- ADAPTIVE HITBOX MATH ---
+        // We calculate how much space the car takes on X and Z axes based on its rotation.
+        // Width is approx 2.5m for all cars. Length varies.
+        float width = 2.5f;
+        
+        // Project length and width onto the axes
+        // If facing X: SizeX = Length, SizeZ = Width
+        // If facing Z: SizeX = Width,  SizeZ = Length
+        // If 45 deg:   SizeX = Mix,    SizeZ = Mix
+        float halfSizeX = (fabs(fwd.x) * length + fabs(fwd.z) * width) / 2.0f;
+        float halfSizeZ = (fabs(fwd.z) * length + fabs(fwd.x) * width) / 2.0f;
+
+        // Construct the rotating box
+        BoundingBox box = {
+            (Vector3){ pos.x - halfSizeX, pos.y, pos.z - halfSizeZ },
+            (Vector3){ pos.x + halfSizeX, pos.y + 2.5f, pos.z + halfSizeZ }
+        };
+
+        // Check Raycast
+        RayCollision collision = GetRayCollisionBox(ray, box);
+        
+        if (collision.hit) {
+            // Only pick this car if it is closer than previous hits
+            if (collision.distance < minHitDist) {
+                minHitDist = collision.distance;
+                hoveredVehicle = v;
+            }
+        }
+    }
+    
+    // --- APPLY INTERACTION TO THE WINNER ---
+    if (hoveredVehicle != -1) {
+        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
+        
+        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            simulation.ForceMoveVehicle(vehicles.GetHandle(hoveredVehicle), 2.5f);
         }
     }
 }
 
 void App::Draw() {
+    PROFILE_SCOPE("App.Draw");
     BeginTextureMode(renderTarget); //.-.
         ClearBackground(RAYWHITE);
 
         if (interface.IsInSimulation() || interface.GetState() == STATE_PAUSED) {
             // 1. Draw 3D World
             BeginMode3D(camera);
-                simulation.Draw3D(showDebugNodes); // No camera needed here
+                simulation.Draw3D(showDebugNodes, camera); // Camera for culling / LOD
             EndMode3D();
 
             // 2. Draw Overlays (IDs, HUD, Menus)
@@ -137,7 +236,20 @@ void App::Draw() {
                 DrawText("- [N] : Show Nodes", 10, 85, 20, DARKGRAY);
                 DrawText("- [WASD] : Move Camera", 10, 110, 20, DARKGRAY);
                 DrawText("- Click Car : Force Move", 10, 135, 20, DARKGRAY);
-                DrawText(TextFormat("- Vehicles: %d", simulation.GetVehicleCount()), 10, 160, 20, DARKGRAY);
+                DrawText(fastForward ? TextFormat("- [F] : Fast-Forward (x%.0f)", SimulationConfig::FAST_FORWARD_SPEED)
+                                     : "- [F] : Fast-Forward (off)", 10, 160, 20, DARKGRAY);
+                DrawText(TextFormat("- Vehicles: %d (%d draw calls)", simulation.GetVehicleCount(), GetVehicleDrawStats().drawCalls), 10, 185, 20, DARKGRAY);
+                DrawText(useBakedCity ? TextFormat("- [B] : Baked City (%d meshes, %d tris)", cityScene.GetMeshCount(), cityScene.GetTriangleCount())
+                                      : "- [B] : Baked City (off)", 10, 210, 20, DARKGRAY);
+                const RenderStats& rs = simulation.GetRenderStats();
+                DrawText(TextFormat("- Drawn/Culled: vehicles %d/%d  buildings %d/%d  lights %d/%d",
+                                    rs.vehicles.drawn, rs.vehicles.culled, rs.buildings.drawn, rs.buildings.culled,
+                                    rs.lights.drawn, rs.lights.culled), 10, 235, 20, DARKGRAY);
+                VehiclePoolStats pool = simulation.GetVehicles().GetPoolStats();
+                DrawText(TextFormat("- Vehicle pool: %d/%d slots  %lld recycled  %d KB",
+                                    pool.live, pool.slots, pool.recycled, (int)(pool.bytes / 1024)), 10, 260, 20, DARKGRAY);
+                DrawText(Profiler::IsTracing() ? "- [F3] : Profiler  [F4] : Stop Trace" : "- [F3] : Profiler  [F4] : Record Trace", 10, 285, 20, DARKGRAY);
+                Profiler::DrawHud(10, 315, 20);
             }
 
             // In-Game Menu
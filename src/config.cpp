@@ -8,6 +8,8 @@ SimulationConfig GetDefaultConfig() {
     
     cfg.maxVehicles = 50;
     cfg.simulationSpeed = 1.0f;
+    cfg.workerThreads = 0;
+    cfg.signalControl = SIGNAL_FIXED_TIME;
 
     // --- 1. DECLARE YOUR SHARED LIST HERE ---
     // This list contains ALL the valid green "START" nodes from your map.
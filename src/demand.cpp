@@ -0,0 +1,266 @@
+#include "demand.h"
+#include "config.h"
+#include "sim_random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// =============================================================================
+//  FILE
+// =============================================================================
+
+static bool ParseFloat(const char* text, float& out) {
+    char* end;
+    out = strtof(text, &end);
+    return *end == '\0';
+}
+
+static bool ParseInt(const char* text, int& out) {
+    char* end;
+    out = (int)strtol(text, &end, 10);
+    return *end == '\0';
+}
+
+static const char* ParseLine(std::vector<char*>& f, DemandModel& demand) {
+    const char* kind = f[0];
+    int count = (int)f.size();
+
+    if (strcmp(kind, "od") == 0) {
+        int origin, destination;
+        float perHour;
+        if (count != 4 || !ParseInt(f[1], origin) || !ParseInt(f[2], destination) || !ParseFloat(f[3], perHour)) {
+            return "expected: od <originId> <destinationId> <vehicles per hour>";
+        }
+        if (perHour < 0.0f) return "negative rate";
+        demand.AddTrips(origin, destination, perHour);
+        return nullptr;
+    }
+    if (strcmp(kind, "profile") == 0) {
+        if (count < 3 || count % 2 == 0) return "expected: profile <hour> <factor> [<hour> <factor> ...]";
+        for (int k = 1; k < count; k += 2) {
+            float hour, factor;
+            if (!ParseFloat(f[k], hour) || !ParseFloat(f[k + 1], factor)) return "bad number";
+            if (hour < 0.0f || hour >= 24.0f || factor < 0.0f) return "hours go from 0 to 24, factors are positive";
+            demand.AddProfilePoint(hour, factor);
+        }
+        return nullptr;
+    }
+    if (strcmp(kind, "mix") == 0) {
+        float weight;
+        if (count != 3 || !ParseFloat(f[2], weight)) return "expected: mix <type> <weight>";
+        VehicleType type = VehicleTypeFromName(f[1]);
+        if (type == VEHICLE_GENERIC) return "unknown vehicle type";
+        if (weight < 0.0f) return "negative weight";
+        demand.AddMix(type, weight);
+        return nullptr;
+    }
+    if (strcmp(kind, "start") == 0) {
+        float hour;
+        if (count != 2 || !ParseFloat(f[1], hour) || hour < 0.0f || hour >= 24.0f) return "expected: start <hour 0-24>";
+        demand.SetStartHour(hour);
+        return nullptr;
+    }
+    return "unknown item";
+}
+
+bool DemandModel::Load(const char* path) {
+    Clear();
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+
+    std::vector<char*> fields;
+    char line[4096];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        fields.clear();
+        for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(nullptr, " \t\r\n")) {
+            if (tok[0] == '#') break;
+            fields.push_back(tok);
+        }
+        if (fields.empty()) continue;
+        const char* problem = ParseLine(fields, *this);
+        if (problem) {
+            fclose(file);
+            Clear();
+            error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+    }
+    fclose(file);
+
+    if (rows.empty()) {
+        error = std::string(path) + ": no od line";
+        return false;
+    }
+    return true;
+}
+
+void DemandModel::Clear() {
+    rows.clear();
+    profile.clear();
+    mix.clear();
+    startHour = 8.0f;
+    error.clear();
+    activeRows.clear();
+    origins.clear();
+    activeMix.clear();
+    peakFactor = 1.0f;
+    totalRate = 0.0f;
+    clock = 0.0;
+    arrivalCount = 0;
+    droppedRows = 0;
+}
+
+void DemandModel::AddTrips(int originId, int destinationId, float perHour) {
+    rows.push_back({ originId, destinationId, perHour });
+}
+
+void DemandModel::AddProfilePoint(float hour, float factor) {
+    ProfilePoint p = { hour, factor };
+    auto at = std::upper_bound(profile.begin(), profile.end(), p,
+                               [](const ProfilePoint& a, const ProfilePoint& b) { return a.hour < b.hour; });
+    profile.insert(at, p);
+}
+
+void DemandModel::AddMix(VehicleType type, float weight) {
+    mix.push_back({ type, weight });
+}
+
+// =============================================================================
+//  TIME OF DAY
+// =============================================================================
+
+float DemandModel::GetFactor(float hour) const {
+    if (profile.empty()) return 1.0f;
+    if (profile.size() == 1) return profile[0].factor;
+    hour = fmodf(hour, 24.0f);
+    if (hour < 0.0f) hour += 24.0f;
+
+    // Segment around 'hour'; before the first / after the last point it wraps over midnight
+    size_t k = 0;
+    while (k < profile.size() && profile[k].hour <= hour) k++;
+    const ProfilePoint& a = k == 0 ? profile.back() : profile[k - 1];
+    const ProfilePoint& b = k == profile.size() ? profile.front() : profile[k];
+    float span = b.hour - a.hour;
+    float into = hour - a.hour;
+    if (span <= 0.0f) span += 24.0f;
+    if (into < 0.0f) into += 24.0f;
+    return a.factor + (b.factor - a.factor) * (into / span);
+}
+
+float DemandModel::GetTimeOfDay() const {
+    return fmodf(startHour + (float)(clock / 3600.0), 24.0f);
+}
+
+// =============================================================================
+//  ARRIVALS
+// =============================================================================
+
+// Uniform in (0, 1) from SimRandom (same seed, same demand)
+static double Uniform() {
+    return (SimRandom::GetValue(0, (1 << 30) - 1) + 0.5) / (double)(1 << 30);
+}
+
+void DemandModel::Prepare(const RoadGraph& graph) {
+    // 1. Rows the graph can serve, grouped by origin (file order kept inside a group)
+    std::vector<Row> kept;
+    droppedRows = 0;
+    for (const Row& r : rows) {
+        const Node& origin = graph.GetNode(r.originId);
+        const Node& destination = graph.GetNode(r.destinationId);
+        if (!origin.IsValid() || origin.nextNodes.empty() || !destination.IsValid() || destination.type != TELEPORT) {
+            droppedRows++;
+            continue;
+        }
+        if (r.perHour > 0.0f) kept.push_back(r);
+    }
+    std::stable_sort(kept.begin(), kept.end(), [](const Row& a, const Row& b) { return a.originId < b.originId; });
+
+    origins.clear();
+    totalRate = 0.0f;
+    for (int k = 0; k < (int)kept.size(); k++) {
+        if (origins.empty() || origins.back().nodeId != kept[k].originId) {
+            origins.push_back({ kept[k].originId, k, 0, 0.0f, 0.0 });
+        }
+        origins.back().rowCount++;
+        origins.back().perHour += kept[k].perHour;
+        totalRate += kept[k].perHour;
+    }
+    activeRows.swap(kept);
+
+    // 2. Type shares: the file's mix, else the spawn config counts
+    activeMix.clear();
+    for (const auto& m : mix) if (m.second > 0.0f) activeMix.push_back(m);
+    if (activeMix.empty()) {
+        for (const auto& cfg : globalConfig.vehicleConfigs) {
+            VehicleType type = VehicleTypeFromName(cfg.type);
+            if (type != VEHICLE_GENERIC && cfg.count > 0) activeMix.push_back({ type, (float)cfg.count });
+        }
+    }
+    if (activeMix.empty()) activeMix.push_back({ VEHICLE_CAR, 1.0f });
+
+    // 3. Thinning bound: the profile is piecewise linear, its peak is one of the points
+    peakFactor = profile.empty() ? 1.0f : 0.0f;
+    for (const ProfilePoint& p : profile) peakFactor = std::max(peakFactor, p.factor);
+
+    clock = 0.0;
+    arrivalCount = 0;
+    for (Origin& o : origins) o.next = NextCandidate(o, 0.0);
+}
+
+double DemandModel::NextCandidate(const Origin& o, double after) const {
+    double rate = o.perHour * peakFactor / 3600.0; // Per second, at the peak
+    if (rate <= 0.0) return HUGE_VAL;
+    return after - log(Uniform()) / rate;
+}
+
+void DemandModel::Generate(float dt, std::vector<DemandArrival>& out) {
+    double end = clock + dt;
+    size_t first = out.size();
+
+    for (Origin& o : origins) {
+        while (o.next <= end) {
+            double t = o.next;
+            o.next = NextCandidate(o, t);
+
+            // Thinning: keep the candidate with probability factor(t) / peak
+            float hour = startHour + (float)(t / 3600.0);
+            if (Uniform() * peakFactor >= GetFactor(hour)) continue;
+
+            // Destination by row rate, type by mix weight
+            double pick = Uniform() * o.perHour;
+            int row = o.firstRow;
+            for (int k = o.firstRow; k < o.firstRow + o.rowCount; k++) {
+                row = k;
+                pick -= activeRows[k].perHour;
+                if (pick < 0.0) break;
+            }
+            float mixTotal = 0.0f;
+            for (const auto& m : activeMix) mixTotal += m.second;
+            double typePick = Uniform() * mixTotal;
+            VehicleType type = activeMix.back().first;
+            for (const auto& m : activeMix) {
+                typePick -= m.second;
+                if (typePick < 0.0) {
+                    type = m.first;
+                    break;
+                }
+            }
+
+            out.push_back({ t, type, o.nodeId, activeRows[row].destinationId });
+            arrivalCount++;
+        }
+    }
+    clock = end;
+
+    // Origins were walked one after the other: merge them back into time order
+    std::stable_sort(out.begin() + first, out.end(),
+                     [](const DemandArrival& a, const DemandArrival& b) { return a.time < b.time; });
+}
@@ -6,8 +6,8 @@ const float SIDEWALK_HEIGHT = 0.2f;
 
 // ----- 2D Helper (Flat for Markings) -----
 void DrawArcSegment(Vector3 center, float innerRadius, float width, float startAngle, float endAngle, Color color) {
-    rlBegin(RL_QUADS);
-    rlColor4ub(color.r, color.g, color.b, color.a);
+    MapDraw::Begin(RL_QUADS);
+    MapDraw::Color4ub(color.r, color.g, color.b, color.a);
     
     int segments = 32;
     float step = (endAngle - startAngle) / segments;
@@ -27,12 +27,12 @@ void DrawArcSegment(Vector3 center, float innerRadius, float width, float startA
         float x2_out = center.x + cosf(angle2) * outerRadius;
         float z2_out = center.z + sinf(angle2) * outerRadius;
         
-        rlVertex3f(x1_in, center.y, z1_in);
-        rlVertex3f(x1_out, center.y, z1_out);
-        rlVertex3f(x2_out, center.y, z2_out);
-        rlVertex3f(x2_in, center.y, z2_in);
+        MapDraw::Vertex3f(x1_in, center.y, z1_in);
+        MapDraw::Vertex3f(x1_out, center.y, z1_out);
+        MapDraw::Vertex3f(x2_out, center.y, z2_out);
+        MapDraw::Vertex3f(x2_in, center.y, z2_in);
     }
-    rlEnd();
+    MapDraw::End();
 }
 
 // ----- Draw Sidewalk Block Arc -----
@@ -45,14 +45,14 @@ void DrawSidewalkBlockArc(Vector3 center, float innerRadius, float width, float
     for (float a = startAngle; a < endAngle; a += angleStep) {
         float currentAngle = a + (angleStep / 2.0f); 
         
-        rlPushMatrix();
-            rlTranslatef(center.x, center.y + height/2.0f, center.z);
-            rlRotatef(currentAngle, 0, 1, 0);
-            rlTranslatef(radiusToCenterOfBlock, 0, 0);
+        MapDraw::PushMatrix();
+            MapDraw::Translatef(center.x, center.y + height/2.0f, center.z);
+            MapDraw::Rotatef(currentAngle, 0, 1, 0);
+            MapDraw::Translatef(radiusToCenterOfBlock, 0, 0);
             
-            DrawCube({0,0,0}, width, height, segmentLength, color);
-            DrawCubeWires({0,0,0}, width, height, segmentLength, GRAY);
-        rlPopMatrix();
+            MapDraw::DrawCube({0,0,0}, width, height, segmentLength, color);
+            MapDraw::DrawCubeWires({0,0,0}, width, height, segmentLength, GRAY);
+        MapDraw::PopMatrix();
     }
 }
 
@@ -66,14 +66,14 @@ void DrawRoundedRoadArc(Vector3 center, float innerRadius, float width, float he
     for (float a = startAngle; a < endAngle; a += angleStep) {
         float currentAngle = a + (angleStep / 2.0f); 
         
-        rlPushMatrix();
-            rlTranslatef(center.x, center.y + height/2.0f, center.z);
-            rlRotatef(currentAngle, 0, 1, 0);
-            rlTranslatef(radiusToCenterOfBlock, 0, 0);
+        MapDraw::PushMatrix();
+            MapDraw::Translatef(center.x, center.y + height/2.0f, center.z);
+            MapDraw::Rotatef(currentAngle, 0, 1, 0);
+            MapDraw::Translatef(radiusToCenterOfBlock, 0, 0);
             
-            DrawCube({0,0,0}, width, height, segmentLength, color);
-            DrawCubeWires({0,0,0}, width, height, segmentLength, DARKGRAY);
-        rlPopMatrix();
+            MapDraw::DrawCube({0,0,0}, width, height, segmentLength, color);
+            MapDraw::DrawCubeWires({0,0,0}, width, height, segmentLength, DARKGRAY);
+        MapDraw::PopMatrix();
     }
 }
 
@@ -88,14 +88,14 @@ void DrawRoadLineArc(Vector3 center, float innerRadius, float width, float heigh
     for (float a = startAngle; a < endAngle; a += angleStep) {
         float currentAngle = a + (angleStep / 2.0f);
 
-        rlPushMatrix();
-            rlTranslatef(center.x, center.y + height/2.0f, center.z);
-            rlRotatef(currentAngle, 0, 1, 0);
-            rlTranslatef(radiusToCenterOfBlock, 0, 0);
+        MapDraw::PushMatrix();
+            MapDraw::Translatef(center.x, center.y + height/2.0f, center.z);
+            MapDraw::Rotatef(currentAngle, 0, 1, 0);
+            MapDraw::Translatef(radiusToCenterOfBlock, 0, 0);
             
-            DrawCube({0,0,0}, width, height, segmentLength, color);
-            DrawCubeWires({0,0,0}, width, height, segmentLength, WHITE);
-        rlPopMatrix();
+            MapDraw::DrawCube({0,0,0}, width, height, segmentLength, color);
+            MapDraw::DrawCubeWires({0,0,0}, width, height, segmentLength, WHITE);
+        MapDraw::PopMatrix();
     }
 }
 
@@ -114,15 +114,15 @@ void DrawZebraCrossing(Vector3 center, float roadWidth, float stripeLength, floa
     
     Color stripeColor = { 210, 210, 210, 255 };
 
-    rlPushMatrix();
-        rlTranslatef(center.x, center.y, center.z);
-        rlRotatef(angle, 0, 1, 0); 
+    MapDraw::PushMatrix();
+        MapDraw::Translatef(center.x, center.y, center.z);
+        MapDraw::Rotatef(angle, 0, 1, 0); 
 
         for (int i = 0; i < numStripes; i++) {
             float xPos = startX + i * (stripeWidth * 2.0f);
-            DrawCube({xPos, -0.035f, 0.0f}, stripeWidth, 0.1f, stripeLength, stripeColor);
+            MapDraw::DrawCube({xPos, -0.035f, 0.0f}, stripeWidth, 0.1f, stripeLength, stripeColor);
         }
-    rlPopMatrix();
+    MapDraw::PopMatrix();
 }
 
 // ----- Helper: Terminal Roundabout (UPDATED to 16.0f) -----
@@ -133,10 +133,10 @@ void DrawTerminalRoundabout(Vector3 center) {
     float termRadius = 16.0f; 
     float termIsland = 8.0f;
 
-    DrawCylinder({center.x, -0.04f, center.z}, termRadius, termRadius, 0.2f, 40, DARKGRAY);
-    DrawCylinder({center.x, -0.03f, center.z}, termIsland, termIsland, 0.3f, 32, GREEN);
-    DrawCylinderWires({center.x, -0.03f, center.z}, termIsland, termIsland, 0.3f, 32, GRAY);
-    DrawCylinder({center.x, -0.02f, center.z}, 1.0f, 1.0f, 2.0f, 8, BROWN);
+    MapDraw::DrawCylinder({center.x, -0.04f, center.z}, termRadius, termRadius, 0.2f, 40, DARKGRAY);
+    MapDraw::DrawCylinder({center.x, -0.03f, center.z}, termIsland, termIsland, 0.3f, 32, GREEN);
+    MapDraw::DrawCylinderWires({center.x, -0.03f, center.z}, termIsland, termIsland, 0.3f, 32, GRAY);
+    MapDraw::DrawCylinder({center.x, -0.02f, center.z}, 1.0f, 1.0f, 2.0f, 8, BROWN);
 
     DrawRingFlat({center.x, -0.035f, center.z}, termIsland + 0.2f, termIsland + 0.5f, markColor);
     DrawRingFlat({center.x, -0.035f, center.z}, termRadius - 0.5f, termRadius - 0.2f, markColor);
@@ -147,6 +147,6 @@ void DrawTerminalRoundabout(Vector3 center) {
 
 // ----- Draw Sidewalk Segment -----
 void DrawSidewalkSegment(Vector3 pos, float lenX, float lenZ) {
-    DrawCube(pos, lenX, SIDEWALK_HEIGHT, lenZ, LIGHTGRAY);
-    DrawCubeWires(pos, lenX, SIDEWALK_HEIGHT, lenZ, GRAY);
+    MapDraw::DrawCube(pos, lenX, SIDEWALK_HEIGHT, lenZ, LIGHTGRAY);
+    MapDraw::DrawCubeWires(pos, lenX, SIDEWALK_HEIGHT, lenZ, GRAY);
 }
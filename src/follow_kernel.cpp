@@ -0,0 +1,300 @@
+#include "follow_kernel.h"
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FOLLOW_KERNEL_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FOLLOW_KERNEL_SSE2 1
+#endif
+
+// Same constants as TrafficManager (AreSameDirection / IsInMyLane / crossing check)
+static const float SAME_DIRECTION_DOT = 0.7f;
+static const float LANE_HALF_WIDTH = 2.2f;
+static const float CROSSING_HALF_WIDTH = 2.5f;
+static const float CROSSING_MARGIN = 3.0f;
+static const float NO_LEADER_GAP = 9999.0f;
+
+void FollowCandidates::Clear() {
+    px.clear(); py.clear(); pz.clear();
+    fx.clear(); fy.clear(); fz.clear();
+    lateralOffset.clear();
+    length.clear();
+    index.clear();
+}
+
+void FollowCandidates::Add(int vehicleIndex, float x, float y, float z, float fwdX, float fwdY, float fwdZ, float lateral, float len) {
+    px.push_back(x); py.push_back(y); pz.push_back(z);
+    fx.push_back(fwdX); fy.push_back(fwdY); fz.push_back(fwdZ);
+    lateralOffset.push_back(lateral);
+    length.push_back(len);
+    index.push_back(vehicleIndex);
+}
+
+// =============================================================================
+//  SCALAR
+// =============================================================================
+
+// Candidates [begin, end) on top of an existing result (used for the SIMD tails too).
+// 'best' is the position of the leader in the candidate arrays.
+static void ScanScalar(const FollowSelf& s, const FollowCandidates& c, int begin, int end,
+                       float& bestGap, int& best, bool& crossingStop) {
+    // Our effective position (with the yield offset), as IsInMyLane computes it
+    float meX = s.px + (-s.fz) * s.lateralOffset;
+    float meY = s.py + 0.0f * s.lateralOffset;
+    float meZ = s.pz + s.fx * s.lateralOffset;
+
+    for (int j = begin; j < end; j++) {
+        float dx = c.px[j] - s.px;
+        float dy = c.py[j] - s.py;
+        float dz = c.pz[j] - s.pz;
+        float dist = sqrtf(dx*dx + dy*dy + dz*dz);
+        if (dist > s.range) continue;
+
+        if (s.fx * c.fx[j] + s.fz * c.fz[j] > SAME_DIRECTION_DOT) {
+            // Same direction: is it ahead of us, in our (visual) lane?
+            float toX = (c.px[j] + (-c.fz[j]) * c.lateralOffset[j]) - meX;
+            float toY = (c.py[j] + 0.0f * c.lateralOffset[j]) - meY;
+            float toZ = (c.pz[j] + c.fx[j] * c.lateralOffset[j]) - meZ;
+
+            float forwardDist = toX * s.fx + toY * s.fy + toZ * s.fz;
+            if (forwardDist < 0) continue; // Behind us
+            float sideDist = toX * (-s.fz) + toY * 0.0f + toZ * s.fx;
+            if (!(fabsf(sideDist) < LANE_HALF_WIDTH)) continue;
+
+            float physicalGap = dist - (s.length/2 + c.length[j]/2);
+            if (physicalGap < bestGap && physicalGap > -1.0f) {
+                bestGap = physicalGap;
+                best = j;
+            }
+        } else if (s.checkCrossing) {
+            // Crossing traffic right in front of us
+            float fwdDist = dx * s.fx + dy * s.fy + dz * s.fz;
+            float sideDist = dx * (-s.fz) + dy * 0.0f + dz * s.fx;
+            if (fwdDist > 0 && fwdDist < (s.length + c.length[j])/2 + CROSSING_MARGIN && fabsf(sideDist) < CROSSING_HALF_WIDTH) {
+                crossingStop = true;
+            }
+        }
+    }
+}
+
+static FollowResult MakeResult(const FollowCandidates& c, float bestGap, int best, bool crossingStop) {
+    FollowResult r;
+    r.leader = (best >= 0) ? c.index[best] : -1;
+    r.gap = bestGap;
+    r.crossingStop = crossingStop;
+    return r;
+}
+
+FollowResult FindLeaderScalar(const FollowSelf& self, const FollowCandidates& cands) {
+    float bestGap = NO_LEADER_GAP;
+    int best = -1;
+    bool crossingStop = false;
+    ScanScalar(self, cands, 0, cands.Size(), bestGap, best, crossingStop);
+    return MakeResult(cands, bestGap, best, crossingStop);
+}
+
+// =============================================================================
+//  AVX2 (8 candidates per step)
+// =============================================================================
+#if FOLLOW_KERNEL_AVX2
+
+FollowResult FindLeader(const FollowSelf& s, const FollowCandidates& c) {
+    int n = c.Size();
+    int n8 = n & ~7;
+
+    const __m256 sPx = _mm256_set1_ps(s.px), sPy = _mm256_set1_ps(s.py), sPz = _mm256_set1_ps(s.pz);
+    const __m256 sFx = _mm256_set1_ps(s.fx), sFy = _mm256_set1_ps(s.fy), sFz = _mm256_set1_ps(s.fz);
+    const __m256 sNegFz = _mm256_set1_ps(-s.fz);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32((int)0x80000000));
+    const __m256 range = _mm256_set1_ps(s.range);
+    const __m256 selfHalfLen = _mm256_set1_ps(s.length / 2);
+    const __m256 selfLen = _mm256_set1_ps(s.length);
+    const __m256 meX = _mm256_set1_ps(s.px + (-s.fz) * s.lateralOffset);
+    const __m256 meY = _mm256_set1_ps(s.py + 0.0f * s.lateralOffset);
+    const __m256 meZ = _mm256_set1_ps(s.pz + s.fx * s.lateralOffset);
+    const __m256 crossingCheck = s.checkCrossing ? _mm256_castsi256_ps(_mm256_set1_epi32(-1)) : zero;
+
+    __m256 bestGap = _mm256_set1_ps(NO_LEADER_GAP);
+    __m256i bestPos = _mm256_set1_epi32(-1);
+    __m256 crossing = zero;
+    __m256i pos = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+
+    for (int j = 0; j < n8; j += 8) {
+        __m256 cPx = _mm256_loadu_ps(&c.px[j]), cPy = _mm256_loadu_ps(&c.py[j]), cPz = _mm256_loadu_ps(&c.pz[j]);
+        __m256 cFx = _mm256_loadu_ps(&c.fx[j]), cFz = _mm256_loadu_ps(&c.fz[j]);
+        __m256 cLat = _mm256_loadu_ps(&c.lateralOffset[j]);
+        __m256 cLen = _mm256_loadu_ps(&c.length[j]);
+
+        __m256 dx = _mm256_sub_ps(cPx, sPx);
+        __m256 dy = _mm256_sub_ps(cPy, sPy);
+        __m256 dz = _mm256_sub_ps(cPz, sPz);
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz)));
+        __m256 inRange = _mm256_cmp_ps(dist, range, _CMP_NGT_UQ);
+
+        __m256 dirDot = _mm256_add_ps(_mm256_mul_ps(sFx, cFx), _mm256_mul_ps(sFz, cFz));
+        __m256 sameDir = _mm256_cmp_ps(dirDot, _mm256_set1_ps(SAME_DIRECTION_DOT), _CMP_GT_OQ);
+
+        // --- Leader: same direction, ahead, in our lane ---
+        __m256 toX = _mm256_sub_ps(_mm256_add_ps(cPx, _mm256_mul_ps(_mm256_xor_ps(cFz, signMask), cLat)), meX);
+        __m256 toY = _mm256_sub_ps(_mm256_add_ps(cPy, _mm256_mul_ps(zero, cLat)), meY);
+        __m256 toZ = _mm256_sub_ps(_mm256_add_ps(cPz, _mm256_mul_ps(cFx, cLat)), meZ);
+        __m256 laneFwd = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(toX, sFx), _mm256_mul_ps(toY, sFy)), _mm256_mul_ps(toZ, sFz));
+        __m256 laneSide = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(toX, sNegFz), _mm256_mul_ps(toY, zero)), _mm256_mul_ps(toZ, sFx));
+        __m256 inLane = _mm256_and_ps(_mm256_cmp_ps(laneFwd, zero, _CMP_NLT_UQ),
+                                      _mm256_cmp_ps(_mm256_and_ps(laneSide, absMask), _mm256_set1_ps(LANE_HALF_WIDTH), _CMP_LT_OQ));
+
+        __m256 gap = _mm256_sub_ps(dist, _mm256_add_ps(selfHalfLen, _mm256_mul_ps(cLen, half)));
+        __m256 better = _mm256_and_ps(_mm256_cmp_ps(gap, bestGap, _CMP_LT_OQ), _mm256_cmp_ps(gap, _mm256_set1_ps(-1.0f), _CMP_GT_OQ));
+        __m256 take = _mm256_and_ps(_mm256_and_ps(inRange, sameDir), _mm256_and_ps(inLane, better));
+        bestGap = _mm256_blendv_ps(bestGap, gap, take);
+        bestPos = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestPos), _mm256_castsi256_ps(pos), take));
+
+        // --- Crossing traffic right in front of us ---
+        __m256 crossFwd = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, sFx), _mm256_mul_ps(dy, sFy)), _mm256_mul_ps(dz, sFz));
+        __m256 crossSide = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, sNegFz), _mm256_mul_ps(dy, zero)), _mm256_mul_ps(dz, sFx));
+        __m256 limit = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(selfLen, cLen), half), _mm256_set1_ps(CROSSING_MARGIN));
+        __m256 hit = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(crossFwd, zero, _CMP_GT_OQ), _mm256_cmp_ps(crossFwd, limit, _CMP_LT_OQ)),
+                                   _mm256_cmp_ps(_mm256_and_ps(crossSide, absMask), _mm256_set1_ps(CROSSING_HALF_WIDTH), _CMP_LT_OQ));
+        crossing = _mm256_or_ps(crossing, _mm256_and_ps(_mm256_andnot_ps(sameDir, inRange), _mm256_and_ps(hit, crossingCheck)));
+
+        pos = _mm256_add_epi32(pos, step);
+    }
+
+    // Reduce the 8 lanes: smallest gap, earliest candidate on ties (= the scalar scan order)
+    alignas(32) float gaps[8];
+    alignas(32) int positions[8];
+    _mm256_store_ps(gaps, bestGap);
+    _mm256_store_si256((__m256i*)positions, bestPos);
+    float bestGapScalar = NO_LEADER_GAP;
+    int best = -1;
+    for (int l = 0; l < 8; l++) {
+        if (positions[l] < 0) continue;
+        if (best < 0 || gaps[l] < bestGapScalar || (gaps[l] == bestGapScalar && positions[l] < best)) {
+            bestGapScalar = gaps[l];
+            best = positions[l];
+        }
+    }
+    bool crossingStop = _mm256_movemask_ps(crossing) != 0;
+
+    ScanScalar(s, c, n8, n, bestGapScalar, best, crossingStop);
+    return MakeResult(c, bestGapScalar, best, crossingStop);
+}
+
+const char* GetFollowKernelName() { return "avx2"; }
+
+// =============================================================================
+//  SSE2 (4 candidates per step)
+// =============================================================================
+#elif FOLLOW_KERNEL_SSE2
+
+// SSE2 has no blendv: pick b where mask is set
+static inline __m128 Select(__m128 a, __m128 b, __m128 mask) {
+    return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b));
+}
+
+FollowResult FindLeader(const FollowSelf& s, const FollowCandidates& c) {
+    int n = c.Size();
+    int n4 = n & ~3;
+
+    const __m128 sPx = _mm_set1_ps(s.px), sPy = _mm_set1_ps(s.py), sPz = _mm_set1_ps(s.pz);
+    const __m128 sFx = _mm_set1_ps(s.fx), sFy = _mm_set1_ps(s.fy), sFz = _mm_set1_ps(s.fz);
+    const __m128 sNegFz = _mm_set1_ps(-s.fz);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+    const __m128 range = _mm_set1_ps(s.range);
+    const __m128 selfHalfLen = _mm_set1_ps(s.length / 2);
+    const __m128 selfLen = _mm_set1_ps(s.length);
+    const __m128 meX = _mm_set1_ps(s.px + (-s.fz) * s.lateralOffset);
+    const __m128 meY = _mm_set1_ps(s.py + 0.0f * s.lateralOffset);
+    const __m128 meZ = _mm_set1_ps(s.pz + s.fx * s.lateralOffset);
+    const __m128 crossingCheck = s.checkCrossing ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : zero;
+
+    __m128 bestGap = _mm_set1_ps(NO_LEADER_GAP);
+    __m128 bestPos = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128 crossing = zero;
+    __m128i pos = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+
+    for (int j = 0; j < n4; j += 4) {
+        __m128 cPx = _mm_loadu_ps(&c.px[j]), cPy = _mm_loadu_ps(&c.py[j]), cPz = _mm_loadu_ps(&c.pz[j]);
+        __m128 cFx = _mm_loadu_ps(&c.fx[j]), cFz = _mm_loadu_ps(&c.fz[j]);
+        __m128 cLat = _mm_loadu_ps(&c.lateralOffset[j]);
+        __m128 cLen = _mm_loadu_ps(&c.length[j]);
+
+        __m128 dx = _mm_sub_ps(cPx, sPx);
+        __m128 dy = _mm_sub_ps(cPy, sPy);
+        __m128 dz = _mm_sub_ps(cPz, sPz);
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        __m128 inRange = _mm_cmpngt_ps(dist, range);
+
+        __m128 dirDot = _mm_add_ps(_mm_mul_ps(sFx, cFx), _mm_mul_ps(sFz, cFz));
+        __m128 sameDir = _mm_cmpgt_ps(dirDot, _mm_set1_ps(SAME_DIRECTION_DOT));
+
+        // --- Leader: same direction, ahead, in our lane ---
+        __m128 toX = _mm_sub_ps(_mm_add_ps(cPx, _mm_mul_ps(_mm_xor_ps(cFz, signMask), cLat)), meX);
+        __m128 toY = _mm_sub_ps(_mm_add_ps(cPy, _mm_mul_ps(zero, cLat)), meY);
+        __m128 toZ = _mm_sub_ps(_mm_add_ps(cPz, _mm_mul_ps(cFx, cLat)), meZ);
+        __m128 laneFwd = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, sFx), _mm_mul_ps(toY, sFy)), _mm_mul_ps(toZ, sFz));
+        __m128 laneSide = _mm_add_ps(_mm_add_ps(_mm_mul_ps(toX, sNegFz), _mm_mul_ps(toY, zero)), _mm_mul_ps(toZ, sFx));
+        __m128 inLane = _mm_and_ps(_mm_cmpnlt_ps(laneFwd, zero),
+                                   _mm_cmplt_ps(_mm_and_ps(laneSide, absMask), _mm_set1_ps(LANE_HALF_WIDTH)));
+
+        __m128 gap = _mm_sub_ps(dist, _mm_add_ps(selfHalfLen, _mm_mul_ps(cLen, half)));
+        __m128 better = _mm_and_ps(_mm_cmplt_ps(gap, bestGap), _mm_cmpgt_ps(gap, _mm_set1_ps(-1.0f)));
+        __m128 take = _mm_and_ps(_mm_and_ps(inRange, sameDir), _mm_and_ps(inLane, better));
+        bestGap = Select(bestGap, gap, take);
+        bestPos = Select(bestPos, _mm_castsi128_ps(pos), take);
+
+        // --- Crossing traffic right in front of us ---
+        __m128 crossFwd = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, sFx), _mm_mul_ps(dy, sFy)), _mm_mul_ps(dz, sFz));
+        __m128 crossSide = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, sNegFz), _mm_mul_ps(dy, zero)), _mm_mul_ps(dz, sFx));
+        __m128 limit = _mm_add_ps(_mm_mul_ps(_mm_add_ps(selfLen, cLen), half), _mm_set1_ps(CROSSING_MARGIN));
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(crossFwd, zero), _mm_cmplt_ps(crossFwd, limit)),
+                                _mm_cmplt_ps(_mm_and_ps(crossSide, absMask), _mm_set1_ps(CROSSING_HALF_WIDTH)));
+        crossing = _mm_or_ps(crossing, _mm_and_ps(_mm_andnot_ps(sameDir, inRange), _mm_and_ps(hit, crossingCheck)));
+
+        pos = _mm_add_epi32(pos, step);
+    }
+
+    // Reduce the 4 lanes: smallest gap, earliest candidate on ties (= the scalar scan order)
+    alignas(16) float gaps[4];
+    alignas(16) int positions[4];
+    _mm_store_ps(gaps, bestGap);
+    _mm_store_si128((__m128i*)positions, _mm_castps_si128(bestPos));
+    float bestGapScalar = NO_LEADER_GAP;
+    int best = -1;
+    for (int l = 0; l < 4; l++) {
+        if (positions[l] < 0) continue;
+        if (best < 0 || gaps[l] < bestGapScalar || (gaps[l] == bestGapScalar && positions[l] < best)) {
+            bestGapScalar = gaps[l];
+            best = positions[l];
+        }
+    }
+    bool crossingStop = _mm_movemask_ps(crossing) != 0;
+
+    ScanScalar(s, c, n4, n, bestGapScalar, best, crossingStop);
+    return MakeResult(c, bestGapScalar, best, crossingStop);
+}
+
+const char* GetFollowKernelName() { return "sse2"; }
+
+// =============================================================================
+//  PORTABLE FALLBACK
+// =============================================================================
+#else
+
+FollowResult FindLeader(const FollowSelf& self, const FollowCandidates& cands) {
+    return FindLeaderScalar(self, cands);
+}
+
+const char* GetFollowKernelName() { return "scalar"; }
+
+#endif
@@ -0,0 +1,181 @@
+#include "follow_model.h"
+#include <cmath>
+#include <cstring>
+
+void FollowInputs::Resize(int count) {
+    gap.resize(count);
+    leaderSpeed.resize(count);
+    stopGap.resize(count);
+    forced.resize(count);
+}
+
+// Shared ending of every model: honk override, no reversing
+static inline float FinishSpeed(float v, bool forced) {
+    v = forced ? FORCED_SPEED : v;
+    return v > 0.0f ? v : 0.0f;
+}
+
+// Moves v toward target, by at most accel * dt up and decel * dt down
+static inline float Approach(float v, float target, float accel, float decel, float dt) {
+    float up = v + accel * dt;
+    float down = v - decel * dt;
+    float next = target < up ? target : up;
+    return next > down ? next : down;
+}
+
+// =============================================================================
+//  LEGACY (the original UpdateVehicle speed logic, same result bit for bit)
+// =============================================================================
+
+static void UpdateLegacy(const int* indices, int count, const FollowInputs& in, const FollowContext& ctx, VehicleStore& vs) {
+    const float minSafe = ctx.minSafeDist;
+    const float dt = ctx.dt;
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        float v = vs.speed[i];
+        float desired = vs.desiredSpeed[i];
+        float gap = in.gap[i];
+        float leader = in.leaderSpeed[i];
+        bool follow = gap < NO_FOLLOW_GAP;
+        bool stop = in.stopGap[i] < NO_FOLLOW_GAP;
+
+        // Target: stop, slow down between minSafeDist and the slowing distance, or cruise
+        float slowing = ctx.startSlowingDist + (v * 1.5f);
+        float factor = (gap - minSafe) / (slowing - minSafe);
+        float followTarget = (gap < minSafe) ? 0.0f : ((gap < slowing) ? leader + (desired - leader) * factor : desired);
+        float target = stop ? 0.0f : (follow ? followTarget : desired);
+
+        // Physics smoothing: accelerate 10, brake 15 (+ 0.5 per m/s), 50 when about to hit the leader
+        float braking = (follow && gap < minSafe + 2.0f && v > 1.0f) ? 50.0f : 15.0f + (v * 0.5f);
+        float down = v - braking * dt;
+        float up = v + 10.0f * dt;
+        float next = (v > target) ? (down < target ? target : down) : (up > target ? target : up);
+        vs.speed[i] = FinishSpeed(next, in.forced[i] != 0);
+    }
+}
+
+// =============================================================================
+//  IDM
+//  acc = a * (1 - (v/v0)^4 - (s*/s)^2),  s* = s0 + max(0, v*T + v*dv / (2*sqrt(a*b)))
+//  The stop line is a second, stopped leader; the lower acceleration wins.
+// =============================================================================
+
+static inline float IdmInteraction(float v, float dv, float gap, const FollowParams& p) {
+    float sStar = v * p.timeHeadway + v * dv / (2.0f * sqrtf(p.maxAccel * p.comfortDecel));
+    sStar = p.minGap + (sStar > 0.0f ? sStar : 0.0f);
+    float s = gap > 0.1f ? gap : 0.1f;
+    float r = sStar / s;
+    return r * r;
+}
+
+static void UpdateIdm(const int* indices, int count, const FollowInputs& in, const FollowContext& ctx, VehicleStore& vs) {
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        const FollowParams& p = GetVehicleTypeParams(vs.type[i]).follow;
+        float v = vs.speed[i];
+        float ratio = v / vs.desiredSpeed[i];
+        float free = 1.0f - (ratio * ratio) * (ratio * ratio);
+
+        float leader = IdmInteraction(v, v - in.leaderSpeed[i], in.gap[i], p);
+        float stop = IdmInteraction(v, v, in.stopGap[i], p);
+        float acc = p.maxAccel * (free - (leader > stop ? leader : stop));
+        acc = acc > -p.maxDecel ? acc : -p.maxDecel;
+
+        vs.speed[i] = FinishSpeed(v + acc * ctx.dt, in.forced[i] != 0);
+    }
+}
+
+// =============================================================================
+//  GIPPS
+//  vA = v + 2.5*a*tau*(1 - v/v0)*sqrt(0.025 + v/v0)          (free road)
+//  vB = -b*tau + sqrt(b^2*tau^2 + b*(2*(s - s0) - v*tau + vl^2/b))  (safe behind the leader)
+// =============================================================================
+
+static inline float GippsSafeSpeed(float v, float leader, float gap, const FollowParams& p) {
+    float b = p.comfortDecel;
+    float tau = p.reactionTime;
+    float root = b * b * tau * tau + b * (2.0f * (gap - p.minGap) - v * tau + leader * leader / b);
+    return -b * tau + sqrtf(root > 0.0f ? root : 0.0f);
+}
+
+static void UpdateGipps(const int* indices, int count, const FollowInputs& in, const FollowContext& ctx, VehicleStore& vs) {
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        const FollowParams& p = GetVehicleTypeParams(vs.type[i]).follow;
+        float v = vs.speed[i];
+        float ratio = v / vs.desiredSpeed[i];
+        float shape = 0.025f + ratio;
+        float free = v + 2.5f * p.maxAccel * p.reactionTime * (1.0f - ratio) * sqrtf(shape > 0.0f ? shape : 0.0f);
+
+        float safeLeader = GippsSafeSpeed(v, in.leaderSpeed[i], in.gap[i], p);
+        float safeStop = GippsSafeSpeed(v, 0.0f, in.stopGap[i], p);
+        float target = free < safeLeader ? free : safeLeader;
+        target = target < safeStop ? target : safeStop;
+
+        vs.speed[i] = FinishSpeed(Approach(v, target, p.maxAccel, p.maxDecel, ctx.dt), in.forced[i] != 0);
+    }
+}
+
+// =============================================================================
+//  KRAUSS
+//  vsafe = vl + (s - vl*tau) / ((v + vl) / (2*b) + tau)
+//  v = max(0, min(v + a*dt, v0, vsafe) - sigma*a*dt*noise)
+// =============================================================================
+
+// Deterministic noise in [0, 1): depends on the vehicle and the step, not on the thread
+static inline float DawdleNoise(int i, unsigned int step) {
+    unsigned int h = (unsigned int)i * 2654435761u ^ (step * 2246822519u + 0x9E3779B9u);
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float KraussSafeSpeed(float v, float leader, float gap, const FollowParams& p) {
+    float s = gap - p.minGap;
+    return leader + (s - leader * p.reactionTime) / ((v + leader) / (2.0f * p.comfortDecel) + p.reactionTime);
+}
+
+static void UpdateKrauss(const int* indices, int count, const FollowInputs& in, const FollowContext& ctx, VehicleStore& vs) {
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        const FollowParams& p = GetVehicleTypeParams(vs.type[i]).follow;
+        float v = vs.speed[i];
+
+        float target = v + p.maxAccel * ctx.dt;
+        target = target < vs.desiredSpeed[i] ? target : vs.desiredSpeed[i];
+        float safeLeader = KraussSafeSpeed(v, in.leaderSpeed[i], in.gap[i], p);
+        float safeStop = KraussSafeSpeed(v, 0.0f, in.stopGap[i], p);
+        target = target < safeLeader ? target : safeLeader;
+        target = target < safeStop ? target : safeStop;
+        target -= p.sigma * p.maxAccel * ctx.dt * DawdleNoise(i, ctx.step);
+
+        // No faster than the model allows, no harder braking than maxDecel
+        float down = v - p.maxDecel * ctx.dt;
+        vs.speed[i] = FinishSpeed(target > down ? target : down, in.forced[i] != 0);
+    }
+}
+
+// =============================================================================
+//  REGISTRY
+// =============================================================================
+
+static const FollowModelFunc MODEL_FUNCS[FOLLOW_MODEL_COUNT] = { UpdateLegacy, UpdateIdm, UpdateGipps, UpdateKrauss };
+static const char* MODEL_NAMES[FOLLOW_MODEL_COUNT] = { "legacy", "idm", "gipps", "krauss" };
+
+FollowModelFunc GetFollowModelFunc(FollowModel model) {
+    if (model < 0 || model >= FOLLOW_MODEL_COUNT) return UpdateLegacy;
+    return MODEL_FUNCS[model];
+}
+
+const char* GetFollowModelName(FollowModel model) {
+    if (model < 0 || model >= FOLLOW_MODEL_COUNT) return "type";
+    return MODEL_NAMES[model];
+}
+
+FollowModel FollowModelFromName(const char* name) {
+    for (int m = 0; m < FOLLOW_MODEL_COUNT; m++) {
+        if (strcmp(name, MODEL_NAMES[m]) == 0) return (FollowModel)m;
+    }
+    return FOLLOW_BY_TYPE;
+}
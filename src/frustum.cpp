@@ -0,0 +1,45 @@
+#include "frustum.h"
+#include <cmath>
+
+Frustum ExtractFrustum(Matrix m) {
+    // Rows of the clip transform (raymath: x' = m0*x + m4*y + m8*z + m12)
+    Vector4 row0 = { m.m0, m.m4, m.m8,  m.m12 };
+    Vector4 row1 = { m.m1, m.m5, m.m9,  m.m13 };
+    Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+
+    // Inside when -w <= x,y,z <= w (OpenGL clip space)
+    Frustum f;
+    f.planes[0] = { row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w }; // Left
+    f.planes[1] = { row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w }; // Right
+    f.planes[2] = { row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w }; // Bottom
+    f.planes[3] = { row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w }; // Top
+    f.planes[4] = { row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w }; // Near
+    f.planes[5] = { row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w }; // Far
+
+    for (Vector4& p : f.planes) {
+        float len = sqrtf(p.x*p.x + p.y*p.y + p.z*p.z);
+        if (len > 0.0f) {
+            p.x /= len; p.y /= len; p.z /= len; p.w /= len;
+        }
+    }
+    return f;
+}
+
+bool SphereInFrustum(const Frustum& frustum, Vector3 c, float radius) {
+    for (const Vector4& p : frustum.planes) {
+        if (p.x*c.x + p.y*c.y + p.z*c.z + p.w < -radius) return false;
+    }
+    return true;
+}
+
+bool BoxInFrustum(const Frustum& frustum, BoundingBox box) {
+    for (const Vector4& p : frustum.planes) {
+        // Corner furthest along the plane normal: if even that one is outside, the box is
+        Vector3 v = { p.x >= 0.0f ? box.max.x : box.min.x,
+                      p.y >= 0.0f ? box.max.y : box.min.y,
+                      p.z >= 0.0f ? box.max.z : box.min.z };
+        if (p.x*v.x + p.y*v.y + p.z*v.z + p.w < 0.0f) return false;
+    }
+    return true;
+}
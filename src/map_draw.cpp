@@ -0,0 +1,317 @@
+#include "map_draw.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <cmath>
+#include <utility>
+
+// =============================================================================
+//  MAP GEOMETRY
+// =============================================================================
+
+void MapGeometry::Clear() {
+    opaqueVertices.clear();
+    opaqueColors.clear();
+    translucentVertices.clear();
+    translucentColors.clear();
+    lineVertices.clear();
+    lineColors.clear();
+}
+
+int MapGeometry::GetTriangleCount() const {
+    return (int)((opaqueVertices.size() + translucentVertices.size()) / 9);
+}
+
+int MapGeometry::GetLineCount() const {
+    return (int)(lineVertices.size() / 6);
+}
+
+// =============================================================================
+//  RECORDER STATE
+// =============================================================================
+
+namespace {
+    MapGeometry* recordTarget = nullptr;
+
+    // CPU copy of the rlgl matrix stack (same multiplication order as rlTranslatef/rlRotatef)
+    Matrix currentMatrix = MatrixIdentity();
+    std::vector<Matrix> matrixStack;
+
+    // rlBegin/rlEnd emulation
+    int immediateMode = RL_TRIANGLES;
+    Color immediateColor = WHITE;
+    std::vector<Vector3> immediateVertices;
+    std::vector<Color> immediateColors;
+
+    void PushVertex(std::vector<float>& vertices, std::vector<unsigned char>& colors, Vector3 v, Color c) {
+        Vector3 w = Vector3Transform(v, currentMatrix);
+        vertices.push_back(w.x);
+        vertices.push_back(w.y);
+        vertices.push_back(w.z);
+        colors.push_back(c.r);
+        colors.push_back(c.g);
+        colors.push_back(c.b);
+        colors.push_back(c.a);
+    }
+
+    // Local-space triangle, kept as given (rlBegin path keeps raylib's winding)
+    void AddTriangleRaw(Vector3 a, Vector3 b, Vector3 c, Color ca, Color cb, Color cc) {
+        bool translucent = (ca.a < 255 || cb.a < 255 || cc.a < 255);
+        std::vector<float>& vertices = translucent ? recordTarget->translucentVertices : recordTarget->opaqueVertices;
+        std::vector<unsigned char>& colors = translucent ? recordTarget->translucentColors : recordTarget->opaqueColors;
+        PushVertex(vertices, colors, a, ca);
+        PushVertex(vertices, colors, b, cb);
+        PushVertex(vertices, colors, c, cc);
+    }
+
+    // Local-space triangle facing 'outward' (counter-clockwise seen from outside, like raylib's shapes)
+    void AddTriangle(Vector3 a, Vector3 b, Vector3 c, Vector3 outward, Color color) {
+        Vector3 n = Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a));
+        if (Vector3DotProduct(n, outward) < 0.0f) std::swap(b, c);
+        AddTriangleRaw(a, b, c, color, color, color);
+    }
+
+    void AddQuad(Vector3 a, Vector3 b, Vector3 c, Vector3 d, Vector3 outward, Color color) {
+        AddTriangle(a, b, c, outward, color);
+        AddTriangle(a, c, d, outward, color);
+    }
+
+    void AddLine(Vector3 a, Vector3 b, Color color) {
+        PushVertex(recordTarget->lineVertices, recordTarget->lineColors, a, color);
+        PushVertex(recordTarget->lineVertices, recordTarget->lineColors, b, color);
+    }
+
+    // Point on a ring of radius r around 'center' in the plane spanned by (u, v)
+    Vector3 RingPoint(Vector3 center, Vector3 u, Vector3 v, float r, float angle) {
+        return Vector3Add(center, Vector3Add(Vector3Scale(u, cosf(angle) * r), Vector3Scale(v, sinf(angle) * r)));
+    }
+
+    // Truncated cone from 'base' to 'top' (DrawCylinder / DrawCylinderEx)
+    void AddTube(Vector3 base, Vector3 top, Vector3 u, Vector3 v, float baseRadius, float topRadius, int sides, Color color) {
+        if (sides < 3) sides = 3;
+        Vector3 axis = Vector3Subtract(top, base);
+        float step = 2.0f * PI / sides;
+
+        for (int i = 0; i < sides; i++) {
+            float a0 = i * step;
+            float a1 = (i + 1) * step;
+            Vector3 b0 = RingPoint(base, u, v, baseRadius, a0);
+            Vector3 b1 = RingPoint(base, u, v, baseRadius, a1);
+            Vector3 t0 = RingPoint(top, u, v, topRadius, a0);
+            Vector3 t1 = RingPoint(top, u, v, topRadius, a1);
+            Vector3 radial = RingPoint({0, 0, 0}, u, v, 1.0f, (a0 + a1) * 0.5f);
+
+            AddQuad(b0, b1, t1, t0, radial, color);
+            if (topRadius > 0.0f) AddTriangle(top, t0, t1, axis, color);
+            if (baseRadius > 0.0f) AddTriangle(base, b0, b1, Vector3Scale(axis, -1.0f), color);
+        }
+    }
+
+    void AddTubeWires(Vector3 base, Vector3 top, Vector3 u, Vector3 v, float baseRadius, float topRadius, int sides, Color color) {
+        if (sides < 3) sides = 3;
+        float step = 2.0f * PI / sides;
+
+        for (int i = 0; i < sides; i++) {
+            Vector3 b0 = RingPoint(base, u, v, baseRadius, i * step);
+            Vector3 b1 = RingPoint(base, u, v, baseRadius, (i + 1) * step);
+            Vector3 t0 = RingPoint(top, u, v, topRadius, i * step);
+            Vector3 t1 = RingPoint(top, u, v, topRadius, (i + 1) * step);
+            AddLine(b0, b1, color);
+            AddLine(t0, t1, color);
+            AddLine(b0, t0, color);
+        }
+    }
+
+    void CubeCorners(Vector3 p, float w, float h, float l, Vector3 c[8]) {
+        float x0 = p.x - w / 2, x1 = p.x + w / 2;
+        float y0 = p.y - h / 2, y1 = p.y + h / 2;
+        float z0 = p.z - l / 2, z1 = p.z + l / 2;
+        c[0] = {x0, y0, z0}; c[1] = {x1, y0, z0}; c[2] = {x1, y0, z1}; c[3] = {x0, y0, z1};
+        c[4] = {x0, y1, z0}; c[5] = {x1, y1, z0}; c[6] = {x1, y1, z1}; c[7] = {x0, y1, z1};
+    }
+}
+
+// =============================================================================
+//  RECORDING CONTROL
+// =============================================================================
+
+void MapDraw::BeginRecording(MapGeometry* target) {
+    recordTarget = target;
+    currentMatrix = MatrixIdentity();
+    matrixStack.clear();
+}
+
+void MapDraw::EndRecording() {
+    recordTarget = nullptr;
+}
+
+bool MapDraw::IsRecording() {
+    return recordTarget != nullptr;
+}
+
+// =============================================================================
+//  SHAPES
+// =============================================================================
+
+void MapDraw::DrawCube(Vector3 position, float width, float height, float length, Color color) {
+    if (!recordTarget) { ::DrawCube(position, width, height, length, color); return; }
+
+    Vector3 c[8];
+    CubeCorners(position, width, height, length, c);
+    AddQuad(c[4], c[5], c[6], c[7], {0, 1, 0}, color);   // Top
+    AddQuad(c[0], c[1], c[2], c[3], {0, -1, 0}, color);  // Bottom
+    AddQuad(c[3], c[2], c[6], c[7], {0, 0, 1}, color);   // Front
+    AddQuad(c[0], c[1], c[5], c[4], {0, 0, -1}, color);  // Back
+    AddQuad(c[1], c[2], c[6], c[5], {1, 0, 0}, color);   // Right
+    AddQuad(c[0], c[3], c[7], c[4], {-1, 0, 0}, color);  // Left
+}
+
+void MapDraw::DrawCubeWires(Vector3 position, float width, float height, float length, Color color) {
+    if (!recordTarget) { ::DrawCubeWires(position, width, height, length, color); return; }
+
+    Vector3 c[8];
+    CubeCorners(position, width, height, length, c);
+    for (int i = 0; i < 4; i++) {
+        AddLine(c[i], c[(i + 1) % 4], color);          // Bottom ring
+        AddLine(c[4 + i], c[4 + (i + 1) % 4], color);  // Top ring
+        AddLine(c[i], c[4 + i], color);                // Vertical edge
+    }
+}
+
+void MapDraw::DrawCylinder(Vector3 position, float radiusTop, float radiusBottom, float height, int slices, Color color) {
+    if (!recordTarget) { ::DrawCylinder(position, radiusTop, radiusBottom, height, slices, color); return; }
+
+    // raylib: 'position' is the center of the bottom cap
+    Vector3 top = { position.x, position.y + height, position.z };
+    AddTube(position, top, {0, 0, 1}, {1, 0, 0}, radiusBottom, radiusTop, slices, color);
+}
+
+void MapDraw::DrawCylinderEx(Vector3 startPos, Vector3 endPos, float startRadius, float endRadius, int sides, Color color) {
+    if (!recordTarget) { ::DrawCylinderEx(startPos, endPos, startRadius, endRadius, sides, color); return; }
+
+    Vector3 direction = Vector3Subtract(endPos, startPos);
+    if (Vector3Length(direction) < 0.00001f) return;
+
+    // Any basis perpendicular to the axis will do (cross with the least aligned world axis)
+    Vector3 helper = (fabsf(direction.y) < fabsf(direction.x) && fabsf(direction.y) < fabsf(direction.z)) ? (Vector3){0, 1, 0}
+                   : (fabsf(direction.x) < fabsf(direction.z)) ? (Vector3){1, 0, 0} : (Vector3){0, 0, 1};
+    Vector3 u = Vector3Normalize(Vector3CrossProduct(direction, helper));
+    Vector3 v = Vector3Normalize(Vector3CrossProduct(u, direction));
+    AddTube(startPos, endPos, u, v, startRadius, endRadius, sides, color);
+}
+
+void MapDraw::DrawCylinderWires(Vector3 position, float radiusTop, float radiusBottom, float height, int slices, Color color) {
+    if (!recordTarget) { ::DrawCylinderWires(position, radiusTop, radiusBottom, height, slices, color); return; }
+
+    Vector3 top = { position.x, position.y + height, position.z };
+    AddTubeWires(position, top, {0, 0, 1}, {1, 0, 0}, radiusBottom, radiusTop, slices, color);
+}
+
+void MapDraw::DrawSphere(Vector3 centerPos, float radius, Color color) {
+    if (!recordTarget) { ::DrawSphere(centerPos, radius, color); return; }
+
+    // Same density as raylib's DrawSphere (16 rings, 16 slices)
+    const int rings = 16 + 2;
+    const int slices = 16;
+    for (int i = 0; i < rings; i++) {
+        float lat0 = -PI / 2 + PI * i / rings;
+        float lat1 = -PI / 2 + PI * (i + 1) / rings;
+        for (int j = 0; j < slices; j++) {
+            float lon0 = 2.0f * PI * j / slices;
+            float lon1 = 2.0f * PI * (j + 1) / slices;
+            Vector3 p[4] = {
+                { cosf(lat0) * sinf(lon0), sinf(lat0), cosf(lat0) * cosf(lon0) },
+                { cosf(lat0) * sinf(lon1), sinf(lat0), cosf(lat0) * cosf(lon1) },
+                { cosf(lat1) * sinf(lon1), sinf(lat1), cosf(lat1) * cosf(lon1) },
+                { cosf(lat1) * sinf(lon0), sinf(lat1), cosf(lat1) * cosf(lon0) },
+            };
+            Vector3 outward = Vector3Scale(Vector3Add(p[0], p[2]), 0.5f);
+            for (int k = 0; k < 4; k++) p[k] = Vector3Add(centerPos, Vector3Scale(p[k], radius));
+            AddQuad(p[0], p[1], p[2], p[3], outward, color);
+        }
+    }
+}
+
+void MapDraw::DrawLine3D(Vector3 startPos, Vector3 endPos, Color color) {
+    if (!recordTarget) { ::DrawLine3D(startPos, endPos, color); return; }
+    AddLine(startPos, endPos, color);
+}
+
+void MapDraw::DrawPlane(Vector3 centerPos, Vector2 size, Color color) {
+    if (!recordTarget) { ::DrawPlane(centerPos, size, color); return; }
+
+    float hx = size.x / 2, hz = size.y / 2;
+    AddQuad({centerPos.x - hx, centerPos.y, centerPos.z - hz}, {centerPos.x + hx, centerPos.y, centerPos.z - hz},
+            {centerPos.x + hx, centerPos.y, centerPos.z + hz}, {centerPos.x - hx, centerPos.y, centerPos.z + hz},
+            {0, 1, 0}, color);
+}
+
+// =============================================================================
+//  MATRIX STACK + IMMEDIATE VERTICES
+// =============================================================================
+
+void MapDraw::PushMatrix() {
+    if (!recordTarget) { rlPushMatrix(); return; }
+    matrixStack.push_back(currentMatrix);
+}
+
+void MapDraw::PopMatrix() {
+    if (!recordTarget) { rlPopMatrix(); return; }
+    if (matrixStack.empty()) return;
+    currentMatrix = matrixStack.back();
+    matrixStack.pop_back();
+}
+
+void MapDraw::Translatef(float x, float y, float z) {
+    if (!recordTarget) { rlTranslatef(x, y, z); return; }
+    currentMatrix = MatrixMultiply(MatrixTranslate(x, y, z), currentMatrix);
+}
+
+void MapDraw::Rotatef(float angle, float x, float y, float z) {
+    if (!recordTarget) { rlRotatef(angle, x, y, z); return; }
+    currentMatrix = MatrixMultiply(MatrixRotate(Vector3Normalize({x, y, z}), angle * DEG2RAD), currentMatrix);
+}
+
+void MapDraw::Begin(int mode) {
+    if (!recordTarget) { rlBegin(mode); return; }
+    immediateMode = mode;
+    immediateVertices.clear();
+    immediateColors.clear();
+}
+
+void MapDraw::Color4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    if (!recordTarget) { rlColor4ub(r, g, b, a); return; }
+    immediateColor = { r, g, b, a };
+}
+
+void MapDraw::Vertex3f(float x, float y, float z) {
+    if (!recordTarget) { rlVertex3f(x, y, z); return; }
+    immediateVertices.push_back({ x, y, z });
+    immediateColors.push_back(immediateColor);
+}
+
+void MapDraw::End() {
+    if (!recordTarget) { rlEnd(); return; }
+
+    const std::vector<Vector3>& v = immediateVertices;
+    const std::vector<Color>& c = immediateColors;
+    if (immediateMode == RL_QUADS) {
+        // rlgl splits quads as (0,1,2) (0,2,3)
+        for (size_t i = 0; i + 3 < v.size(); i += 4) {
+            AddTriangleRaw(v[i], v[i + 1], v[i + 2], c[i], c[i + 1], c[i + 2]);
+            AddTriangleRaw(v[i], v[i + 2], v[i + 3], c[i], c[i + 2], c[i + 3]);
+        }
+    }
+    else if (immediateMode == RL_TRIANGLES) {
+        for (size_t i = 0; i + 2 < v.size(); i += 3) {
+            AddTriangleRaw(v[i], v[i + 1], v[i + 2], c[i], c[i + 1], c[i + 2]);
+        }
+    }
+    else if (immediateMode == RL_LINES) {
+        for (size_t i = 0; i + 1 < v.size(); i += 2) {
+            PushVertex(recordTarget->lineVertices, recordTarget->lineColors, v[i], c[i]);
+            PushVertex(recordTarget->lineVertices, recordTarget->lineColors, v[i + 1], c[i + 1]);
+        }
+    }
+    immediateVertices.clear();
+    immediateColors.clear();
+}
@@ -0,0 +1,76 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+bool MappedFile::Open(const char* path) {
+    Close();
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(f, &length) || length.QuadPart == 0) {
+        CloseHandle(f);
+        return false;
+    }
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) {
+        CloseHandle(f);
+        return false;
+    }
+    void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(m);
+        CloseHandle(f);
+        return false;
+    }
+
+    file = f;
+    mapping = m;
+    data = (const unsigned char*)view;
+    size = (size_t)length.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle((HANDLE)mapping);
+    if (file) CloseHandle((HANDLE)file);
+    data = nullptr;
+    size = 0;
+    mapping = nullptr;
+    file = nullptr;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::Open(const char* path) {
+    Close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+
+    data = (const unsigned char*)view;
+    size = (size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) munmap((void*)data, size);
+    data = nullptr;
+    size = 0;
+}
+#endif
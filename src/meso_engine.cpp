@@ -0,0 +1,324 @@
+#include "meso_engine.h"
+#include "router.h"
+#include "raymath.h"
+#include <cmath>
+
+constexpr float MesoEngine::JAM_SPACING;
+constexpr float MesoEngine::SATURATION_HEADWAY;
+constexpr float MesoEngine::STUCK_TIME;
+
+static const double NO_EVENT = 1.0e30;
+
+// =============================================================================
+//  SETUP
+// =============================================================================
+
+void MesoEngine::Build(const RoadGraph& graph) {
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+
+    // One road per frozen edge of the graph, same index (live times are sampled by index)
+    graph.Freeze();
+    int roadCount = graph.GetEdgeCount();
+    edgeBase.clear();
+    edgeFrom.resize(roadCount);
+    edgeBranch.resize(roadCount);
+    edgeTo.resize(roadCount);
+    edgeLength.resize(roadCount);
+    edgeCapacity.resize(roadCount);
+
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        const Node& n = nodes[i];
+        if (n.id >= (int)edgeBase.size()) edgeBase.resize(n.id + 1, -1);
+        if (edgeBase[n.id] != -1) continue; // Duplicate id: GetNode returns the first one
+        int first = graph.GetEdgeBegin(i);
+        edgeBase[n.id] = first;
+        for (int e = first; e < graph.GetEdgeEnd(i); e++) {
+            float length = graph.GetEdgeLength(e);
+            int capacity = (int)(length / JAM_SPACING);
+            edgeFrom[e] = n.id;
+            edgeBranch[e] = e - first;
+            edgeTo[e] = n.nextNodes[e - first];
+            edgeLength[e] = length;
+            edgeCapacity[e] = capacity > 1 ? capacity : 1;
+        }
+    }
+
+    // Roads into a teleport continue on the landing's first road (same as the micro engine)
+    edgeExit.assign(roadCount, -1);
+    for (int e = 0; e < roadCount; e++) {
+        const Node& to = graph.GetNode(edgeTo[e]);
+        if (to.IsValid() && to.type == TELEPORT) edgeExit[e] = FindEdge(to.teleportTargetId, 0);
+    }
+
+    Clear();
+}
+
+void MesoEngine::Clear() {
+    int roadCount = (int)edgeTo.size();
+    queueHead.assign(roadCount, -1);
+    queueTail.assign(roadCount, -1);
+    queueCount.assign(roadCount, 0);
+    nextDeparture.assign(roadCount, 0.0);
+    eventTime.assign(roadCount, NO_EVENT);
+    waitingOn.assign(roadCount, -1);
+    waitNext.assign(roadCount, -1);
+    waitHead.assign(roadCount, -1);
+    lightBlocked.assign(roadCount, 0);
+    lightWaiting.clear();
+    events = std::priority_queue<Event, std::vector<Event>, LaterEvent>();
+
+    vehEdge.clear();
+    vehNext.clear();
+    vehEnter.clear();
+    vehReady.clear();
+    vehBlocked.clear();
+    vehChoice.clear();
+    vehJumped.clear();
+
+    clock = 0.0;
+    tripCount = 0;
+    moveCount = 0;
+    stuckCount = 0;
+}
+
+int MesoEngine::FindEdge(int fromId, int branch) const {
+    if (fromId < 0 || fromId >= (int)edgeBase.size() || edgeBase[fromId] < 0 || branch < 0) return -1;
+    int e = edgeBase[fromId] + branch;
+    return (e < (int)edgeFrom.size() && edgeFrom[e] == fromId) ? e : -1;
+}
+
+bool MesoEngine::HasRoom(int fromId, int branch) const {
+    int e = FindEdge(fromId, branch);
+    return e != -1 && queueCount[e] < edgeCapacity[e];
+}
+
+void MesoEngine::ResizeVehicles(int count) {
+    if ((int)vehEdge.size() >= count) return;
+    vehEdge.resize(count, -1);
+    vehNext.resize(count, -1);
+    vehEnter.resize(count, 0.0);
+    vehReady.resize(count, 0.0);
+    vehBlocked.resize(count, -1.0);
+    vehChoice.resize(count, -1);
+    vehJumped.resize(count, 0);
+}
+
+void MesoEngine::Insert(VehicleStore& vehicles, int i) {
+    ResizeVehicles(vehicles.Size());
+    int e = FindEdge(vehicles.edgeFromId[i], vehicles.edgeBranch[i]);
+    if (e == -1 || vehEdge[i] != -1) return;
+
+    vehEdge[i] = e;
+    vehNext[i] = -1;
+    vehEnter[i] = clock;
+    vehReady[i] = clock + edgeLength[e] / vehicles.desiredSpeed[i];
+    vehBlocked[i] = -1.0;
+    vehChoice[i] = -1;
+    if (queueTail[e] != -1) vehNext[queueTail[e]] = i;
+    else queueHead[e] = i;
+    queueTail[e] = i;
+    queueCount[e]++;
+    if (queueCount[e] == 1) Schedule(e, vehReady[i]);
+}
+
+// =============================================================================
+//  EVENTS
+// =============================================================================
+
+void MesoEngine::Schedule(int edge, double time) {
+    if (time >= eventTime[edge]) return; // An earlier event is already pending
+    eventTime[edge] = time;
+    events.push({ time, edge });
+}
+
+void MesoEngine::StopWaiting(int edge) {
+    int on = waitingOn[edge];
+    if (on == -1) return;
+    int* link = &waitHead[on];
+    while (*link != edge) link = &waitNext[*link];
+    *link = waitNext[edge];
+    waitingOn[edge] = -1;
+    waitNext[edge] = -1;
+}
+
+void MesoEngine::Update(float dt, VehicleStore& vehicles, RoadGraph& graph, const Router* router) {
+    ResizeVehicles(vehicles.Size());
+    double tickStart = clock;
+    clock += dt;
+
+    // Lights only change between ticks: release the heads whose light turned green
+    for (int k = 0; k < (int)lightWaiting.size(); ) {
+        int e = lightWaiting[k];
+        LightState light = graph.GetNode(edgeTo[e]).lightState;
+        if (light == LIGHT_RED || light == LIGHT_YELLOW) {
+            k++;
+            continue;
+        }
+        lightBlocked[e] = 0;
+        lightWaiting[k] = lightWaiting.back();
+        lightWaiting.pop_back();
+        Schedule(e, tickStart);
+    }
+
+    while (!events.empty() && events.top().time <= clock) {
+        Event ev = events.top();
+        events.pop();
+        if (ev.time != eventTime[ev.edge]) continue; // Replaced by an earlier one
+        eventTime[ev.edge] = NO_EVENT;
+        Discharge(ev.edge, ev.time, vehicles, graph, router);
+    }
+
+    PlaceVehicles(vehicles, graph);
+}
+
+// Lets the heads of 'edge' leave, as long as they are ready and have somewhere to go
+void MesoEngine::Discharge(int edge, double time, VehicleStore& vehicles, RoadGraph& graph, const Router* router) {
+    while (queueHead[edge] != -1) {
+        int v = queueHead[edge];
+        double ready = vehReady[v] > nextDeparture[edge] ? vehReady[v] : nextDeparture[edge];
+        if (ready > time) {
+            Schedule(edge, ready);
+            return;
+        }
+
+        const Node& node = graph.GetNode(edgeTo[edge]);
+        if ((node.lightState == LIGHT_RED || node.lightState == LIGHT_YELLOW) && !vehicles.IsEmergency(v)) {
+            if (!lightBlocked[edge]) {
+                lightBlocked[edge] = 1;
+                lightWaiting.push_back(edge);
+            }
+            return;
+        }
+
+        // Where the head goes: off the network, the landing of a teleport, or the branch it picks (once)
+        bool leaves = node.type == TELEPORT && globalConfig.VehiclesLeaveAtExits();
+        int next = -1;
+        if (leaves) {
+            // No road to enter: nothing can block it
+        }
+        else if (node.type == TELEPORT) {
+            next = edgeExit[edge];
+        }
+        else if (!node.nextNodes.empty()) {
+            if (vehChoice[v] < 0) vehChoice[v] = ChooseNextBranch(vehicles, v, node, graph, router);
+            next = FindEdge(node.id, vehChoice[v]);
+        }
+        if (next == -1 && !leaves) return; // Dead end or broken teleport: waits forever, like in the micro engine
+
+        // Spillback: wait for room (woken by a departure there), but not longer than STUCK_TIME
+        if (!leaves && queueCount[next] >= edgeCapacity[next]) {
+            if (vehBlocked[v] < 0.0) vehBlocked[v] = time;
+            if (time - vehBlocked[v] < STUCK_TIME) {
+                if (waitingOn[edge] != next) {
+                    StopWaiting(edge); // Still listed on the road of the previous head
+                    waitingOn[edge] = next;
+                    waitNext[edge] = waitHead[next];
+                    waitHead[next] = edge;
+                }
+                Schedule(edge, vehBlocked[v] + STUCK_TIME);
+                return;
+            }
+            stuckCount++;
+        }
+        StopWaiting(edge); // Pushed in after STUCK_TIME: the next head waits on its own road
+
+        if (node.type == TELEPORT) {
+            // Trip over (or random turns until here): AssignTrips gives a new one
+            if (vehicles.tripDestination[v] == node.id || vehicles.tripDestination[v] == VehicleStore::TRIP_RANDOM) {
+                vehicles.tripDestination[v] = VehicleStore::TRIP_NONE;
+            }
+            vehJumped[v] = 1;
+            tripCount++;
+        }
+        if (leaves) Leave(v, edge, time, vehicles, graph);
+        else Move(v, edge, next, time, vehicles, graph);
+        nextDeparture[edge] = time + SATURATION_HEADWAY;
+
+        // Room freed here: the roads waiting for it try again now
+        for (int w = waitHead[edge]; w != -1; ) {
+            int after = waitNext[w];
+            waitingOn[w] = -1;
+            waitNext[w] = -1;
+            Schedule(w, time);
+            w = after;
+        }
+        waitHead[edge] = -1;
+    }
+}
+
+void MesoEngine::Dequeue(int v, int from, double time, VehicleStore& vehicles, RoadGraph& graph) {
+    // Out of 'from' (v is its head): its traversal time feeds the live travel time of the road
+    queueHead[from] = vehNext[v];
+    if (queueHead[from] == -1) queueTail[from] = -1;
+    queueCount[from]--;
+    double spent = time - vehEnter[v];
+    float speed = spent > 0.0 ? (float)(edgeLength[from] / spent) : vehicles.desiredSpeed[v];
+    graph.AddEdgeSpeedSample(from, speed); // Same index as the graph's edge
+}
+
+void MesoEngine::Leave(int v, int from, double time, VehicleStore& vehicles, RoadGraph& graph) {
+    Dequeue(v, from, time, vehicles, graph);
+    vehEdge[v] = -1; // The slot can be inserted again once reused
+    vehNext[v] = -1;
+    vehJumped[v] = 0;
+    vehicles.exits.push_back({ vehicles.type[v], edgeTo[from] });
+    vehicles.Remove(v);
+}
+
+void MesoEngine::Move(int v, int from, int to, double time, VehicleStore& vehicles, RoadGraph& graph) {
+    Dequeue(v, from, time, vehicles, graph);
+
+    // Into 'to'
+    vehEdge[v] = to;
+    vehNext[v] = -1;
+    vehEnter[v] = time;
+    vehReady[v] = time + edgeLength[to] / vehicles.desiredSpeed[v];
+    vehBlocked[v] = -1.0;
+    vehChoice[v] = -1;
+    if (queueTail[to] != -1) vehNext[queueTail[to]] = v;
+    else queueHead[to] = v;
+    queueTail[to] = v;
+    queueCount[to]++;
+    if (queueCount[to] == 1) Schedule(to, vehReady[v]);
+
+    vehicles.targetNodeId[v] = edgeTo[to];
+    vehicles.edgeFromId[v] = edgeFrom[to];
+    vehicles.edgeBranch[v] = edgeBranch[to];
+    moveCount++;
+}
+
+// =============================================================================
+//  POSITIONS
+//  Free-flow progress along the road, held back behind the vehicles queued ahead
+//  (JAM_SPACING each). Only the lights (detectors) and the renderer read them.
+// =============================================================================
+
+void MesoEngine::PlaceVehicles(VehicleStore& vehicles, const RoadGraph& graph) {
+    int roadCount = (int)edgeTo.size();
+    for (int e = 0; e < roadCount; e++) {
+        if (queueHead[e] == -1) continue;
+        Vector3 a = graph.GetNode(edgeFrom[e]).pos;
+        Vector3 b = graph.GetNode(edgeTo[e]).pos;
+        float length = edgeLength[e];
+        Vector3 dir = length > 0.0f ? Vector3Scale(Vector3Subtract(b, a), 1.0f / length) : vehicles.forward[queueHead[e]];
+
+        float limit = length; // Front of the queue
+        for (int v = queueHead[e]; v != -1; v = vehNext[v]) {
+            double travel = vehReady[v] - vehEnter[v];
+            float along = travel > 0.0 ? (float)((clock - vehEnter[v]) / travel) * length : length;
+            bool queued = along >= limit;
+            if (queued) along = limit;
+            if (along < 0.0f) along = 0.0f;
+
+            vehicles.position[v] = Vector3Add(a, Vector3Scale(dir, along));
+            vehicles.forward[v] = dir;
+            vehicles.speed[v] = queued ? 0.0f : vehicles.desiredSpeed[v];
+            if (vehJumped[v]) {
+                vehicles.prevPosition[v] = vehicles.position[v];
+                vehicles.prevForward[v] = vehicles.forward[v];
+                vehJumped[v] = 0;
+            }
+            limit = along - JAM_SPACING;
+        }
+    }
+}
@@ -0,0 +1,771 @@
+#include "osm_import.h"
+#include "worker_pool.h"
+#include "raymath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+// =============================================================================
+//  XML STREAM
+//  Just enough XML for OSM: tags and their attributes, read through a buffer
+//  that only grows for a tag that does not fit (capped). Text, comments and
+//  declarations are skipped; entities are left as they are (only ids, numbers
+//  and a few tag values are looked at).
+// =============================================================================
+
+namespace {
+    const size_t XML_BUFFER = 1 << 16;
+    const size_t XML_MAX_TAG = 1 << 20;
+
+    class XmlStream {
+    public:
+        struct Attr {
+            const char* key;
+            int keyLen;
+            const char* value;      // Ends on its quote: strtod/strtoll stop there
+            int valueLen;
+        };
+
+        // Current tag (pointers into the buffer, valid until the next Next())
+        const char* name = nullptr;
+        int nameLen = 0;
+        bool closing = false;       // </name>
+        bool selfClosing = false;   // <name ... />
+        std::vector<Attr> attrs;
+
+        std::string error;
+        long long bytesRead = 0;
+
+        ~XmlStream() { if (file) fclose(file); }
+
+        bool Open(const char* path) {
+            file = fopen(path, "rb");
+            buf.resize(XML_BUFFER);
+            return file != nullptr;
+        }
+
+        // Next tag. false at the end of the file or on error (error is set)
+        bool Next() {
+            for (;;) {
+                const char* lt = (const char*)memchr(buf.data() + begin, '<', end - begin);
+                if (!lt) {
+                    begin = end;
+                    if (!Fill()) return false;
+                    continue;
+                }
+                begin = lt - buf.data();
+                if (end - begin < 4 && !eof) {
+                    if (!Fill() && !error.empty()) return false;
+                    continue;
+                }
+
+                bool comment = end - begin >= 4 && memcmp(lt, "<!--", 4) == 0;
+                size_t close = comment ? Search("-->", begin + 4) : Search(">", begin + 1);
+                if (close == std::string::npos) {
+                    if (!Fill()) return Truncated();
+                    continue;
+                }
+                size_t tagBegin = begin;
+                begin = close + 1;
+                if (comment || lt[1] == '?' || lt[1] == '!') continue;
+                if (!Parse(tagBegin, close)) return false;
+                return true;
+            }
+        }
+
+        bool Is(const char* tag) const {
+            return (int)strlen(tag) == nameLen && memcmp(name, tag, nameLen) == 0;
+        }
+
+        const Attr* Find(const char* key) const {
+            int len = (int)strlen(key);
+            for (const Attr& a : attrs) {
+                if (a.keyLen == len && memcmp(a.key, key, len) == 0) return &a;
+            }
+            return nullptr;
+        }
+        bool Equals(const char* key, const char* value) const {
+            const Attr* a = Find(key);
+            return a && a->valueLen == (int)strlen(value) && memcmp(a->value, value, a->valueLen) == 0;
+        }
+        long long Int(const char* key) const {
+            const Attr* a = Find(key);
+            return a ? strtoll(a->value, nullptr, 10) : 0;
+        }
+        double Double(const char* key) const {
+            const Attr* a = Find(key);
+            return a ? strtod(a->value, nullptr) : 0.0;
+        }
+        std::string String(const char* key) const {
+            const Attr* a = Find(key);
+            return a ? std::string(a->value, a->valueLen) : std::string();
+        }
+
+    private:
+        FILE* file = nullptr;
+        std::vector<char> buf;
+        size_t begin = 0, end = 0;
+        bool eof = false;
+
+        // Moves the unread bytes to the front and reads more. false at the end of the file
+        bool Fill() {
+            if (eof) return false;
+            if (begin > 0) {
+                memmove(buf.data(), buf.data() + begin, end - begin);
+                end -= begin;
+                begin = 0;
+            }
+            if (end == buf.size()) {
+                if (buf.size() >= XML_MAX_TAG) {
+                    error = "tag larger than 1 MB";
+                    return false;
+                }
+                buf.resize(buf.size() * 2);
+            }
+            size_t n = fread(buf.data() + end, 1, buf.size() - end, file);
+            bytesRead += (long long)n;
+            end += n;
+            if (n == 0) eof = true;
+            return n > 0;
+        }
+
+        bool Truncated() {
+            if (error.empty()) error = "unexpected end of file inside a tag";
+            return false;
+        }
+
+        size_t Search(const char* what, size_t from) const {
+            size_t len = strlen(what);
+            for (size_t k = from; k + len <= end; k++) {
+                if (buf[k] == what[0] && memcmp(buf.data() + k, what, len) == 0) return k;
+            }
+            return std::string::npos;
+        }
+
+        static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+        // Tag in [from, close], buf[close] == '>'
+        bool Parse(size_t from, size_t close) {
+            const char* p = buf.data() + from + 1;
+            const char* stop = buf.data() + close;
+            closing = *p == '/';
+            if (closing) p++;
+            selfClosing = stop[-1] == '/';
+            if (selfClosing) stop--;
+
+            name = p;
+            while (p < stop && !IsSpace(*p)) p++;
+            nameLen = (int)(p - name);
+
+            attrs.clear();
+            for (;;) {
+                while (p < stop && IsSpace(*p)) p++;
+                if (p >= stop) break;
+                Attr a;
+                a.key = p;
+                while (p < stop && *p != '=' && !IsSpace(*p)) p++;
+                a.keyLen = (int)(p - a.key);
+                while (p < stop && *p != '"' && *p != '\'') p++;
+                if (p >= stop) {
+                    error = "malformed attribute";
+                    return false;
+                }
+                char quote = *p++;
+                a.value = p;
+                while (p < stop && *p != quote) p++;
+                if (p >= stop) {
+                    error = "unterminated attribute value";
+                    return false;
+                }
+                a.valueLen = (int)(p - a.value);
+                p++;
+                attrs.push_back(a);
+            }
+            return true;
+        }
+    };
+
+    bool EndsWith(const char* path, const char* suffix) {
+        size_t n = strlen(path), m = strlen(suffix);
+        return n >= m && strcmp(path + n - m, suffix) == 0;
+    }
+}
+
+// =============================================================================
+//  IMPORT STATE
+// =============================================================================
+
+namespace {
+    // Roads worth driving on (the *_link variants are accepted too)
+    const char* const DRIVABLE[] = {
+        "motorway", "trunk", "primary", "secondary", "tertiary", "unclassified",
+        "residential", "living_street", "service", "road"
+    };
+
+    const float LANE_FIRST_OFFSET = 2.5f;   // Same lanes as road_network.cpp
+    const float LANE_SPACING = 4.25f;
+    const int MAX_LANES = 3;                // Per direction
+    const float METERS_PER_DEGREE = 111320.0f;
+    const float STRAIGHT_ANGLE = 35.0f * DEG2RAD;
+    const float MIN_LINK_LENGTH = 0.5f;
+
+    struct Way {
+        std::vector<int> nodes;     // Compact node indices
+        int oneway;                 // 0 both ways, 1 forward only, -1 backward only
+        int lanes;                  // Per direction
+    };
+
+    struct Link {
+        int from, to;               // Junctions
+        std::vector<int> nodes;     // Compact node indices, from .. to
+        int oneway;
+        int lanes;
+    };
+
+    // One direction of a link
+    struct Carriageway {
+        int link;
+        int twin = -1;              // Same link, other direction
+        bool reverse;
+        int from, to;               // Junctions
+        bool fromBoundary = false, toBoundary = false;
+        int laneCount;
+
+        // Built in parallel
+        std::vector<std::vector<Vector3>> lanes;
+        Vector3 startDir = { 0, 0, 1 }, endDir = { 0, 0, 1 };
+
+        // Node ids of lane k: laneFirst[k] .. + lanes[k].size()
+        std::vector<int> laneFirst;
+        int StartId(int k) const { return laneFirst[k]; }
+        int StopId(int k) const { return laneFirst[k] + (int)lanes[k].size() - 1; }
+    };
+
+    struct Turn {
+        int fromLane, toWay, toLane;    // toWay is a carriageway
+        int fromWay;
+        float angle;                    // Signed, right turns positive
+        std::vector<Vector3> points;    // Interior (ARC) points
+        int firstId = -1;
+    };
+
+    float Cross2(Vector3 a, Vector3 b) { return a.x * b.z - a.z * b.x; }
+    float Dot2(Vector3 a, Vector3 b) { return a.x * b.x + a.z * b.z; }
+    Vector3 Dir2(Vector3 from, Vector3 to) {
+        Vector3 d = { to.x - from.x, 0.0f, to.z - from.z };
+        float len = sqrtf(d.x * d.x + d.z * d.z);
+        return len > 1e-6f ? Vector3{ d.x / len, 0.0f, d.z / len } : Vector3{ 0, 0, 1 };
+    }
+    Vector3 RightOf(Vector3 dir) { return { -dir.z, 0.0f, dir.x }; } // +x east, +z south
+
+    bool IsDrivable(const std::string& highway) {
+        std::string base = highway;
+        size_t link = base.find("_link");
+        if (link != std::string::npos && link + 5 == base.size()) base.resize(link);
+        for (const char* d : DRIVABLE) {
+            if (base == d) return true;
+        }
+        return false;
+    }
+
+    // Polyline between arc lengths s0 and s1 (s0 < s1), nearly collinear points dropped
+    std::vector<Vector3> Cut(const std::vector<Vector3>& line, float s0, float s1) {
+        std::vector<Vector3> out;
+        float s = 0.0f;
+        for (size_t k = 0; k + 1 < line.size(); k++) {
+            float len = Vector3Distance(line[k], line[k + 1]);
+            float a = s, b = s + len;
+            s = b;
+            if (b < s0 || len <= 0.0f) continue;
+            if (out.empty()) out.push_back(Vector3Lerp(line[k], line[k + 1], (s0 - a) / len));
+            if (b >= s1) {
+                out.push_back(Vector3Lerp(line[k], line[k + 1], (s1 - a) / len));
+                break;
+            }
+            out.push_back(line[k + 1]);
+        }
+        if (out.size() < 2) return out;
+
+        std::vector<Vector3> kept = { out[0] };
+        for (size_t k = 1; k + 1 < out.size(); k++) {
+            Vector3 d0 = Dir2(kept.back(), out[k]);
+            Vector3 d1 = Dir2(out[k], out[k + 1]);
+            if (Dot2(d0, d1) < 0.9994f) kept.push_back(out[k]); // ~2 degrees
+        }
+        kept.push_back(out.back());
+        return kept;
+    }
+
+    // Lanes of one carriageway: centreline trimmed back from the junctions, offset to the right
+    void BuildLanes(Carriageway& c, const Link& link, const std::vector<Vector3>& positions, float junctionRadius) {
+        std::vector<Vector3> centre;
+        centre.reserve(link.nodes.size());
+        for (int n : link.nodes) centre.push_back(positions[n]);
+        if (c.reverse) std::reverse(centre.begin(), centre.end());
+
+        float length = 0.0f;
+        for (size_t k = 0; k + 1 < centre.size(); k++) length += Vector3Distance(centre[k], centre[k + 1]);
+        float trim = std::min(junctionRadius, 0.4f * length);
+        float s0 = c.fromBoundary ? 0.0f : trim;
+        float s1 = length - (c.toBoundary ? 0.0f : trim);
+        std::vector<Vector3> line = Cut(centre, s0, s1);
+        if (line.size() < 2) line = { centre.front(), centre.back() };
+
+        c.startDir = Dir2(line[0], line[1]);
+        c.endDir = Dir2(line[line.size() - 2], line.back());
+
+        bool oneway = link.oneway != 0;
+        c.lanes.assign(c.laneCount, std::vector<Vector3>(line.size()));
+        for (size_t k = 0; k < line.size(); k++) {
+            // Miter at the bends so the lanes stay parallel to the centreline
+            Vector3 in = k > 0 ? Dir2(line[k - 1], line[k]) : c.startDir;
+            Vector3 out = k + 1 < line.size() ? Dir2(line[k], line[k + 1]) : c.endDir;
+            Vector3 tangent = Dir2({ 0, 0, 0 }, { in.x + out.x, 0.0f, in.z + out.z });
+            float miter = 1.0f / std::max(Dot2(tangent, out), 0.5f);
+            Vector3 right = RightOf(tangent);
+            for (int lane = 0; lane < c.laneCount; lane++) {
+                float offset = oneway ? (lane - (c.laneCount - 1) * 0.5f) * LANE_SPACING
+                                      : LANE_FIRST_OFFSET + lane * LANE_SPACING;
+                c.lanes[lane][k] = Vector3Add(line[k], Vector3Scale(right, offset * miter));
+            }
+        }
+    }
+
+    // Interior points of a turn from p0 (heading d0) to p1 (heading d1): quadratic
+    // Bezier on the corner of the two headings, close to the addArcPath circles
+    std::vector<Vector3> TurnCurve(Vector3 p0, Vector3 d0, Vector3 p1, Vector3 d1, int segments) {
+        std::vector<Vector3> points;
+        float dist = Vector3Distance(p0, p1);
+        float denom = Cross2(d0, d1);
+        Vector3 control;
+        if (fabsf(denom) < 0.05f) {
+            if (Dot2(d0, d1) > 0.0f) return points;                 // Straight on
+            control = Vector3Add(Vector3Lerp(p0, p1, 0.5f), Vector3Scale(d0, dist * 0.75f)); // U-turn
+        } else {
+            float t = Cross2(Vector3Subtract(p1, p0), d1) / denom;
+            if (t <= 0.0f || t > 4.0f * dist) return points;        // Odd geometry: straight line
+            control = Vector3Add(p0, Vector3Scale(d0, t));
+        }
+        for (int k = 1; k < segments; k++) {
+            float u = (float)k / segments;
+            Vector3 a = Vector3Lerp(p0, control, u);
+            Vector3 b = Vector3Lerp(control, p1, u);
+            points.push_back(Vector3Lerp(a, b, u));
+        }
+        return points;
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// =============================================================================
+//  IMPORT
+// =============================================================================
+
+bool ImportOsm(const char* path, const OsmImportOptions& options, OsmNetwork& out,
+               std::string& error, OsmImportStats* stats) {
+    OsmImportStats local;
+    OsmImportStats& st = stats ? *stats : local;
+    st = OsmImportStats();
+    error.clear();
+
+    if (EndsWith(path, ".pbf")) {
+        error = std::string(path) + ": PBF is not supported, convert it to XML first (osmium cat in.osm.pbf -o out.osm)";
+        return false;
+    }
+
+    auto readStart = std::chrono::steady_clock::now();
+
+    // --- Pass 1: highway ways ---
+    std::unordered_map<long long, int> nodeIndex;   // OSM id -> compact index
+    std::vector<Way> ways;
+    {
+        XmlStream xml;
+        if (!xml.Open(path)) {
+            error = std::string(path) + ": cannot open";
+            return false;
+        }
+        bool inWay = false;
+        std::vector<long long> refs;
+        std::string highway, oneway, junction;
+        int lanes = 0;
+        while (xml.Next()) {
+            if (!inWay) {
+                if (!xml.closing && xml.Is("way")) {
+                    inWay = !xml.selfClosing;
+                    refs.clear();
+                    highway.clear();
+                    oneway.clear();
+                    junction.clear();
+                    lanes = 0;
+                    if (xml.selfClosing) st.skippedWays++;
+                }
+                continue;
+            }
+            if (xml.Is("nd")) {
+                refs.push_back(xml.Int("ref"));
+            } else if (xml.Is("tag")) {
+                if (xml.Equals("k", "highway")) highway = xml.String("v");
+                else if (xml.Equals("k", "oneway")) oneway = xml.String("v");
+                else if (xml.Equals("k", "junction")) junction = xml.String("v");
+                else if (xml.Equals("k", "lanes")) lanes = (int)xml.Int("v");
+            } else if (xml.closing && xml.Is("way")) {
+                inWay = false;
+                if (!IsDrivable(highway) || refs.size() < 2) {
+                    st.skippedWays++;
+                    continue;
+                }
+                Way w;
+                w.oneway = (oneway == "yes" || oneway == "1" || oneway == "true") ? 1 : (oneway == "-1" ? -1 : 0);
+                if (oneway.empty() && (highway == "motorway" || junction == "roundabout")) w.oneway = 1;
+                int perDirection = w.oneway ? lanes : lanes / 2;
+                if (perDirection <= 0) perDirection = (highway == "motorway" || highway == "trunk") ? 2 : 1;
+                w.lanes = std::min(perDirection, MAX_LANES);
+                w.nodes.reserve(refs.size());
+                for (long long ref : refs) {
+                    auto it = nodeIndex.emplace(ref, (int)nodeIndex.size()).first;
+                    w.nodes.push_back(it->second);
+                }
+                ways.push_back(std::move(w));
+                st.roadWays++;
+            }
+        }
+        if (!xml.error.empty()) {
+            error = std::string(path) + ": " + xml.error;
+            return false;
+        }
+        st.bytesRead += xml.bytesRead;
+    }
+
+    // --- Pass 2: coordinates and signals of the nodes those ways use ---
+    int nodeCount = (int)nodeIndex.size();
+    std::vector<double> lat(nodeCount, 0.0), lon(nodeCount, 0.0);
+    std::vector<char> present(nodeCount, 0), signal(nodeCount, 0);
+    {
+        XmlStream xml;
+        if (!xml.Open(path)) {
+            error = std::string(path) + ": cannot open";
+            return false;
+        }
+        int current = -1;   // Compact index of the open <node>, -1 if not wanted
+        while (xml.Next()) {
+            if (xml.closing) {
+                if (xml.Is("node")) current = -1;
+                continue;
+            }
+            if (xml.Is("node")) {
+                auto it = nodeIndex.find(xml.Int("id"));
+                current = -1;
+                if (it == nodeIndex.end()) continue;
+                lat[it->second] = xml.Double("lat");
+                lon[it->second] = xml.Double("lon");
+                present[it->second] = 1;
+                if (!xml.selfClosing) current = it->second;
+            } else if (xml.Is("tag")) {
+                if (current >= 0 && xml.Equals("k", "highway") && xml.Equals("v", "traffic_signals")) signal[current] = 1;
+            } else if (xml.Is("way") || xml.Is("relation")) {
+                break; // Nodes come first in OSM files
+            }
+        }
+        if (!xml.error.empty()) {
+            error = std::string(path) + ": " + xml.error;
+            return false;
+        }
+        st.bytesRead += xml.bytesRead;
+    }
+    st.readMs = MsSince(readStart);
+
+    auto geometryStart = std::chrono::steady_clock::now();
+
+    // --- Projection: local metres around the centre of the extract ---
+    double minLat = 90.0, maxLat = -90.0, minLon = 180.0, maxLon = -180.0;
+    for (int n = 0; n < nodeCount; n++) {
+        if (!present[n]) continue;
+        st.osmNodes++;
+        minLat = std::min(minLat, lat[n]);
+        maxLat = std::max(maxLat, lat[n]);
+        minLon = std::min(minLon, lon[n]);
+        maxLon = std::max(maxLon, lon[n]);
+    }
+    if (st.osmNodes == 0) {
+        error = std::string(path) + ": no drivable road found";
+        return false;
+    }
+    double lat0 = (minLat + maxLat) * 0.5, lon0 = (minLon + maxLon) * 0.5;
+    double cosLat = cos(lat0 * DEG2RAD);
+    std::vector<Vector3> positions(nodeCount);
+    for (int n = 0; n < nodeCount; n++) {
+        positions[n] = { (float)((lon[n] - lon0) * METERS_PER_DEGREE * cosLat), 0.0f,
+                         (float)(-(lat[n] - lat0) * METERS_PER_DEGREE) };
+    }
+
+    // --- Pieces: runs of present nodes (ways leaving the extract are cut) ---
+    std::vector<Way> pieces;
+    for (const Way& w : ways) {
+        Way piece = { {}, w.oneway, w.lanes };
+        for (size_t k = 0; k <= w.nodes.size(); k++) {
+            bool usable = k < w.nodes.size() && present[w.nodes[k]];
+            if (usable && !piece.nodes.empty() && piece.nodes.back() == w.nodes[k]) continue; // Repeated ref
+            if (usable) {
+                piece.nodes.push_back(w.nodes[k]);
+                continue;
+            }
+            if (piece.nodes.size() >= 2) pieces.push_back(piece);
+            piece.nodes.clear();
+        }
+    }
+    ways.clear();
+    ways.shrink_to_fit();
+
+    // --- Junctions: nodes used twice or more, piece ends ---
+    std::vector<int> uses(nodeCount, 0);
+    for (const Way& p : pieces) {
+        for (int n : p.nodes) uses[n]++;
+        uses[p.nodes.front()]++;
+        uses[p.nodes.back()]++;
+    }
+    std::vector<int> junctionOf(nodeCount, -1);
+    std::vector<int> junctionNode;
+    for (const Way& p : pieces) {
+        for (int n : p.nodes) {
+            if (uses[n] >= 2 && junctionOf[n] < 0) {
+                junctionOf[n] = (int)junctionNode.size();
+                junctionNode.push_back(n);
+            }
+        }
+    }
+    int junctionCount = (int)junctionNode.size();
+
+    // --- Links between junctions ---
+    std::vector<Link> links;
+    for (const Way& p : pieces) {
+        size_t start = 0;
+        for (size_t k = 1; k < p.nodes.size(); k++) {
+            if (junctionOf[p.nodes[k]] < 0) continue;
+            Link link;
+            link.from = junctionOf[p.nodes[start]];
+            link.to = junctionOf[p.nodes[k]];
+            link.nodes.assign(p.nodes.begin() + start, p.nodes.begin() + k + 1);
+            link.oneway = p.oneway;
+            link.lanes = p.lanes;
+            start = k;
+
+            float length = 0.0f;
+            for (size_t j = 0; j + 1 < link.nodes.size(); j++) length += Vector3Distance(positions[link.nodes[j]], positions[link.nodes[j + 1]]);
+            if (length >= MIN_LINK_LENGTH) links.push_back(std::move(link));
+        }
+    }
+    pieces.clear();
+    pieces.shrink_to_fit();
+    st.links = (int)links.size();
+
+    std::vector<int> degree(junctionCount, 0);
+    for (const Link& l : links) {
+        degree[l.from]++;
+        degree[l.to]++;
+    }
+
+    // --- Carriageways, and which ones meet at each junction ---
+    std::vector<Carriageway> carriageways;
+    for (int l = 0; l < (int)links.size(); l++) {
+        const Link& link = links[l];
+        int first = (int)carriageways.size();
+        for (int dir = 0; dir < 2; dir++) {
+            bool reverse = dir == 1;
+            if ((reverse && link.oneway == 1) || (!reverse && link.oneway == -1)) continue;
+            Carriageway c;
+            c.link = l;
+            c.reverse = reverse;
+            c.from = reverse ? link.to : link.from;
+            c.to = reverse ? link.from : link.to;
+            c.fromBoundary = degree[c.from] == 1;
+            c.toBoundary = degree[c.to] == 1;
+            c.laneCount = link.lanes;
+            carriageways.push_back(c);
+        }
+        if ((int)carriageways.size() - first == 2) {
+            carriageways[first].twin = first + 1;
+            carriageways[first + 1].twin = first;
+        }
+    }
+    int wayCount = (int)carriageways.size();
+
+    std::vector<std::vector<int>> incoming(junctionCount), outgoing(junctionCount);
+    for (int c = 0; c < wayCount; c++) {
+        outgoing[carriageways[c].from].push_back(c);
+        incoming[carriageways[c].to].push_back(c);
+    }
+
+    WorkerPool pool(options.threads);
+
+    // --- Lanes (parallel, one carriageway per index) ---
+    pool.ParallelFor(wayCount, [&](int begin, int end, int) {
+        for (int c = begin; c < end; c++) BuildLanes(carriageways[c], links[carriageways[c].link], positions, options.junctionRadius);
+    }, 16);
+
+    // --- Turns (parallel, one junction per index) ---
+    std::vector<std::vector<Turn>> turns(junctionCount);
+    int segments = std::max(options.turnSegments, 1);
+    pool.ParallelFor(junctionCount, [&](int begin, int end, int) {
+        for (int j = begin; j < end; j++) {
+            if (degree[j] <= 1) continue; // Boundary: teleports, no turns
+            std::vector<Turn>& out = turns[j];
+            for (int in : incoming[j]) {
+                const Carriageway& a = carriageways[in];
+                std::vector<Turn> movements;
+                std::vector<char> laneServed(a.laneCount, 0);
+                auto add = [&](int fromLane, int to, int toLane, float angle) {
+                    Turn t;
+                    t.fromWay = in;
+                    t.fromLane = fromLane;
+                    t.toWay = to;
+                    t.toLane = toLane;
+                    t.angle = angle;
+                    movements.push_back(t);
+                    laneServed[fromLane] = 1;
+                };
+
+                // Lane use: right turns from the rightmost lane, left turns from lane 0, straight from all
+                std::vector<std::pair<int, float>> exits;
+                for (int o : outgoing[j]) {
+                    if (o == a.twin) continue;
+                    float angle = atan2f(Cross2(a.endDir, carriageways[o].startDir), Dot2(a.endDir, carriageways[o].startDir));
+                    exits.push_back({ o, angle });
+                }
+                if (exits.empty() && a.twin >= 0) exits.push_back({ a.twin, PI }); // Only way out: U-turn
+                for (const auto& e : exits) {
+                    const Carriageway& b = carriageways[e.first];
+                    if (fabsf(e.second) < STRAIGHT_ANGLE) {
+                        for (int k = 0; k < a.laneCount; k++) add(k, e.first, std::min(k, b.laneCount - 1), e.second);
+                    } else if (e.second > 0.0f) {
+                        add(a.laneCount - 1, e.first, b.laneCount - 1, e.second);
+                    } else {
+                        add(0, e.first, 0, e.second);
+                    }
+                }
+                // A lane left without a movement takes the straightest exit
+                if (!exits.empty()) {
+                    auto straightest = std::min_element(exits.begin(), exits.end(),
+                        [](const std::pair<int, float>& x, const std::pair<int, float>& y) { return fabsf(x.second) < fabsf(y.second); });
+                    for (int k = 0; k < a.laneCount; k++) {
+                        if (!laneServed[k]) add(k, straightest->first, std::min(k, carriageways[straightest->first].laneCount - 1), straightest->second);
+                    }
+                }
+
+                // Branch order: per lane, straightest first
+                std::stable_sort(movements.begin(), movements.end(), [](const Turn& x, const Turn& y) {
+                    if (x.fromLane != y.fromLane) return x.fromLane < y.fromLane;
+                    return fabsf(x.angle) < fabsf(y.angle);
+                });
+                for (Turn& t : movements) {
+                    const Carriageway& b = carriageways[t.toWay];
+                    t.points = TurnCurve(a.lanes[t.fromLane].back(), a.endDir, b.lanes[t.toLane].front(), b.startDir, segments);
+                    out.push_back(std::move(t));
+                }
+            }
+        }
+    }, 16);
+
+    // --- Ids (serial): lanes, then turn interiors, in a fixed order ---
+    int nextId = 0;
+    for (Carriageway& c : carriageways) {
+        c.laneFirst.resize(c.laneCount);
+        for (int k = 0; k < c.laneCount; k++) {
+            c.laneFirst[k] = nextId;
+            nextId += (int)c.lanes[k].size();
+        }
+        st.lanes += c.laneCount;
+    }
+    for (std::vector<Turn>& list : turns) {
+        for (Turn& t : list) {
+            t.firstId = nextId;
+            nextId += (int)t.points.size();
+        }
+        st.turns += (int)list.size();
+    }
+
+    // --- Graph ---
+    RoadGraph& graph = out.graph;
+    graph.Clear();
+    graph.Reserve(nextId);
+    std::vector<int> starts, teleports;
+    for (const Carriageway& c : carriageways) {
+        for (int k = 0; k < c.laneCount; k++) {
+            const std::vector<Vector3>& lane = c.lanes[k];
+            int last = (int)lane.size() - 1;
+            for (int p = 0; p <= last; p++) {
+                NodeType type = ARC;
+                if (p == 0) type = c.fromBoundary ? START : DECISION;
+                else if (p == last) type = c.toBoundary ? TELEPORT : DECISION;
+                graph.AddNode(c.laneFirst[k] + p, lane[p], type);
+                if (p > 0) graph.ConnectNodes(c.laneFirst[k] + p - 1, c.laneFirst[k] + p);
+            }
+            if (c.fromBoundary) starts.push_back(c.StartId(k));
+            if (c.toBoundary) teleports.push_back(c.StopId(k));
+        }
+    }
+    for (const std::vector<Turn>& list : turns) {
+        for (const Turn& t : list) {
+            int prev = carriageways[t.fromWay].StopId(t.fromLane);
+            for (int p = 0; p < (int)t.points.size(); p++) {
+                graph.AddNode(t.firstId + p, t.points[p], ARC);
+                graph.ConnectNodes(prev, t.firstId + p);
+                prev = t.firstId + p;
+            }
+            graph.ConnectNodes(prev, carriageways[t.toWay].StartId(t.toLane));
+        }
+    }
+
+    // Boundary: a vehicle leaving the map comes back at a START on the other side of the list
+    for (size_t k = 0; k < teleports.size() && !starts.empty(); k++) {
+        graph.SetTeleportTarget(teleports[k], starts[(k + starts.size() / 2) % starts.size()]);
+    }
+    for (int j = 0; j < junctionCount; j++) {
+        if (degree[j] == 1) st.boundaries++;
+    }
+    st.junctions = junctionCount - st.boundaries;
+
+    // --- Signals: one controller per approach, approaches grouped by axis into two stages ---
+    out.lights.clear();
+    out.plans.clear();
+    for (int j = 0; j < junctionCount; j++) {
+        if (!signal[junctionNode[j]] || degree[j] <= 1 || incoming[j].size() < 2) continue;
+        NetworkPlan plan;
+        plan.yellow = options.signalYellow;
+        plan.allRed = options.signalAllRed;
+        plan.offset = 0.0f;
+        NetworkStage major = { options.signalGreen, {} }, minor = { options.signalGreen, {} };
+        Vector3 axis = carriageways[incoming[j][0]].endDir;
+        for (int in : incoming[j]) {
+            const Carriageway& c = carriageways[in];
+            NetworkLight light;
+            light.id = c.StopId(0);
+            Vector3 edge = c.lanes[c.laneCount - 1].back();
+            light.position = Vector3Add(edge, Vector3Scale(RightOf(c.endDir), 2.5f));
+            float rotation = atan2f(-c.endDir.x, -c.endDir.z) * RAD2DEG; // Faces the oncoming traffic
+            light.rotation = rotation < 0.0f ? rotation + 360.0f : rotation;
+            light.startRed = 0.0f;
+            light.green = options.signalGreen;
+            light.yellow = options.signalYellow;
+            light.red = options.signalGreen;
+            for (int k = 0; k < c.laneCount; k++) light.nodeIds.push_back(c.StopId(k));
+            out.lights.push_back(light);
+
+            plan.controllerIds.push_back(light.id);
+            (fabsf(Dot2(c.endDir, axis)) >= 0.7071f ? major : minor).controllerIds.push_back(light.id);
+        }
+        plan.id = plan.controllerIds[0];
+        plan.stages.push_back(major);
+        if (!minor.controllerIds.empty()) plan.stages.push_back(minor);
+        out.plans.push_back(plan);
+        st.signals++;
+    }
+    st.geometryMs = MsSince(geometryStart);
+    return true;
+}
@@ -0,0 +1,139 @@
+#include "profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace Profiler {
+
+    bool enabled = false;
+
+    struct Section {
+        const char* name;
+        long long frameNs = 0;      // Accumulated in the current frame
+        int frameCalls = 0;
+        float history[HISTORY_FRAMES] = {};
+        int historyCount = 0;
+        int historyHead = 0;
+        SectionStats stats = { nullptr, 0.0f, 0.0f, 0 };
+    };
+
+    struct TraceEvent {
+        const char* name;
+        long long startNs;
+        long long durNs;
+    };
+
+    // Beyond this the capture stops growing (about 12 MB of events)
+    static const size_t MAX_TRACE_EVENTS = 500000;
+
+    static std::vector<Section> sections;
+    static std::vector<TraceEvent> traceEvents;
+    static bool tracing = false;
+    static long long traceStartNs = 0;
+
+    long long NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count() + 1; // Never 0 (0 = "not started")
+    }
+
+    static Section& FindSection(const char* name) {
+        // Few sections: a linear scan on the literal's address beats a map
+        for (auto& s : sections) {
+            if (s.name == name) return s;
+        }
+        // Same text from another translation unit
+        for (auto& s : sections) {
+            if (strcmp(s.name, name) == 0) return s;
+        }
+        sections.emplace_back();
+        sections.back().name = name;
+        sections.back().stats.name = name;
+        return sections.back();
+    }
+
+    void Record(const char* name, long long startNs, long long endNs) {
+        Section& s = FindSection(name);
+        s.frameNs += endNs - startNs;
+        s.frameCalls++;
+
+        if (tracing && traceEvents.size() < MAX_TRACE_EVENTS) {
+            traceEvents.push_back({ name, startNs, endNs - startNs });
+        }
+    }
+
+    void SetEnabled(bool on) {
+        enabled = on;
+        if (!on) {
+            sections.clear();
+            tracing = false;
+        }
+    }
+
+    void EndFrame() {
+        if (!enabled) return;
+
+        for (auto& s : sections) {
+            s.history[s.historyHead] = (float)(s.frameNs / 1.0e6);
+            s.historyHead = (s.historyHead + 1) % HISTORY_FRAMES;
+            if (s.historyCount < HISTORY_FRAMES) s.historyCount++;
+
+            float sum = 0.0f, worst = 0.0f;
+            for (int i = 0; i < s.historyCount; i++) {
+                sum += s.history[i];
+                if (s.history[i] > worst) worst = s.history[i];
+            }
+            s.stats.avgMs = sum / s.historyCount;
+            s.stats.maxMs = worst;
+            s.stats.calls = s.frameCalls;
+
+            s.frameNs = 0;
+            s.frameCalls = 0;
+        }
+    }
+
+    int GetSectionCount() {
+        return (int)sections.size();
+    }
+
+    SectionStats GetSection(int index) {
+        return sections[index].stats;
+    }
+
+    void BeginTrace() {
+        enabled = true;
+        tracing = true;
+        traceEvents.clear();
+        traceStartNs = NowNs();
+    }
+
+    bool IsTracing() {
+        return tracing;
+    }
+
+    bool EndTrace(const char* path) {
+        tracing = false;
+
+        FILE* f = fopen(path, "w");
+        if (!f) {
+            traceEvents.clear();
+            return false;
+        }
+
+        // Trace Event Format: complete events ("X"), timestamps in microseconds
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (size_t i = 0; i < traceEvents.size(); i++) {
+            const TraceEvent& e = traceEvents[i];
+            fprintf(f, "{\"name\":\"%s\",\"cat\":\"sim\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    e.name, (e.startNs - traceStartNs) / 1000.0, e.durNs / 1000.0,
+                    (i + 1 < traceEvents.size()) ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        bool ok = !ferror(f);
+        fclose(f);
+
+        traceEvents.clear();
+        traceEvents.shrink_to_fit();
+        return ok;
+    }
+}
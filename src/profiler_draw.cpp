@@ -0,0 +1,19 @@
+#include "profiler.h"
+#include "raylib.h"
+
+namespace Profiler {
+
+    void DrawHud(int x, int y, int fontSize) {
+        if (!enabled) return;
+
+        int lineHeight = fontSize + 4;
+        DrawText(IsTracing() ? "Profiler (ms/frame, avg | max)  [REC]" : "Profiler (ms/frame, avg | max)",
+                 x, y, fontSize, IsTracing() ? RED : DARKGRAY);
+
+        for (int i = 0; i < GetSectionCount(); i++) {
+            SectionStats s = GetSection(i);
+            DrawText(TextFormat("%-16s %6.2f | %6.2f  x%d", s.name, s.avgMs, s.maxMs, s.calls),
+                     x, y + lineHeight * (i + 1), fontSize, DARKGRAY);
+        }
+    }
+}
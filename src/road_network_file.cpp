@@ -0,0 +1,527 @@
+#include "road_network_file.h"
+#include "traffic_manager.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace RoadNetBlob;
+
+// =============================================================================
+//  TEXT -> BLOB
+// =============================================================================
+
+static const char* NODE_TYPE_NAMES[4] = { "start", "teleport", "decision", "arc" }; // NodeType order
+
+namespace {
+    struct TextStage {
+        float green;
+        std::vector<int> controllerIds;
+    };
+    struct TextPlan {
+        PlanRecord record;
+        std::vector<int> controllerIds;
+        std::vector<TextStage> stages;
+    };
+
+    struct TextTeleport {
+        int id, target, line;
+    };
+
+    // Everything read from a .roadnet, in file order. Node ids are only resolved once the
+    // whole file is read (Resolve): the id bound depends on the final node count.
+    struct TextNetwork {
+        std::vector<NodeRecord> nodes;
+        std::vector<int> nodeLines;
+        std::vector<int> indexById;                 // Node id -> index in nodes, -1 if unknown (after Resolve)
+        std::vector<std::pair<int, int>> edges;     // (from id, to id), (from index, to id) after Resolve
+        std::vector<int> edgeLines;
+        std::vector<TextTeleport> teleports;
+        std::vector<ControllerRecord> controllers;
+        std::vector<std::vector<int>> controllerNodes;
+        std::vector<TextPlan> plans;
+
+        int FindNode(int id) const {
+            return (id >= 0 && id < (int)indexById.size()) ? indexById[id] : -1;
+        }
+        bool AddNode(int id, float x, float y, float z, int type, int line) {
+            if (id < 0) return false;
+            NodeRecord n = { id, x, y, z, type, -1, 0, 0 };
+            nodes.push_back(n);
+            nodeLines.push_back(line);
+            return true;
+        }
+        void AddEdge(int fromId, int toId, int line) {
+            edges.push_back({ fromId, toId });
+            edgeLines.push_back(line);
+        }
+
+        // Error message (its line in 'line'), nullptr if every id is fine
+        const char* Resolve(int& line) {
+            int maxId = -1;
+            for (size_t k = 0; k < nodes.size(); k++) {
+                line = nodeLines[k];
+                if (!IsNodeIdInRange(nodes[k].id, nodes.size())) return "node id too large (ids must stay close to the node count)";
+                if (nodes[k].id > maxId) maxId = nodes[k].id;
+            }
+            indexById.assign(maxId + 1, -1);
+            for (size_t k = 0; k < nodes.size(); k++) {
+                line = nodeLines[k];
+                if (indexById[nodes[k].id] != -1) return "duplicate node id";
+                indexById[nodes[k].id] = (int)k;
+            }
+            for (size_t k = 0; k < edges.size(); k++) {
+                line = edgeLines[k];
+                int from = FindNode(edges[k].first);
+                if (from == -1) return "connect from an unknown node";
+                if (FindNode(edges[k].second) == -1) return "connection to an unknown node";
+                edges[k].first = from;
+            }
+            for (const TextTeleport& t : teleports) {
+                line = t.line;
+                int index = FindNode(t.id);
+                if (index == -1) return "teleport on an unknown node";
+                if (t.target != -1 && FindNode(t.target) == -1) return "teleport to an unknown node";
+                nodes[index].teleportTarget = t.target;
+            }
+            return nullptr;
+        }
+    };
+
+    // Whitespace-separated fields of one line (modified in place)
+    struct Fields {
+        std::vector<char*> items;
+        void Split(char* line) {
+            items.clear();
+            for (char* tok = strtok(line, " \t\r\n"); tok; tok = strtok(nullptr, " \t\r\n")) {
+                if (tok[0] == '#') break;
+                items.push_back(tok);
+            }
+        }
+        int Count() const { return (int)items.size(); }
+        bool Int(int k, int& out) const {
+            char* end;
+            long v = strtol(items[k], &end, 10);
+            out = (int)v;
+            return *end == '\0';
+        }
+        bool Float(int k, float& out) const {
+            char* end;
+            out = strtof(items[k], &end);
+            return *end == '\0';
+        }
+    };
+}
+
+static bool ParseIdList(const Fields& f, int first, std::vector<int>& out) {
+    out.clear();
+    for (int k = first; k < f.Count(); k++) {
+        int id;
+        if (!f.Int(k, id)) return false;
+        out.push_back(id);
+    }
+    return !out.empty();
+}
+
+// One line into 'net'. Returns an error message, nullptr if fine
+static const char* ParseLine(Fields& f, TextNetwork& net, int line) {
+    const char* kind = f.items[0];
+    float v[8];
+
+    if (strcmp(kind, "node") == 0) {
+        int id, type = -1;
+        if (f.Count() != 6 || !f.Int(1, id) || !f.Float(2, v[0]) || !f.Float(3, v[1]) || !f.Float(4, v[2])) return "expected: node <id> <x> <y> <z> <type>";
+        for (int t = 0; t < 4; t++) if (strcmp(f.items[5], NODE_TYPE_NAMES[t]) == 0) type = t;
+        if (type == -1) return "unknown node type";
+        if (!net.AddNode(id, v[0], v[1], v[2], type, line)) return "negative node id";
+        return nullptr;
+    }
+    if (strcmp(kind, "arc") == 0) {
+        int first, segments;
+        if (f.Count() != 9 || !f.Int(1, first) || !f.Int(8, segments)) return "expected: arc <firstId> <cx> <cy> <cz> <radius> <startAngle> <endAngle> <segments>";
+        for (int k = 0; k < 6; k++) if (!f.Float(2 + k, v[k])) return "bad number";
+        if (segments < 1) return "an arc needs at least one segment";
+
+        // Same nodes as addArcPath: ARC chain, DECISION at both ends
+        float step = (v[5] - v[4]) / segments;
+        for (int i = 0; i <= segments; i++) {
+            float angle = (v[4] + i * step) * DEG2RAD;
+            int type = (i == 0 || i == segments) ? DECISION : ARC;
+            if (!net.AddNode(first + i, v[0] + cosf(angle) * v[3], v[1], v[2] + sinf(angle) * v[3], type, line)) return "negative node id";
+            if (i > 0) net.AddEdge(first + i - 1, first + i, line);
+        }
+        return nullptr;
+    }
+    if (strcmp(kind, "connect") == 0) {
+        int from, to;
+        if (f.Count() < 3 || !f.Int(1, from)) return "expected: connect <from> <to> [<to> ...]";
+        for (int k = 2; k < f.Count(); k++) {
+            if (!f.Int(k, to)) return "bad node id";
+            net.AddEdge(from, to, line);
+        }
+        return nullptr;
+    }
+    if (strcmp(kind, "teleport") == 0) {
+        int id, target;
+        if (f.Count() != 3 || !f.Int(1, id) || !f.Int(2, target)) return "expected: teleport <node> <target>";
+        net.teleports.push_back({ id, target, line });
+        return nullptr;
+    }
+    if (strcmp(kind, "light") == 0) {
+        ControllerRecord c = {};
+        std::vector<int> nodeIds;
+        if (f.Count() < 11 || !f.Int(1, c.id)) return "expected: light <id> <x> <y> <z> <rotation> <startRed> <green> <yellow> <red> <nodeId> [...]";
+        for (int k = 0; k < 8; k++) if (!f.Float(2 + k, v[k])) return "bad number";
+        if (!ParseIdList(f, 10, nodeIds)) return "bad node id";
+        c.x = v[0]; c.y = v[1]; c.z = v[2];
+        c.rotation = v[3];
+        c.startRed = v[4]; c.green = v[5]; c.yellow = v[6]; c.red = v[7];
+        net.controllers.push_back(c);
+        net.controllerNodes.push_back(nodeIds);
+        return nullptr;
+    }
+    if (strcmp(kind, "plan") == 0) {
+        TextPlan p;
+        p.record = PlanRecord();
+        if (f.Count() < 6 || !f.Int(1, p.record.id) || !f.Float(2, p.record.yellow) || !f.Float(3, p.record.allRed) || !f.Float(4, p.record.offset)) return "expected: plan <id> <yellow> <allRed> <offset> <controllerId> [...]";
+        if (!ParseIdList(f, 5, p.controllerIds)) return "bad controller id";
+        net.plans.push_back(p);
+        return nullptr;
+    }
+    if (strcmp(kind, "stage") == 0) {
+        int planId;
+        TextStage s;
+        if (f.Count() < 4 || !f.Int(1, planId) || !f.Float(2, s.green)) return "expected: stage <planId> <green> <controllerId> [...]";
+        if (!ParseIdList(f, 3, s.controllerIds)) return "bad controller id";
+        for (TextPlan& p : net.plans) {
+            if (p.record.id != planId) continue;
+            p.stages.push_back(s);
+            return nullptr;
+        }
+        return "stage of an unknown plan (declare the plan first)";
+    }
+    return "unknown keyword";
+}
+
+template <typename T>
+static unsigned char* PutArray(unsigned char* out, const T* items, size_t count) {
+    if (count) memcpy(out, items, count * sizeof(T));
+    return out + count * sizeof(T);
+}
+
+// Lays 'net' out as a blob (see road_network_file.h)
+static void CompileNetwork(const TextNetwork& net, std::vector<uint32_t>& blob) {
+    // CSR: edges grouped by source node, in file order within a node
+    std::vector<NodeRecord> nodes = net.nodes;
+    for (const auto& e : net.edges) nodes[e.first].edgeCount++;
+    uint32_t offset = 0;
+    for (NodeRecord& n : nodes) {
+        n.firstEdge = offset;
+        offset += n.edgeCount;
+    }
+    std::vector<int32_t> edges(net.edges.size());
+    std::vector<uint32_t> cursor(nodes.size(), 0);
+    for (const auto& e : net.edges) edges[nodes[e.first].firstEdge + cursor[e.first]++] = e.second;
+
+    // Id lists: controller nodes, then per plan its groups and its stages' groups
+    std::vector<int32_t> ids;
+    std::vector<ControllerRecord> controllers = net.controllers;
+    for (size_t c = 0; c < controllers.size(); c++) {
+        controllers[c].firstId = (uint32_t)ids.size();
+        controllers[c].idCount = (uint32_t)net.controllerNodes[c].size();
+        ids.insert(ids.end(), net.controllerNodes[c].begin(), net.controllerNodes[c].end());
+    }
+    std::vector<PlanRecord> plans;
+    std::vector<StageRecord> stages;
+    for (const TextPlan& p : net.plans) {
+        PlanRecord r = p.record;
+        r.firstId = (uint32_t)ids.size();
+        r.idCount = (uint32_t)p.controllerIds.size();
+        ids.insert(ids.end(), p.controllerIds.begin(), p.controllerIds.end());
+        r.firstStage = (uint32_t)stages.size();
+        r.stageCount = (uint32_t)p.stages.size();
+        for (const TextStage& s : p.stages) {
+            StageRecord sr = { s.green, (uint32_t)ids.size(), (uint32_t)s.controllerIds.size() };
+            ids.insert(ids.end(), s.controllerIds.begin(), s.controllerIds.end());
+            stages.push_back(sr);
+        }
+        plans.push_back(r);
+    }
+
+    Header h;
+    memcpy(h.magic, MAGIC, sizeof(h.magic));
+    h.version = VERSION;
+    h.nodeCount = (uint32_t)nodes.size();
+    h.edgeCount = (uint32_t)edges.size();
+    h.controllerCount = (uint32_t)controllers.size();
+    h.planCount = (uint32_t)plans.size();
+    h.stageCount = (uint32_t)stages.size();
+    h.idCount = (uint32_t)ids.size();
+    h.fileSize = (uint32_t)(sizeof(Header) + nodes.size() * sizeof(NodeRecord) + edges.size() * sizeof(int32_t)
+                          + controllers.size() * sizeof(ControllerRecord) + plans.size() * sizeof(PlanRecord)
+                          + stages.size() * sizeof(StageRecord) + ids.size() * sizeof(int32_t));
+
+    blob.assign(h.fileSize / sizeof(uint32_t), 0);
+    unsigned char* out = (unsigned char*)blob.data();
+    out = PutArray(out, &h, 1);
+    out = PutArray(out, nodes.data(), nodes.size());
+    out = PutArray(out, edges.data(), edges.size());
+    out = PutArray(out, controllers.data(), controllers.size());
+    out = PutArray(out, plans.data(), plans.size());
+    out = PutArray(out, stages.data(), stages.size());
+    PutArray(out, ids.data(), ids.size());
+}
+
+// =============================================================================
+//  LOADING
+// =============================================================================
+
+bool RoadNetworkFile::Load(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        Unload();
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+    char magic[sizeof(MAGIC)] = {};
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+    if (got == sizeof(magic) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0) return LoadBinary(path);
+    return LoadText(path);
+}
+
+bool RoadNetworkFile::LoadText(const char* path) {
+    Unload();
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        error = std::string("cannot open ") + path;
+        return false;
+    }
+
+    // Streamed line by line: only the network itself is kept in memory
+    TextNetwork net;
+    Fields fields;
+    char line[4096];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineNumber++;
+        fields.Split(line);
+        if (fields.Count() == 0) continue;
+        const char* problem = ParseLine(fields, net, lineNumber);
+        if (problem) {
+            fclose(f);
+            error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+    }
+    fclose(f);
+
+    // Ids against the whole file: the order of the lines does not matter
+    const char* problem = net.Resolve(lineNumber);
+    if (problem) {
+        error = std::string(path) + ":" + std::to_string(lineNumber) + ": " + problem;
+        return false;
+    }
+
+    CompileNetwork(net, owned);
+    return Attach((const unsigned char*)owned.data(), owned.size() * sizeof(uint32_t));
+}
+
+bool RoadNetworkFile::LoadBinary(const char* path) {
+    Unload();
+    if (!mapped.Open(path)) {
+        error = std::string("cannot map ") + path;
+        return false;
+    }
+    if (!Attach(mapped.Data(), mapped.Size())) {
+        mapped.Close();
+        error = std::string(path) + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+void RoadNetworkFile::Unload() {
+    mapped.Close();
+    owned.clear();
+    owned.shrink_to_fit();
+    error.clear();
+    header = nullptr;
+    nodes = nullptr;
+    edges = nullptr;
+    controllers = nullptr;
+    plans = nullptr;
+    stages = nullptr;
+    ids = nullptr;
+}
+
+// Points the views at a blob after checking that every range stays inside it
+bool RoadNetworkFile::Attach(const unsigned char* data, size_t size) {
+    const Header* h = (const Header*)data;
+    if (size < sizeof(Header) || memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "not a road network blob";
+        return false;
+    }
+    if (h->version != VERSION) {
+        error = "unsupported blob version " + std::to_string(h->version);
+        return false;
+    }
+    uint64_t expected = sizeof(Header) + (uint64_t)h->nodeCount * sizeof(NodeRecord) + (uint64_t)h->edgeCount * sizeof(int32_t)
+                      + (uint64_t)h->controllerCount * sizeof(ControllerRecord) + (uint64_t)h->planCount * sizeof(PlanRecord)
+                      + (uint64_t)h->stageCount * sizeof(StageRecord) + (uint64_t)h->idCount * sizeof(int32_t);
+    if (h->fileSize != size || expected != size) {
+        error = "truncated or corrupt blob";
+        return false;
+    }
+
+    const unsigned char* p = data + sizeof(Header);
+    const NodeRecord* n = (const NodeRecord*)p;             p += h->nodeCount * sizeof(NodeRecord);
+    const int32_t* e = (const int32_t*)p;                   p += h->edgeCount * sizeof(int32_t);
+    const ControllerRecord* c = (const ControllerRecord*)p; p += h->controllerCount * sizeof(ControllerRecord);
+    const PlanRecord* pl = (const PlanRecord*)p;            p += h->planCount * sizeof(PlanRecord);
+    const StageRecord* s = (const StageRecord*)p;           p += h->stageCount * sizeof(StageRecord);
+    const int32_t* list = (const int32_t*)p;
+
+    // Ids bounded by the node count (the graph sizes its tables by them), each used once;
+    // edges and teleports must land on one of them
+    std::vector<unsigned char> known;
+    for (uint32_t k = 0; k < h->nodeCount; k++) {
+        if (!IsNodeIdInRange(n[k].id, h->nodeCount) || n[k].type < START || n[k].type > ARC
+            || (uint64_t)n[k].firstEdge + n[k].edgeCount > h->edgeCount) {
+            error = "bad node record " + std::to_string(k);
+            return false;
+        }
+        if (n[k].id >= (int)known.size()) known.resize(n[k].id + 1, 0);
+        if (known[n[k].id]) {
+            error = "duplicate node id " + std::to_string(n[k].id);
+            return false;
+        }
+        known[n[k].id] = 1;
+    }
+    auto isKnown = [&](int32_t id) { return id >= 0 && id < (int)known.size() && known[id]; };
+    for (uint32_t k = 0; k < h->edgeCount; k++) {
+        if (!isKnown(e[k])) {
+            error = "edge to unknown node " + std::to_string(e[k]);
+            return false;
+        }
+    }
+    for (uint32_t k = 0; k < h->nodeCount; k++) {
+        if (n[k].teleportTarget != -1 && !isKnown(n[k].teleportTarget)) {
+            error = "bad teleport target of node " + std::to_string(n[k].id);
+            return false;
+        }
+    }
+    for (uint32_t k = 0; k < h->controllerCount; k++) {
+        if ((uint64_t)c[k].firstId + c[k].idCount > h->idCount) { error = "bad controller record"; return false; }
+    }
+    for (uint32_t k = 0; k < h->planCount; k++) {
+        if ((uint64_t)pl[k].firstId + pl[k].idCount > h->idCount || (uint64_t)pl[k].firstStage + pl[k].stageCount > h->stageCount) {
+            error = "bad plan record";
+            return false;
+        }
+    }
+    for (uint32_t k = 0; k < h->stageCount; k++) {
+        if ((uint64_t)s[k].firstId + s[k].idCount > h->idCount) { error = "bad stage record"; return false; }
+    }
+
+    header = h;
+    nodes = n;
+    edges = e;
+    controllers = c;
+    plans = pl;
+    stages = s;
+    ids = list;
+    return true;
+}
+
+bool RoadNetworkFile::SaveBinary(const char* path) const {
+    if (!header) return false;
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(header, 1, header->fileSize, f) == header->fileSize;
+    return fclose(f) == 0 && ok;
+}
+
+// =============================================================================
+//  BLOB -> SIMULATION
+// =============================================================================
+
+void RoadNetworkFile::BuildGraph(RoadGraph& graph) const {
+    graph.Clear();
+    if (!header) return;
+    graph.Reserve(header->nodeCount);
+
+    for (uint32_t k = 0; k < header->nodeCount; k++) {
+        const NodeRecord& n = nodes[k];
+        graph.AddNode(n.id, { n.x, n.y, n.z }, (NodeType)n.type);
+    }
+    // Second pass: the branches, copied straight from the blob's CSR
+    for (uint32_t k = 0; k < header->nodeCount; k++) {
+        const NodeRecord& n = nodes[k];
+        Node* node = graph.FindNode(n.id);
+        node->teleportTargetId = n.teleportTarget;
+        node->nextNodes.assign(edges + n.firstEdge, edges + n.firstEdge + n.edgeCount);
+    }
+    graph.Freeze();
+}
+
+void RoadNetworkFile::ConfigureLights(TrafficManager& lights) const {
+    if (!header) return;
+    for (uint32_t k = 0; k < header->controllerCount; k++) {
+        const ControllerRecord& c = controllers[k];
+        lights.AddController(c.id, std::vector<int>(ids + c.firstId, ids + c.firstId + c.idCount));
+        lights.ConfigureTrafficLight(c.id, { c.x, c.y, c.z }, c.rotation, c.startRed, c.green, c.yellow, c.red);
+    }
+    for (uint32_t k = 0; k < header->planCount; k++) {
+        const PlanRecord& p = plans[k];
+        lights.AddSignalPlan(p.id, std::vector<int>(ids + p.firstId, ids + p.firstId + p.idCount), p.yellow, p.allRed);
+        for (uint32_t s = 0; s < p.stageCount; s++) {
+            const StageRecord& stage = stages[p.firstStage + s];
+            lights.AddStage(p.id, std::vector<int>(ids + stage.firstId, ids + stage.firstId + stage.idCount), stage.green);
+        }
+        lights.SetPlanOffset(p.id, p.offset);
+    }
+}
+
+// =============================================================================
+//  EXPORT
+// =============================================================================
+
+bool WriteRoadNetworkText(const RoadGraph& graph, const char* path,
+                          const std::vector<NetworkLight>& lights, const std::vector<NetworkPlan>& plans) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    const std::vector<Node>& all = graph.GetAllNodes();
+    fprintf(f, "# %d nodes\n", (int)all.size());
+    for (const Node& n : all) {
+        int type = (n.type >= START && n.type <= ARC) ? n.type : DECISION;
+        fprintf(f, "node %d %.9g %.9g %.9g %s\n", n.id, n.pos.x, n.pos.y, n.pos.z, NODE_TYPE_NAMES[type]);
+    }
+    for (const Node& n : all) {
+        if (n.nextNodes.empty()) continue;
+        fprintf(f, "connect %d", n.id);
+        for (int to : n.nextNodes) fprintf(f, " %d", to);
+        fprintf(f, "\n");
+    }
+    for (const Node& n : all) {
+        if (n.teleportTargetId >= 0) fprintf(f, "teleport %d %d\n", n.id, n.teleportTargetId);
+    }
+    for (const NetworkLight& l : lights) {
+        fprintf(f, "light %d %.9g %.9g %.9g %.9g %g %g %g %g", l.id, l.position.x, l.position.y, l.position.z,
+                l.rotation, l.startRed, l.green, l.yellow, l.red);
+        for (int id : l.nodeIds) fprintf(f, " %d", id);
+        fprintf(f, "\n");
+    }
+    for (const NetworkPlan& p : plans) {
+        fprintf(f, "plan %d %g %g %g", p.id, p.yellow, p.allRed, p.offset);
+        for (int id : p.controllerIds) fprintf(f, " %d", id);
+        fprintf(f, "\n");
+        for (const NetworkStage& s : p.stages) {
+            fprintf(f, "stage %d %g", p.id, s.green);
+            for (int id : s.controllerIds) fprintf(f, " %d", id);
+            fprintf(f, "\n");
+        }
+    }
+    return fclose(f) == 0;
+}
@@ -1,30 +1,110 @@
 #include "roadgraph.h"
-#include "config.h" // Pour utiliser les couleurs centralisées
+#include "raymath.h"
+#include <cmath>
 
-RoadGraph::RoadGraph() {}
+constexpr float RoadGraph::FREE_FLOW_SPEED;
+constexpr float RoadGraph::TRAVEL_TIME_MEMORY;
+constexpr float RoadGraph::MIN_SAMPLE_SPEED;
+
+RoadGraph::RoadGraph() : invalidNode(INVALID_NODE_ID) {}
 RoadGraph::~RoadGraph() {}
 
-void RoadGraph::AddNode(int id, Vector3 pos, NodeType type) {
-    Node newNode(id, pos, type);
-    nodes.push_back(newNode);
+bool RoadGraph::AddNode(int id, Vector3 pos, NodeType type) {
+    if (id < 0) return false; // Ids index the lookup table, they must be positive
+
+    // Ids are expected to be dense (0..N-1), so the table stays compact
+    if (id >= (int)indexById.size()) indexById.resize(id + 1, -1);
+    if (indexById[id] != -1) return false; // Duplicate: the first node keeps the id
+
+    nodes.push_back(Node(id, pos, type));
+    indexById[id] = (int)nodes.size() - 1;
+    frozen = false;
+    return true;
 }
 
 void RoadGraph::ConnectNodes(int fromId, int toId) {
     // On cherche le nœud source par son ID pour ajouter la connexion
-    for (auto& node : nodes) {
-        if (node.id == fromId) {
-            node.nextNodes.push_back(toId);
-            break;
+    Node* node = FindNode(fromId);
+    if (!node) return;
+    node->nextNodes.push_back(toId);
+    frozen = false;
+    sampledEdges.clear(); // Edge indices move on the next Freeze()
+}
+
+void RoadGraph::Freeze() const {
+    if (frozen) return;
+    int n = (int)nodes.size();
+
+    // 1. Offsets (prefix sum of the branch counts)
+    edgeBegin.resize(n + 1);
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        edgeBegin[i] = total;
+        total += (int)nodes[i].nextNodes.size();
+    }
+    edgeBegin[n] = total;
+
+    // 2. Per-edge attributes; the live times start at free flow
+    edgeTarget.resize(total);
+    edgeLength.resize(total);
+    edgeTraffic.assign(total, EdgeTraffic());
+    for (int i = 0; i < n; i++) {
+        const Node& node = nodes[i];
+        int e = edgeBegin[i];
+        for (int toId : node.nextNodes) {
+            int to = GetNodeIndex(toId);
+            float length = to != -1 ? Vector3Distance(node.pos, nodes[to].pos) : 0.0f;
+            edgeTarget[e] = to;
+            edgeLength[e] = length;
+            EdgeTraffic& traffic = edgeTraffic[e];
+            traffic.freeFlowTime = length / FREE_FLOW_SPEED;
+            traffic.travelTime = traffic.freeFlowTime;
+            traffic.lastUpdate = travelClock;
+            e++;
         }
     }
+    frozen = true;
+}
+
+int RoadGraph::GetNodeIndex(int id) const {
+    return (id >= 0 && id < (int)indexById.size()) ? indexById[id] : -1;
+}
+
+int RoadGraph::GetEdge(int fromId, int branch) const {
+    int index = GetNodeIndex(fromId);
+    if (index == -1 || branch < 0 || branch >= (int)nodes[index].nextNodes.size()) return -1;
+    Freeze();
+    return edgeBegin[index] + branch;
+}
+
+Node* RoadGraph::FindNode(int id) {
+    if (id < 0 || id >= (int)indexById.size()) return nullptr;
+    int index = indexById[id];
+    return (index >= 0) ? &nodes[index] : nullptr;
+}
+
+const Node* RoadGraph::FindNode(int id) const {
+    if (id < 0 || id >= (int)indexById.size()) return nullptr;
+    int index = indexById[id];
+    return (index >= 0) ? &nodes[index] : nullptr;
+}
+
+bool RoadGraph::HasNode(int id) const {
+    return FindNode(id) != nullptr;
 }
 
 Node& RoadGraph::GetNode(int id) {
-    // Recherche sécurisée de l'ID
-    for (auto& node : nodes) {
-        if (node.id == id) return node;
-    }
-    return nodes[0]; // Sécurité par défaut
+    Node* node = FindNode(id);
+    if (node) return *node;
+
+    // Explicit "not found" result (reset in case a caller modified it)
+    invalidNode = Node(INVALID_NODE_ID);
+    return invalidNode;
+}
+
+const Node& RoadGraph::GetNode(int id) const {
+    const Node* node = FindNode(id);
+    return node ? *node : invalidNode;
 }
 
 const std::vector<Node>& RoadGraph::GetAllNodes() const {
@@ -32,65 +112,77 @@ const std::vector<Node>& RoadGraph::GetAllNodes() const {
 }
 
 void RoadGraph::SetTeleportTarget(int nodeId, int targetId) {
-    for (auto& node : nodes) {
-        if (node.id == nodeId) {
-            node.teleportTargetId = targetId;
-            break;
-        }
-    }
+    Node* node = FindNode(nodeId);
+    if (node) node->teleportTargetId = targetId;
+}
+
+void RoadGraph::Reserve(int nodeCount) {
+    nodes.reserve(nodeCount);
+    indexById.reserve(nodeCount);
 }
 
 void RoadGraph::Clear() {
     nodes.clear();
+    indexById.clear();
+    edgeBegin.clear();
+    edgeTarget.clear();
+    edgeLength.clear();
+    edgeTraffic.clear();
+    frozen = false;
+    sampledEdges.clear();
+    travelClock = 0.0;
 }
 
-void RoadGraph::DrawNodes() {
-    
-    for (const auto& n : nodes) {
-        // --- DESSIN DES SPHÈRES ---
-        // ONLY draw the sphere if it is NOT an ARC node
-        if (n.type != ARC) {
-            Color nodeColor = (n.type == START) ? GREEN : (n.type == TELEPORT ? RED : YELLOW);
-            DrawSphere({n.pos.x, n.pos.y + 0.5f, n.pos.z}, 0.4f, nodeColor);
-        }
+// =============================================================================
+//  LIVE TRAVEL TIMES
+// =============================================================================
 
-        // --- DESSIN DES LIGNES DE CONNEXION ---
-        for (int nextId : n.nextNodes) {
-            
-            Vector3 nextPos = GetNode(nextId).pos;
-
-            // Draw a line from the current node to its destination
-            DrawLine3D(
-                { n.pos.x, n.pos.y + 0.5f, n.pos.z }, 
-                { nextPos.x, nextPos.y + 0.5f, nextPos.z }, 
-                YELLOW
-            );
-        }
-    }
+float RoadGraph::GetEdgeTravelTime(int fromId, int branch) const {
+    int edge = GetEdge(fromId, branch);
+    return edge != -1 ? GetEdgeTravelTime(edge) : 0.0f;
 }
 
-void RoadGraph::DrawIdNodes(Camera3D camera) {
-     
-    // Cette partie doit techniquement être appelée quand on est en mode 2D, 
-    // mais Raylib permet GetWorldToScreen pour projeter les IDs.
-    
-    for (const auto& n : nodes) {
-        if (n.type != ARC) {
-
-            // Convert 3D position to 2D screen position
-            //.-.
-            Vector2 screenPos = GetWorldToScreen({n.pos.x, n.pos.y + 2.5f, n.pos.z}, camera);
-            float scaleX = (float)SimulationConfig::SCREEN_WIDTH / GetScreenWidth();
-            float scaleY = (float)SimulationConfig::SCREEN_HEIGHT / GetScreenHeight();
-            
-            screenPos.x *= scaleX;
-            screenPos.y *= scaleY;
-            //._. end
-
-            // Only draw if the node is actually in front of the camera
-            if (screenPos.x > 0 && screenPos.y > 0) {
-                DrawText(TextFormat("ID:%d", n.id), screenPos.x - 10, screenPos.y, 10, BLACK);
-            }
-        }
+float RoadGraph::GetEdgeTravelTime(int edge) const {
+    const EdgeTraffic& e = edgeTraffic[edge];
+    if (e.travelTime == e.freeFlowTime) return e.freeFlowTime; // Common case, no expf
+
+    // Nobody sampled it since lastUpdate: fade back toward free flow
+    float fade = expf(-(float)(travelClock - e.lastUpdate) / TRAVEL_TIME_MEMORY);
+    return e.freeFlowTime + (e.travelTime - e.freeFlowTime) * fade;
+}
+
+float RoadGraph::GetEdgeFreeFlowTime(int fromId, int branch) const {
+    int edge = GetEdge(fromId, branch);
+    return edge != -1 ? edgeTraffic[edge].freeFlowTime : 0.0f;
+}
+
+void RoadGraph::AddEdgeSpeedSample(int fromId, int branch, float speed) {
+    int edge = GetEdge(fromId, branch);
+    if (edge != -1) AddEdgeSpeedSample(edge, speed);
+}
+
+void RoadGraph::AddEdgeSpeedSample(int edge, float speed) {
+    EdgeTraffic& e = edgeTraffic[edge];
+    if (e.samples == 0) sampledEdges.push_back(edge);
+    e.speedSum += (speed > MIN_SAMPLE_SPEED) ? speed : MIN_SAMPLE_SPEED;
+    e.samples++;
+}
+
+void RoadGraph::UpdateTravelTimes(float dt) {
+    travelClock += dt;
+    float blend = 1.0f - expf(-dt / TRAVEL_TIME_MEMORY);
+
+    for (int edge : sampledEdges) {
+        EdgeTraffic& e = edgeTraffic[edge];
+        float current = GetEdgeTravelTime(edge); // Includes the fade since lastUpdate
+        float length = e.freeFlowTime * FREE_FLOW_SPEED;
+        float measured = length / (e.speedSum / e.samples);
+        if (measured < e.freeFlowTime) measured = e.freeFlowTime; // Faster than the reference: still free flow
+
+        e.travelTime = current + (measured - current) * blend;
+        e.lastUpdate = travelClock;
+        e.speedSum = 0.0f;
+        e.samples = 0;
     }
-}
\ No newline at end of file
+    sampledEdges.clear();
+}
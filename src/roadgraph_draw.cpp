@@ -0,0 +1,55 @@
+#include "roadgraph.h"
+#include "config.h" // Pour utiliser les couleurs centralisées
+
+void RoadGraph::DrawNodes() {
+    Freeze(); // Lines straight from the CSR: no id lookup per road
+
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        const Node& n = nodes[i];
+        // --- DESSIN DES SPHÈRES ---
+        // ONLY draw the sphere if it is NOT an ARC node
+        if (n.type != ARC) {
+            Color nodeColor = (n.type == START) ? GREEN : (n.type == TELEPORT ? RED : YELLOW);
+            DrawSphere({n.pos.x, n.pos.y + 0.5f, n.pos.z}, 0.4f, nodeColor);
+        }
+
+        // --- DESSIN DES LIGNES DE CONNEXION ---
+        for (int e = edgeBegin[i]; e < edgeBegin[i + 1]; e++) {
+            if (edgeTarget[e] == -1) continue;
+            Vector3 nextPos = nodes[edgeTarget[e]].pos;
+
+            // Draw a line from the current node to its destination
+            DrawLine3D(
+                { n.pos.x, n.pos.y + 0.5f, n.pos.z }, 
+                { nextPos.x, nextPos.y + 0.5f, nextPos.z }, 
+                YELLOW
+            );
+        }
+    }
+}
+
+void RoadGraph::DrawIdNodes(Camera3D camera) {
+     
+    // Cette partie doit techniquement être appelée quand on est en mode 2D, 
+    // mais Raylib permet GetWorldToScreen pour projeter les IDs.
+    
+    for (const auto& n : nodes) {
+        if (n.type != ARC) {
+
+            // Convert 3D position to 2D screen position
+            //.-.
+            Vector2 screenPos = GetWorldToScreen({n.pos.x, n.pos.y + 2.5f, n.pos.z}, camera);
+            float scaleX = (float)SimulationConfig::SCREEN_WIDTH / GetScreenWidth();
+            float scaleY = (float)SimulationConfig::SCREEN_HEIGHT / GetScreenHeight();
+            
+            screenPos.x *= scaleX;
+            screenPos.y *= scaleY;
+            //._. end
+
+            // Only draw if the node is actually in front of the camera
+            if (screenPos.x > 0 && screenPos.y > 0) {
+                DrawText(TextFormat("ID:%d", n.id), screenPos.x - 10, screenPos.y, 10, BLACK);
+            }
+        }
+    }
+}
\ No newline at end of file
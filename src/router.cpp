@@ -0,0 +1,514 @@
+#include "router.h"
+#include "vehicle.h"
+#include "sim_random.h"
+#include "raymath.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <cfloat>
+
+// =============================================================================
+//  GRAPH TABLES
+// =============================================================================
+
+void Router::Build(const RoadGraph& graph) {
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+    int n = (int)nodes.size();
+    graph.Freeze(); // Dense indices below are the graph's own, edges are read from its CSR
+
+    // 1. Dense indices
+    nodeIds.resize(n);
+    positions.resize(n);
+    indexById.clear();
+    for (int i = 0; i < n; i++) {
+        nodeIds[i] = nodes[i].id;
+        positions[i] = nodes[i].pos;
+        if (nodes[i].id >= (int)indexById.size()) indexById.resize(nodes[i].id + 1, -1);
+        indexById[nodes[i].id] = i;
+    }
+
+    // 2. Edges (CSR), teleports jump to the node after their landing point
+    firstEdge.assign(n + 1, 0);
+    edges.clear();
+    edgeRoad.clear();
+    edgeSource.clear();
+    exitNodes.clear();
+    exitIndexById.assign(indexById.size(), -1);
+    landingPoints.clear();
+    for (int i = 0; i < n; i++) {
+        firstEdge[i] = (int)edges.size();
+        const Node& node = nodes[i];
+
+        if (node.type == TELEPORT) {
+            exitIndexById[node.id] = (int)exitNodes.size();
+            exitNodes.push_back(node.id);
+            int landing = graph.GetNodeIndex(node.teleportTargetId);
+            if (landing == -1 || graph.GetEdgeBegin(landing) == graph.GetEdgeEnd(landing)) continue;
+            int road = graph.GetEdgeBegin(landing);
+            int next = graph.GetEdgeTarget(road);
+            if (next == -1) continue;
+            edges.push_back({ next, graph.GetEdgeLength(road), -1 });
+            edgeRoad.push_back(road);
+            edgeSource.push_back(i);
+            landingPoints.push_back(positions[landing]);
+            continue; // A vehicle never drives on from a teleport, it jumps
+        }
+
+        for (int road = graph.GetEdgeBegin(i); road < graph.GetEdgeEnd(i); road++) {
+            int next = graph.GetEdgeTarget(road);
+            if (next == -1) continue;
+            edges.push_back({ next, graph.GetEdgeLength(road), -1 });
+            edgeRoad.push_back(road);
+            edgeSource.push_back(i);
+        }
+    }
+    firstEdge[n] = (int)edges.size();
+
+    // Reversed graph (counting sort by destination)
+    reverseFirst.assign(n + 1, 0);
+    for (const Edge& e : edges) reverseFirst[e.to + 1]++;
+    for (int i = 0; i < n; i++) reverseFirst[i + 1] += reverseFirst[i];
+    reverseEdges.assign(edges.size(), 0);
+    std::vector<int> fill(reverseFirst.begin(), reverseFirst.end() - 1);
+    for (int e = 0; e < (int)edges.size(); e++) reverseEdges[fill[edges[e].to]++] = e;
+    exitTimes.assign(exitNodes.size(), std::vector<float>());
+    nextExitTable = 0;
+    pendingExit = -1;
+
+    // 3. Heuristic table: straight line to the nearest teleport
+    teleportDistance.assign(n, FLT_MAX);
+    for (int i = 0; i < n; i++) {
+        for (int exitId : exitNodes) {
+            float d = Vector3Distance(positions[i], positions[IndexOf(exitId)]);
+            if (d < teleportDistance[i]) teleportDistance[i] = d;
+        }
+    }
+
+    hasHierarchy = false;
+    shortcutCount = 0;
+    stamp = 0;
+    stampFwd.assign(n, 0);
+    stampBwd.assign(n, 0);
+    distFwd.assign(n, 0.0f);
+    distBwd.assign(n, 0.0f);
+    parentFwd.assign(n, -1);
+    parentBwd.assign(n, -1);
+    parentEdgeMiddleFwd.assign(n, -1);
+    parentEdgeMiddleBwd.assign(n, -1);
+}
+
+void Router::NextStamp() {
+    stamp++;
+    if (stamp == 0) { // Wrapped: clear once every 4 billion queries
+        std::fill(stampFwd.begin(), stampFwd.end(), 0u);
+        std::fill(stampBwd.begin(), stampBwd.end(), 0u);
+        stamp = 1;
+    }
+}
+
+bool Router::FindRoute(int fromId, int toId, std::vector<int>& path) {
+    return hasHierarchy ? FindRouteCH(fromId, toId, path) : FindRouteAStar(fromId, toId, path);
+}
+
+// =============================================================================
+//  A*
+// =============================================================================
+
+bool Router::FindRouteAStar(int fromId, int toId, std::vector<int>& path) {
+    path.clear();
+    int s = IndexOf(fromId);
+    int t = IndexOf(toId);
+    if (s == -1 || t == -1) return false;
+    NextStamp();
+
+    // Lower bound of any path through a teleport: reach one, then drive from a landing point
+    Vector3 goal = positions[t];
+    float viaLanding = FLT_MAX;
+    for (const Vector3& p : landingPoints) viaLanding = std::min(viaLanding, Vector3Distance(p, goal));
+    auto heuristic = [&](int v) {
+        float direct = Vector3Distance(positions[v], goal);
+        if (viaLanding == FLT_MAX || teleportDistance[v] == FLT_MAX) return direct;
+        return std::min(direct, teleportDistance[v] + viaLanding);
+    };
+
+    typedef std::pair<float, int> Entry; // (g + h, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    distFwd[s] = 0.0f;
+    parentFwd[s] = -1;
+    stampFwd[s] = stamp;
+    open.push({ heuristic(s), s });
+
+    while (!open.empty()) {
+        Entry top = open.top();
+        open.pop();
+        int u = top.second;
+        if (u == t) break;
+        if (top.first > distFwd[u] + heuristic(u) + 1e-3f) continue; // Stale entry
+
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            int v = edges[e].to;
+            float d = distFwd[u] + edges[e].cost;
+            if (stampFwd[v] != stamp || d < distFwd[v]) {
+                stampFwd[v] = stamp;
+                distFwd[v] = d;
+                parentFwd[v] = u;
+                open.push({ d + heuristic(v), v });
+            }
+        }
+    }
+    if (stampFwd[t] != stamp) return false;
+
+    for (int v = t; v != -1; v = parentFwd[v]) path.push_back(nodeIds[v]);
+    std::reverse(path.begin(), path.end());
+    lastCost = distFwd[t];
+    return true;
+}
+
+// =============================================================================
+//  CONTRACTION HIERARCHY
+// =============================================================================
+
+void Router::BuildContractionHierarchy() {
+    int n = (int)nodeIds.size();
+
+    // Working copy of the graph: outgoing and incoming edges (parallel edges merged)
+    std::vector<std::vector<Edge>> out(n), in(n);
+    auto addEdge = [&](int from, int to, float cost, int middle) {
+        for (Edge& e : out[from]) {
+            if (e.to != to) continue;
+            if (cost < e.cost) {
+                e.cost = cost;
+                e.middle = middle;
+                for (Edge& r : in[to]) {
+                    if (r.to == from) { r.cost = cost; r.middle = middle; }
+                }
+            }
+            return false;
+        }
+        out[from].push_back({ to, cost, middle });
+        in[to].push_back({ from, cost, middle });
+        return true;
+    };
+    for (int u = 0; u < n; u++) {
+        for (int e = firstEdge[u]; e < firstEdge[u + 1]; e++) {
+            if (edges[e].to != u) addEdge(u, edges[e].to, edges[e].cost, -1);
+        }
+    }
+
+    std::vector<unsigned char> contracted(n, 0);
+    std::vector<int> deletedNeighbors(n, 0);
+    rank.assign(n, 0);
+
+    // Witness search: is there a path from 'source' to each target no longer than 'limit'
+    // that avoids 'skip'? Bounded Dijkstra (settles at most 500 nodes), so it may miss
+    // witnesses and add a few unneeded shortcuts, never wrong ones.
+    std::vector<float> witnessDist(n, FLT_MAX);
+    std::vector<int> touched;
+    auto witnessSearch = [&](int source, int skip, float limit) {
+        for (int v : touched) witnessDist[v] = FLT_MAX;
+        touched.clear();
+        typedef std::pair<float, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        witnessDist[source] = 0.0f;
+        touched.push_back(source);
+        open.push({ 0.0f, source });
+        int settled = 0;
+        while (!open.empty() && settled < 500) {
+            Entry top = open.top();
+            open.pop();
+            if (top.first > witnessDist[top.second]) continue;
+            if (top.first > limit) break;
+            settled++;
+            for (const Edge& e : out[top.second]) {
+                if (contracted[e.to] || e.to == skip) continue;
+                float d = top.first + e.cost;
+                if (d < witnessDist[e.to]) {
+                    if (witnessDist[e.to] == FLT_MAX) touched.push_back(e.to);
+                    witnessDist[e.to] = d;
+                    open.push({ d, e.to });
+                }
+            }
+        }
+    };
+
+    // Contracts v (or only counts the shortcuts it would need when 'simulate')
+    auto contract = [&](int v, bool simulate) {
+        int shortcuts = 0;
+        float maxOut = 0.0f;
+        for (const Edge& e : out[v]) if (!contracted[e.to]) maxOut = std::max(maxOut, e.cost);
+
+        for (const Edge& inEdge : in[v]) {
+            int u = inEdge.to;
+            if (contracted[u]) continue;
+            witnessSearch(u, v, inEdge.cost + maxOut);
+            for (const Edge& outEdge : out[v]) {
+                int w = outEdge.to;
+                if (contracted[w] || w == u) continue;
+                float viaV = inEdge.cost + outEdge.cost;
+                if (witnessDist[w] <= viaV) continue; // Witness found, no shortcut needed
+                shortcuts++;
+                if (!simulate && addEdge(u, w, viaV, v)) shortcutCount++;
+            }
+        }
+        return shortcuts;
+    };
+    auto priority = [&](int v) {
+        int degree = 0;
+        for (const Edge& e : out[v]) if (!contracted[e.to]) degree++;
+        for (const Edge& e : in[v]) if (!contracted[e.to]) degree++;
+        return 2 * (contract(v, true) - degree) + deletedNeighbors[v]; // Edge difference, spread out
+    };
+
+    // Lazy updates: re-evaluate the top, contract it if it is still the best
+    typedef std::pair<int, int> Entry; // (priority, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (int v = 0; v < n; v++) queue.push({ priority(v), v });
+    int order = 0;
+    while (!queue.empty()) {
+        int v = queue.top().second;
+        queue.pop();
+        if (contracted[v]) continue;
+        int p = priority(v);
+        if (!queue.empty() && p > queue.top().first) {
+            queue.push({ p, v });
+            continue;
+        }
+        contract(v, false);
+        contracted[v] = 1;
+        rank[v] = order++;
+        for (const Edge& e : out[v]) deletedNeighbors[e.to]++;
+        for (const Edge& e : in[v]) deletedNeighbors[e.to]++;
+    }
+
+    // Search graphs: forward goes up the ranks, backward goes up the ranks on reversed edges
+    upFirst.assign(n + 1, 0);
+    downFirst.assign(n + 1, 0);
+    upEdges.clear();
+    downEdges.clear();
+    for (int u = 0; u < n; u++) {
+        upFirst[u] = (int)upEdges.size();
+        for (const Edge& e : out[u]) if (rank[e.to] > rank[u]) upEdges.push_back(e);
+        downFirst[u] = (int)downEdges.size();
+        for (const Edge& e : in[u]) if (rank[e.to] > rank[u]) downEdges.push_back(e); // e.to = source
+    }
+    upFirst[n] = (int)upEdges.size();
+    downFirst[n] = (int)downEdges.size();
+    hierarchyOut = out;
+    hasHierarchy = true;
+}
+
+void Router::UnpackEdge(int from, int to, int middle, std::vector<int>& out) const {
+    if (middle == -1) {
+        out.push_back(nodeIds[to]);
+        return;
+    }
+    // A shortcut from -> to skipped 'middle': unpack both halves
+    for (int half = 0; half < 2; half++) {
+        int a = half == 0 ? from : middle;
+        int b = half == 0 ? middle : to;
+        int inner = -1;
+        float best = FLT_MAX;
+        for (const Edge& e : hierarchyOut[a]) {
+            if (e.to == b && e.cost < best) {
+                best = e.cost;
+                inner = e.middle;
+            }
+        }
+        UnpackEdge(a, b, inner, out);
+    }
+}
+
+bool Router::FindRouteCH(int fromId, int toId, std::vector<int>& path) {
+    path.clear();
+    if (!hasHierarchy) return FindRouteAStar(fromId, toId, path);
+    int s = IndexOf(fromId);
+    int t = IndexOf(toId);
+    if (s == -1 || t == -1) return false;
+    NextStamp();
+
+    // Bidirectional Dijkstra, both sides only climb the hierarchy
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> fwd, bwd;
+    distFwd[s] = 0.0f; stampFwd[s] = stamp; parentFwd[s] = -1;
+    distBwd[t] = 0.0f; stampBwd[t] = stamp; parentBwd[t] = -1;
+    fwd.push({ 0.0f, s });
+    bwd.push({ 0.0f, t });
+    float best = FLT_MAX;
+    int meet = -1;
+
+    while (!fwd.empty() || !bwd.empty()) {
+        bool forward = bwd.empty() || (!fwd.empty() && fwd.top().first <= bwd.top().first);
+        auto& open = forward ? fwd : bwd;
+        if (open.top().first >= best) {
+            open = decltype(fwd)(); // This side cannot improve the meeting point any more
+            continue;
+        }
+        Entry top = open.top();
+        open.pop();
+        int u = top.second;
+        std::vector<float>& dist = forward ? distFwd : distBwd;
+        std::vector<unsigned int>& stamps = forward ? stampFwd : stampBwd;
+        if (top.first > dist[u]) continue;
+
+        // Meeting point?
+        const std::vector<float>& otherDist = forward ? distBwd : distFwd;
+        const std::vector<unsigned int>& otherStamps = forward ? stampBwd : stampFwd;
+        if (otherStamps[u] == stamp && dist[u] + otherDist[u] < best) {
+            best = dist[u] + otherDist[u];
+            meet = u;
+        }
+
+        const std::vector<int>& first = forward ? upFirst : downFirst;
+        const std::vector<Edge>& list = forward ? upEdges : downEdges;
+        std::vector<int>& parent = forward ? parentFwd : parentBwd;
+        std::vector<int>& parentMiddle = forward ? parentEdgeMiddleFwd : parentEdgeMiddleBwd;
+        for (int e = first[u]; e < first[u + 1]; e++) {
+            int v = list[e].to;
+            float d = dist[u] + list[e].cost;
+            if (stamps[v] != stamp || d < dist[v]) {
+                stamps[v] = stamp;
+                dist[v] = d;
+                parent[v] = u;
+                parentMiddle[v] = list[e].middle;
+                open.push({ d, v });
+            }
+        }
+    }
+    if (meet == -1) return false;
+
+    // s -> meet (forward parents, reversed), then meet -> t (backward parents)
+    std::vector<int> chain;
+    for (int v = meet; v != -1; v = parentFwd[v]) chain.push_back(v);
+    std::reverse(chain.begin(), chain.end());
+    path.push_back(nodeIds[s]);
+    for (size_t k = 1; k < chain.size(); k++) UnpackEdge(chain[k - 1], chain[k], parentEdgeMiddleFwd[chain[k]], path);
+    for (int v = meet; parentBwd[v] != -1; v = parentBwd[v]) UnpackEdge(v, parentBwd[v], parentEdgeMiddleBwd[v], path);
+
+    lastCost = best;
+    return true;
+}
+
+// =============================================================================
+//  LIVE TIMES TO THE EXITS
+// =============================================================================
+
+void Router::UpdateExitTimes(const RoadGraph& graph, int nodeBudget) {
+    int n = (int)nodeIds.size();
+    int exitCount = (int)exitNodes.size();
+    int settled = 0;
+    int finished = 0;
+
+    // Dijkstra from the exit on the reversed graph, costs read from the graph when a node
+    // is settled. It is resumed where the last call stopped, tables are swapped in when done.
+    while (settled < nodeBudget && finished < exitCount) {
+        if (pendingExit == -1) {
+            pendingExit = nextExitTable;
+            nextExitTable = (nextExitTable + 1) % exitCount;
+            pendingTimes.assign(n, FLT_MAX);
+            pendingOpen.clear();
+            int exitIndex = IndexOf(exitNodes[pendingExit]);
+            pendingTimes[exitIndex] = 0.0f;
+            pendingOpen.push_back({ 0.0f, exitIndex });
+        }
+
+        while (!pendingOpen.empty() && settled < nodeBudget) {
+            std::pop_heap(pendingOpen.begin(), pendingOpen.end(), std::greater<std::pair<float, int>>());
+            std::pair<float, int> top = pendingOpen.back();
+            pendingOpen.pop_back();
+            int v = top.second;
+            if (top.first > pendingTimes[v]) continue;
+            settled++;
+            for (int r = reverseFirst[v]; r < reverseFirst[v + 1]; r++) {
+                int e = reverseEdges[r];
+                int u = edgeSource[e];
+                float d = top.first + graph.GetEdgeTravelTime(edgeRoad[e]);
+                if (d < pendingTimes[u]) {
+                    pendingTimes[u] = d;
+                    pendingOpen.push_back({ d, u });
+                    std::push_heap(pendingOpen.begin(), pendingOpen.end(), std::greater<std::pair<float, int>>());
+                }
+            }
+        }
+
+        if (pendingOpen.empty()) {
+            exitTimes[pendingExit].swap(pendingTimes);
+            pendingExit = -1;
+            finished++;
+        }
+    }
+}
+
+float Router::GetTimeToExit(int exitId, int nodeId) const {
+    int x = (exitId >= 0 && exitId < (int)exitIndexById.size()) ? exitIndexById[exitId] : -1;
+    int v = IndexOf(nodeId);
+    if (x == -1 || v == -1 || exitTimes[x].empty()) return FLT_MAX;
+    return exitTimes[x][v];
+}
+
+int Router::ChooseFastestBranch(const RoadGraph& graph, int nodeId, int exitId) const {
+    int x = (exitId >= 0 && exitId < (int)exitIndexById.size()) ? exitIndexById[exitId] : -1;
+    int v = graph.GetNodeIndex(nodeId);
+    if (x == -1 || v == -1 || exitTimes[x].empty()) return -1;
+
+    // The roads of the node, straight from the graph's CSR (same dense indices as the tables)
+    const std::vector<float>& remaining = exitTimes[x];
+    int first = graph.GetEdgeBegin(v);
+    int best = -1;
+    float bestTime = FLT_MAX;
+    for (int road = first; road < graph.GetEdgeEnd(v); road++) {
+        int next = graph.GetEdgeTarget(road);
+        if (next == -1 || remaining[next] == FLT_MAX) continue;
+        float time = graph.GetEdgeTravelTime(road) + remaining[next];
+        if (time < bestTime) { // Ties keep the first branch
+            bestTime = time;
+            best = road - first;
+        }
+    }
+    return best;
+}
+
+// =============================================================================
+//  TRIPS
+// =============================================================================
+
+void MakeRouteChoices(const RoadGraph& graph, const std::vector<int>& path, std::vector<unsigned char>& choices) {
+    choices.clear();
+    for (size_t k = 0; k + 1 < path.size(); k++) {
+        const Node& node = graph.GetNode(path[k]);
+        if (node.type == TELEPORT || node.nextNodes.size() < 2) continue; // No choice to make
+        auto it = std::find(node.nextNodes.begin(), node.nextNodes.end(), path[k + 1]);
+        choices.push_back((unsigned char)(it - node.nextNodes.begin()));
+    }
+}
+
+void AssignTrips(VehicleStore& vehicles, const RoadGraph& graph, Router& router, bool storeRoutes) {
+    const std::vector<int>& exits = router.GetExitNodes();
+    if (exits.empty()) return;
+
+    std::vector<int>& path = router.tripPath;
+    std::vector<unsigned char>& choices = router.tripChoices;
+    for (int i = 0; i < vehicles.Size(); i++) {
+        if (vehicles.finished[i] || vehicles.tripDestination[i] != VehicleStore::TRIP_NONE) continue;
+
+        // The exit the demand asked for, else a random exit we can reach from where the vehicle is heading
+        int from = vehicles.targetNodeId[i];
+        int destination = VehicleStore::TRIP_RANDOM;
+        int request = vehicles.tripRequest[i];
+        vehicles.tripRequest[i] = -1; // One trip only
+        for (int attempt = request >= 0 ? -1 : 0; attempt < 4; attempt++) {
+            int exitId = attempt < 0 ? request : exits[SimRandom::GetValue(0, (int)exits.size() - 1)];
+            if (exitId == from) continue;
+            // Dynamic trips only need a destination: the branches are picked on arrival
+            bool reachable = storeRoutes ? router.FindRoute(from, exitId, path)
+                                         : router.GetTimeToExit(exitId, from) != FLT_MAX;
+            if (reachable) {
+                destination = exitId;
+                break;
+            }
+        }
+
+        if (destination == VehicleStore::TRIP_RANDOM || !storeRoutes) choices.clear();
+        else MakeRouteChoices(graph, path, choices);
+        vehicles.SetRoute(i, destination, choices);
+    }
+}
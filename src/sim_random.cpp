@@ -0,0 +1,29 @@
+#include "sim_random.h"
+#include <cstdint>
+
+namespace SimRandom {
+
+    // xorshift64* state (must never be 0)
+    static uint64_t state = 0x9E3779B97F4A7C15ull;
+
+    void Seed(unsigned int seed) {
+        // SplitMix64 step to spread small seeds over the whole state
+        uint64_t z = (uint64_t)seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = z ^ (z >> 31);
+        if (state == 0) state = 0x9E3779B97F4A7C15ull;
+    }
+
+    int GetValue(int min, int max) {
+        if (min > max) { int tmp = min; min = max; max = tmp; }
+
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t r = state * 0x2545F4914F6CDD1Dull;
+
+        uint64_t range = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+        return (int)((int64_t)min + (int64_t)((r >> 11) % range));
+    }
+}
@@ -1,13 +1,29 @@
 #include "simulation.h"
-#include "basicmap.h"
+#include "road_network.h"
 #include "config.h" //.-.
-#include <cmath> // Needed for fabs
+#include "profiler.h"
+#include <climits>
 
 Simulation::Simulation() : trafficMgr(20.0f, 50.0f) {} 
 
 void Simulation::Init() {
+    if (!globalConfig.demandPath.empty()) demand.Load(globalConfig.demandPath.c_str());
+    else demand.Clear();
+
+    // Map file: its nodes and lights replace the built-in scene below
+    if (!globalConfig.networkPath.empty() && networkFile.Load(globalConfig.networkPath.c_str())) {
+        networkFile.BuildGraph(roadGraph);
+        networkFile.ConfigureLights(trafficMgr);
+        return;
+    }
+
     InitializeRoadNetwork(roadGraph);
 
+    // Main roundabout: each entry is metered by its own signal (the conflicting
+    // flow is the circulating traffic, which has no light). Every entry runs the
+    // same 33s cycle, green 15s + yellow 3s + red 15s; the plan offsets stagger
+    // them so the W/E pair and the S/N pair get the ring mostly to themselves.
+
     // 1. SOUTH LIGHT (Node 16)
     // Controls traffic entering the roundabout from the South
     trafficMgr.AddController(16, { 16, 17 }); 
@@ -15,8 +31,7 @@ void Simulation::Init() {
         16,                         // ID
         { 10.5f, 0.0f, 34.0f },     // Position (from Chaimae's basicmap.cpp)
         0.0f,                       // Rotation (Face Z+)
-        20.0f,                       // Start Delay 20s= red35s -> green50s -> yellow53s
-        15.0f, 3.0f, 15.0f          // Timings: Green, Yellow, Red
+        0.0f, 15.0f, 3.0f, 15.0f    // Timings (replaced by the plan below)
     );
 
     // 2. NORTH LIGHT (Node 12)
@@ -26,8 +41,7 @@ void Simulation::Init() {
         12,                         // ID
         { -10.5f, 0.0f, -34.0f },   // Position
         180.0f,                     // Rotation (Face Z-)
-        25.0f,                       // Start Delay 25s= red40s -> green55s -> yellow58s
-        15.0f, 3.0f, 15.0f          // Timings: Green, Yellow, Red
+        0.0f, 15.0f, 3.0f, 15.0f
     );
 
     // 3. EAST LIGHT (Node 8)
@@ -37,8 +51,7 @@ void Simulation::Init() {
         8,                          // ID
         { 34.0f, 0.0f, -10.5f },    // Position
         90.0f,                      // Rotation (Face X+)
-        5.0f,                       // Start Delay 5s= red20s -> green35s -> yellow38s
-        15.0f, 3.0f, 15.0f          // Timings: Green, Yellow, Red
+        0.0f, 15.0f, 3.0f, 15.0f
     );
 
     // 4. WEST LIGHT (Node 2)
@@ -48,110 +61,156 @@ void Simulation::Init() {
         2,                          // ID
         { -34.0f, 0.0f, 10.5f },    // Position
         270.0f,                     // Rotation (Face X-)
-        0.0f,                       // Start Delay 0= red15s -> green30s -> yellow33s
-        15.0f, 3.0f, 15.0f          // Timings: Green, Yellow, Red
+        0.0f, 15.0f, 3.0f, 15.0f
     );
+
+    // Phase plans: one stage (green 15s), yellow 3s, 15s clearance = 33s cycle.
+    // Offset = start of green: W 0s, E 5s, S 20s, N 25s
+    const int entries[4] = { 2, 8, 16, 12 };
+    const float offsets[4] = { 0.0f, 5.0f, 20.0f, 25.0f };
+    for (int k = 0; k < 4; k++) {
+        trafficMgr.AddSignalPlan(entries[k], { entries[k] }, 3.0f, 15.0f);
+        trafficMgr.AddStage(entries[k], { entries[k] }, 15.0f);
+        trafficMgr.SetPlanOffset(entries[k], offsets[k]);
+    }
 }
 
 void Simulation::ApplyConfiguration() {
-    vehicles.clear();
-    roadGraph.Clear();
-    InitializeRoadNetwork(roadGraph);
-    spawner.LoadFromConfig();
+    vehicles.Clear();
+    accumulator = 0.0;
+    workers.Resize(globalConfig.workerThreads);
+    if (networkFile.IsLoaded()) {
+        networkFile.BuildGraph(roadGraph); // From the mapped blob, no parsing
+    } else {
+        roadGraph.Clear();
+        InitializeRoadNetwork(roadGraph);
+    }
+    trafficMgr.SyncNodeLights(roadGraph); // Fresh nodes: copy the current light states back
+    trafficMgr.SetControlMode(globalConfig.signalControl);
+    trafficMgr.SetApproachStats(globalConfig.approachStats);
+    trafficMgr.ResetApproachStats();
+    router.Build(roadGraph);
+    if (router.GetNodeCount() >= Router::CH_MIN_NODES) router.BuildContractionHierarchy();
+    router.UpdateExitTimes(roadGraph, INT_MAX); // Free-flow tables, all at once
+    meso.Build(roadGraph);
+    if (demand.HasDemand()) {
+        demand.Prepare(roadGraph); // Arrivals from the OD matrix instead of the config counts
+        spawner.Clear();
+    }
+    else if (networkFile.IsLoaded()) spawner.LoadFromConfig(roadGraph); // The map's own START nodes
+    else spawner.LoadFromConfig();
 }
 
 void Simulation::Clear() {
-    vehicles.clear();
+    vehicles.Clear();
+    meso.Clear();
+    accumulator = 0.0;
     spawner.Clear();
 }
 
 int Simulation::GetVehicleCount() const {
-    return (int)vehicles.size();
+    return vehicles.GetLiveCount();
 }
 
-void Simulation::Update(float dt, Camera3D camera) {
-    // 1. Spawner
-    spawner.Update(roadGraph, vehicles);
-
-    // =========================================================
-    //  INTERACTION
-    // =========================================================
-    Vector2 mouse = GetMousePosition();
-    Vector2 scaledMouse = mouse;
-    scaledMouse.x = mouse.x * ((float)SimulationConfig::SCREEN_WIDTH / GetScreenWidth());
-    scaledMouse.y = mouse.y * ((float)SimulationConfig::SCREEN_HEIGHT / GetScreenHeight());
-    
-    Ray ray = GetMouseRay(scaledMouse, camera);
-    
-    Vehicle* hoveredVehicle = nullptr;
-    float minHitDist = 9999.0f; // Track closest hit
-
-    for (auto& v : vehicles) {
-        // --- ADAPTIVE HITBOX MATH ---
-        // We calculate how much space the car takes on X and Z axes based on its rotation.
-        // Width is approx 2.5m for all cars. Length varies.
-        float width = 2.5f;
-        
-        // Project length and width onto the axes
-        // If facing X: SizeX = Length, SizeZ = Width
-        // If facing Z: SizeX = Width,  SizeZ = Length
-        // If 45 deg:   SizeX = Mix,    SizeZ = Mix
-        float halfSizeX = (fabs(v->forward.x) * v->length + fabs(v->forward.z) * width) / 2.0f;
-        float halfSizeZ = (fabs(v->forward.z) * v->length + fabs(v->forward.x) * width) / 2.0f;
-
-        // Construct the rotating box
-        BoundingBox box = {
-            (Vector3){ v->position.x - halfSizeX, v->position.y, v->position.z - halfSizeZ },
-            (Vector3){ v->position.x + halfSizeX, v->position.y + 2.5f, v->position.z + halfSizeZ }
-        };
-
-        // Check Raycast
-        RayCollision collision = GetRayCollisionBox(ray, box);
-        
-        if (collision.hit) {
-            // Only pick this car if it is closer than previous hits
-            if (collision.distance < minHitDist) {
-                minHitDist = collision.distance;
-                hoveredVehicle = v.get();
-            }
-        }
-    }
-    
-    // --- APPLY INTERACTION TO THE WINNER ---
-    if (hoveredVehicle != nullptr) {
-        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
-        
-        if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-            hoveredVehicle->forceMoveTimer = 2.5f;
+const VehicleStore& Simulation::GetVehicles() const {
+    return vehicles;
+}
+
+void Simulation::ForceMoveVehicle(VehicleHandle handle, float seconds) {
+    int index = vehicles.Resolve(handle);
+    if (index == -1) return; // Left the network since it was picked
+    vehicles.forceMoveTimer[index] = seconds;
+}
+
+int Simulation::Advance(float frameTime, float speed) {
+    const float step = SimulationConfig::FIXED_TIMESTEP;
+    accumulator += (double)frameTime * speed;
+
+    int steps = 0;
+    // Small tolerance so 3 frames of 1/180s still add up to one 1/60s step
+    while (accumulator + 1e-6 >= step) {
+        if (steps >= SimulationConfig::MAX_SUBSTEPS_PER_FRAME) {
+            // Machine too slow for the requested speed: drop the backlog instead of piling it up
+            accumulator = 0.0;
+            break;
         }
-    }
 
-    // =========================================================
+        // Keep the previous state for render interpolation
+        vehicles.prevPosition = vehicles.position;
+        vehicles.prevForward = vehicles.forward;
 
-    // 2. Traffic Logic
-    trafficMgr.UpdateLights(dt, roadGraph, vehicles);// Update lights before vehicles
-    trafficMgr.UpdateVehicles(vehicles, roadGraph);
-    
-    // 3. Physics
-    for (auto &v : vehicles) {
-        v->update(dt, roadGraph, vehicles); 
+        Update(step);
+        accumulator -= step;
+        steps++;
     }
+    if (accumulator < 0.0) accumulator = 0.0;
+
+    interpolationAlpha = (float)(accumulator / step);
+    if (interpolationAlpha > 1.0f) interpolationAlpha = 1.0f;
+    return steps;
 }
 
-void Simulation::Draw3D(bool showDebugNodes) {
-    // 1. Draw the Roads
-    DrawBasicMap();
+float Simulation::GetInterpolationAlpha() const {
+    return interpolationAlpha;
+}
 
-    // 2. Draw the Traffic Lights
-    trafficMgr.Draw(); 
+long Simulation::GetStepCount() const {
+    return stepCount;
+}
 
-    // 3. Draw Debug Nodes
-    if (showDebugNodes) roadGraph.DrawNodes();
+void Simulation::Update(float dt) {
+    PROFILE_SCOPE("Sim.Update");
+    stepCount++;
 
-    // 4. Draw Vehicles
-    for (auto &v : vehicles) v->draw();
-}
+    bool mesoscopic = globalConfig.engine == ENGINE_MESO;
+
+    // 1. Spawner: this tick's demand, or the vehicles that left at an exit last tick
+    //    queueing again at its landing
+    {
+        PROFILE_SCOPE("Spawner");
+        if (demand.HasDemand()) {
+            arrivals.clear();
+            demand.Generate(dt, arrivals);
+            for (const DemandArrival& a : arrivals) spawner.Enqueue({ a.type, a.originId, a.destinationId });
+        }
+        else if (!vehicles.exits.empty()) {
+            spawner.Requeue(vehicles.exits, roadGraph);
+        }
+        vehicles.exits.clear();
+        if (mesoscopic) spawner.UpdateMeso(roadGraph, vehicles, meso);
+        else spawner.Update(roadGraph, vehicles);
+    }
+    if (globalConfig.routing != ROUTING_RANDOM_WALK) {
+        PROFILE_SCOPE("Routing");
+        bool dynamic = globalConfig.routing == ROUTING_DYNAMIC;
+        if (dynamic) router.UpdateExitTimes(roadGraph, Router::EXIT_NODES_PER_TICK); // Amortized rerouting
+        AssignTrips(vehicles, roadGraph, router, !dynamic);
+    }
 
-void Simulation::DrawOverlay(bool showDebugNodes, Camera3D camera) {
-    if (showDebugNodes) roadGraph.DrawIdNodes(camera);
-}
\ No newline at end of file
+    // 2. Traffic Logic
+    {
+        PROFILE_SCOPE("UpdateLights");
+        trafficMgr.UpdateLights(dt, roadGraph, vehicles);// Update lights before vehicles
+    }
+    if (mesoscopic) {
+        // Queues instead of car following + physics; the road samples come with the departures
+        PROFILE_SCOPE("Meso");
+        meso.Update(dt, vehicles, roadGraph, globalConfig.routing == ROUTING_DYNAMIC ? &router : nullptr);
+        roadGraph.UpdateTravelTimes(dt);
+        return;
+    }
+    {
+        PROFILE_SCOPE("UpdateVehicles");
+        trafficMgr.UpdateVehicles(dt, vehicles, roadGraph, &workers, globalConfig.routing == ROUTING_DYNAMIC ? &router : nullptr);
+    }
+    
+    // 3. Physics
+    {
+        PROFILE_SCOPE("Physics");
+        UpdateVehicleMotion(vehicles, dt, roadGraph, &workers, globalConfig.routing == ROUTING_DYNAMIC ? &router : nullptr);
+    }
+    {
+        PROFILE_SCOPE("TravelTimes");
+        UpdateEdgeTravelTimes(vehicles, roadGraph, dt);
+    }
+}
@@ -0,0 +1,47 @@
+#include "simulation.h"
+#include "basicmap.h"
+#include "static_scene.h"
+#include "vehicle_draw.h"
+#include "profiler.h"
+#include "config.h"
+#include "raymath.h"
+#include "rlgl.h"
+
+void Simulation::Draw3D(bool showDebugNodes, Camera3D camera) {
+    // BeginMode3D already loaded the camera matrices, the frustum comes straight from them
+    Frustum frustum = ExtractFrustum(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+    renderStats = RenderStats();
+
+    // 1. Draw the Roads (+ buildings, culled one by one when baked)
+    {
+        PROFILE_SCOPE("DrawBasicMap");
+        if (bakedMap && bakedMap->IsBuilt()) {
+            bakedMap->Draw(frustum, camera.position, CONFIG::LOD_BUILDING_DISTANCE, renderStats.buildings);
+        } else {
+            DrawBasicMap();
+            renderStats.buildings.drawn = GetBuildingCount();
+        }
+    }
+
+    // 2. Draw the Traffic Lights
+    {
+        PROFILE_SCOPE("DrawLights");
+        trafficMgr.Draw(frustum, camera.position, renderStats.lights);
+    }
+
+    // 3. Draw Debug Nodes
+    if (showDebugNodes) {
+        PROFILE_SCOPE("DrawNodes");
+        roadGraph.DrawNodes();
+    }
+
+    // 4. Draw Vehicles
+    {
+        PROFILE_SCOPE("DrawVehicles");
+        DrawVehicles(vehicles, interpolationAlpha, frustum, camera.position, renderStats.vehicles);
+    }
+}
+
+void Simulation::DrawOverlay(bool showDebugNodes, Camera3D camera) {
+    if (showDebugNodes) roadGraph.DrawIdNodes(camera);
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "spatial_grid.h"
+#include "vehicle.h"
+#include <cmath>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float size)
+    : cellSize(size), invCellSize(1.0f / size), bucketMask(0) {}
+
+int SpatialGrid::CellCoord(float v) const {
+    return (int)floorf(v * invCellSize);
+}
+
+unsigned int SpatialGrid::Bucket(int cx, int cz) const {
+    // Two large primes spread neighbouring cells over different buckets
+    unsigned int h = (unsigned int)cx * 73856093u ^ (unsigned int)cz * 19349663u;
+    return h & bucketMask;
+}
+
+void SpatialGrid::Build(const VehicleStore& vehicles) {
+    size_t count = vehicles.Size();
+
+    // Keep roughly 2 buckets per vehicle (power of two so we can mask instead of mod)
+    unsigned int bucketCount = 64;
+    while (bucketCount < count * 2) bucketCount <<= 1;
+    bucketMask = bucketCount - 1;
+
+    cellX.resize(count);
+    cellZ.resize(count);
+    positions.resize(count);
+    bucketStart.assign(bucketCount + 1, 0);
+
+    // 1. Count how many vehicles fall in each bucket
+    for (size_t i = 0; i < count; i++) {
+        positions[i] = vehicles.position[i];
+        cellX[i] = CellCoord(positions[i].x);
+        cellZ[i] = CellCoord(positions[i].z);
+        if (vehicles.finished[i]) continue;
+        bucketStart[Bucket(cellX[i], cellZ[i]) + 1]++;
+    }
+
+    // 2. Prefix sum -> start offset of every bucket
+    for (unsigned int b = 0; b < bucketCount; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // 3. Scatter the indices (ascending order is preserved inside a bucket)
+    entries.resize(bucketStart[bucketCount]);
+    std::vector<int> cursor(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (vehicles.finished[i]) continue;
+        entries[cursor[Bucket(cellX[i], cellZ[i])]++] = (int)i;
+    }
+}
+
+void SpatialGrid::Query(Vector3 center, float radius, std::vector<int>& out) const {
+    out.clear();
+    if (bucketStart.empty()) return;
+
+    int minX = CellCoord(center.x - radius);
+    int maxX = CellCoord(center.x + radius);
+    int minZ = CellCoord(center.z - radius);
+    int maxZ = CellCoord(center.z + radius);
+    float radiusSq = radius * radius;
+
+    for (int cx = minX; cx <= maxX; cx++) {
+        for (int cz = minZ; cz <= maxZ; cz++) {
+            unsigned int b = Bucket(cx, cz);
+            for (int k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                int idx = entries[k];
+                // Different cells can share a bucket: only keep the ones really in this cell
+                if (cellX[idx] != cx || cellZ[idx] != cz) continue;
+
+                float dx = positions[idx].x - center.x;
+                float dy = positions[idx].y - center.y;
+                float dz = positions[idx].z - center.z;
+                if (dx*dx + dy*dy + dz*dz <= radiusSq) out.push_back(idx);
+            }
+        }
+    }
+
+    // Same iteration order as a plain "for j" scan
+    std::sort(out.begin(), out.end());
+}
@@ -1,78 +1,181 @@
 #include "spawner.h"
 #include "raymath.h" // For Vector3 operations
+#include "sim_random.h"
+#include "meso_engine.h"
+#include <algorithm>
 
-VehicleSpawner::VehicleSpawner() {}
+constexpr float VehicleSpawner::SPAWN_CLEARANCE;
+
+VehicleSpawner::VehicleSpawner() : grid(SPAWN_CLEARANCE) {}
 
 void VehicleSpawner::LoadFromConfig() {
-    spawnQueue.clear();
+    Clear();
     for (const auto& cfg : globalConfig.vehicleConfigs) {
         for(int i = 0; i < cfg.count; i++) {
             if (cfg.startNodes.empty()) continue;
-            int nodeId = cfg.startNodes[GetRandomValue(0, cfg.startNodes.size() - 1)];
-            spawnQueue.push_back({cfg.type, nodeId});
+            int nodeId = cfg.startNodes[SimRandom::GetValue(0, cfg.startNodes.size() - 1)];
+            Enqueue({VehicleTypeFromName(cfg.type), nodeId});
+        }
+    }
+}
+
+void VehicleSpawner::LoadFromConfig(const RoadGraph& graph) {
+    std::vector<int> mapStarts;
+    for (const Node& n : graph.GetAllNodes()) {
+        if (n.type == START && !n.nextNodes.empty()) mapStarts.push_back(n.id);
+    }
+
+    Clear();
+    for (const auto& cfg : globalConfig.vehicleConfigs) {
+        std::vector<int> starts;
+        for (int id : cfg.startNodes) {
+            const Node* n = graph.FindNode(id);
+            if (n && n->type == START) starts.push_back(id);
+        }
+        if (starts.empty()) starts = mapStarts;
+        for (int i = 0; i < cfg.count; i++) {
+            if (starts.empty()) continue;
+            int nodeId = starts[SimRandom::GetValue(0, starts.size() - 1)];
+            Enqueue({VehicleTypeFromName(cfg.type), nodeId});
+        }
+    }
+}
+
+void VehicleSpawner::Enqueue(const QueuedVehicle& q) {
+    if (q.type == VEHICLE_GENERIC || q.startNodeId < 0) return; // Can never spawn
+
+    if (q.startNodeId >= (int)queueByNode.size()) queueByNode.resize(q.startNodeId + 1, -1);
+    int k = queueByNode[q.startNodeId];
+    if (k == -1) {
+        k = queueByNode[q.startNodeId] = (int)queues.size();
+        queues.push_back({ q.startNodeId, {} });
+    }
+    queues[k].fifo.push_back({ q, nextOrder++ });
+    waitingCount++;
+}
+
+void VehicleSpawner::Requeue(const std::vector<VehicleExit>& exits, const RoadGraph& graph) {
+    for (const VehicleExit& e : exits) {
+        const Node& exitNode = graph.GetNode(e.exitNodeId);
+        if (exitNode.IsValid() && graph.HasNode(exitNode.teleportTargetId)) {
+            Enqueue({ e.type, exitNode.teleportTargetId });
         }
     }
 }
 
 void VehicleSpawner::Clear() {
-    spawnQueue.clear();
+    queues.clear();
+    queueByNode.clear();
+    nextOrder = 0;
+    waitingCount = 0;
+    spawnedCount = 0;
+}
+
+void VehicleSpawner::DropQueue(StartQueue& q) {
+    waitingCount -= (int)q.fifo.size();
+    q.fifo.clear();
+}
+
+bool VehicleSpawner::IsClear(Vector3 pos, const VehicleStore& vehicles) {
+    // The grid is from the start of the pass: add what spawned since
+    for (const Vector3& p : spawnedNow) {
+        if (Vector3Distance(p, pos) < SPAWN_CLEARANCE) return false;
+    }
+    grid.Query(pos, SPAWN_CLEARANCE, nearby);
+    for (int v : nearby) {
+        if (Vector3Distance(vehicles.position[v], pos) < SPAWN_CLEARANCE) return false;
+    }
+    return true;
 }
 
-std::unique_ptr<Vehicle> VehicleSpawner::CreateVehicle(const std::string& type, Vector3 pos, int target) {
-    if (type == "Car") return std::make_unique<Car>(pos, target);
-    if (type == "Bus") return std::make_unique<Bus>(pos, target);
-    if (type == "Truck") return std::make_unique<Truck>(pos, target);
-    if (type == "Taxi") return std::make_unique<Taxi>(pos, target);
-    if (type == "Police") return std::make_unique<PoliceCar>(pos, target);
-    if (type == "Motorcycle") return std::make_unique<Motorcycle>(pos, target);
-    return nullptr;
+void VehicleSpawner::Spawn(const QueuedVehicle& q, const Node& n, RoadGraph& graph, VehicleStore& vehicles, MesoEngine* meso) {
+    Vector3 pos = n.pos;
+    int target = n.nextNodes[0];
+
+    // 1. Add the vehicle with its type defaults
+    int idx = vehicles.Add(q.type, pos, target);
+    vehicles.edgeFromId[idx] = n.id; // On the road start -> nextNodes[0]
+    vehicles.edgeBranch[idx] = 0;
+    vehicles.tripRequest[idx] = q.destinationId;
+    spawnedCount++;
+
+    if (meso) {
+        meso->Insert(vehicles, idx);
+        return;
+    }
+
+    // 2. Fix Orientation
+    Vector3 targetPos = graph.GetNode(target).pos;
+    Vector3 dir = Vector3Subtract(targetPos, pos);
+    vehicles.forward[idx] = Vector3Normalize(dir);
+    vehicles.prevForward[idx] = vehicles.forward[idx];
 }
 
-void VehicleSpawner::Update(RoadGraph& graph, std::vector<std::unique_ptr<Vehicle>>& vehicles) {
-    for (auto it = spawnQueue.begin(); it != spawnQueue.end(); ) {
-        Node &n = graph.GetNode(it->startNodeId);
-
-        // --- 1. SMART SAFETY CHECK ---
-        // We check physical space.
-        // We assume the node is blocked until proven otherwise.
-        bool isBlocked = false;
-
-        for (const auto& v : vehicles) {
-            // Distance Check:
-            // 8.0f ensures a natural "following distance" gap.
-            if (Vector3Distance(v->position, n.pos) < 8.0f) {
-                isBlocked = true;
-                break;
-            }
+void VehicleSpawner::Update(RoadGraph& graph, VehicleStore& vehicles) {
+    if (waitingCount == 0) return;
+
+    // Heads in arrival order: the order the single queue used to try them in
+    heads.clear();
+    for (int k = 0; k < (int)queues.size(); k++) {
+        if (!queues[k].fifo.empty()) heads.push_back({ queues[k].fifo.front().order, k });
+    }
+    std::sort(heads.begin(), heads.end());
+
+    // --- 1. SMART SAFETY CHECK ---
+    // Only the vehicles near a start node can block it: one grid build, then one
+    // small query per head instead of a scan of every vehicle per queued entry
+    grid.Build(vehicles);
+    spawnedNow.clear();
+
+    // --- 2. SPAWN LOGIC ---
+    // One spawn per start node and pass: the new vehicle blocks the ones behind it
+    for (const auto& h : heads) {
+        StartQueue& q = queues[h.second];
+        const Node& n = graph.GetNode(q.nodeId);
+
+        // Unknown start node (or no road out of it): this queue can never spawn, drop it
+        if (!n.IsValid() || n.nextNodes.empty()) {
+            DropQueue(q);
+            continue;
         }
+        if (!IsClear(n.pos, vehicles)) continue; // Blocked: try again later
 
-        // --- 2. SPAWN LOGIC ---
-        // Only spawn if the spawn point is physically clear (!isBlocked)
-        if (!isBlocked) {
-
-            if (!n.nextNodes.empty()) {
-                Vector3 pos = n.pos;
-                int target = n.nextNodes[0];
-
-                // 1. Create the specific vehicle
-                auto newVehicle = CreateVehicle(it->type, pos, target);
-                
-                // 2. Fix Orientation
-                if (newVehicle) {
-                    Vector3 targetPos = graph.GetNode(target).pos;
-                    Vector3 dir = Vector3Subtract(targetPos, pos);
-                    newVehicle->forward = Vector3Normalize(dir);
-                    
-                    // Add to the main simulation list
-                    vehicles.push_back(std::move(newVehicle));
-                }
-            }
-
-            // Success: Remove from queue
-            it = spawnQueue.erase(it);
-        } else {
-            // Blocked: Try next one later
-            ++it;
+        Spawn(q.fifo.front().vehicle, n, graph, vehicles, nullptr);
+        spawnedNow.push_back(n.pos);
+        q.fifo.pop_front();
+        waitingCount--;
+    }
+}
+
+void VehicleSpawner::UpdateMeso(RoadGraph& graph, VehicleStore& vehicles, MesoEngine& meso) {
+    if (waitingCount == 0) return;
+
+    // Same arrival order as Update, but a road with room can take several vehicles per
+    // pass: merge the queues by arrival number (min-heap of their heads)
+    heads.clear();
+    for (int k = 0; k < (int)queues.size(); k++) {
+        if (!queues[k].fifo.empty()) heads.push_back({ -queues[k].fifo.front().order, k });
+    }
+    std::make_heap(heads.begin(), heads.end());
+
+    while (!heads.empty()) {
+        std::pop_heap(heads.begin(), heads.end());
+        StartQueue& q = queues[heads.back().second];
+        heads.pop_back();
+
+        const Node& n = graph.GetNode(q.nodeId);
+        if (!n.IsValid() || n.nextNodes.empty()) { // Can never spawn
+            DropQueue(q);
+            continue;
+        }
+        if (!meso.HasRoom(n.id, 0)) continue; // Full until the next departure
+
+        Spawn(q.fifo.front().vehicle, n, graph, vehicles, &meso);
+        q.fifo.pop_front();
+        waitingCount--;
+        if (!q.fifo.empty()) {
+            heads.push_back({ -q.fifo.front().order, (int)(&q - queues.data()) });
+            std::push_heap(heads.begin(), heads.end());
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,181 @@
+#include "static_scene.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <cfloat>
+#include <cstring>
+
+// Lines per rlBegin/rlEnd block (stays well under the default rlgl batch size)
+static const int LINES_PER_BATCH = 2048;
+
+// =============================================================================
+//  BUILD
+// =============================================================================
+
+void StaticScene::AddModel(Part& part, const std::vector<float>& vertices, const std::vector<unsigned char>& colors) {
+    if (vertices.empty()) return;
+
+    Mesh mesh = { 0 };
+    mesh.vertexCount = (int)(vertices.size() / 3);
+    mesh.triangleCount = mesh.vertexCount / 3;
+    mesh.vertices = (float*)MemAlloc((unsigned int)(vertices.size() * sizeof(float)));
+    mesh.colors = (unsigned char*)MemAlloc((unsigned int)colors.size());
+    memcpy(mesh.vertices, vertices.data(), vertices.size() * sizeof(float));
+    memcpy(mesh.colors, colors.data(), colors.size());
+
+    UploadMesh(&mesh, false);
+    part.models.push_back(LoadModelFromMesh(mesh));
+    meshCount++;
+    triangleCount += mesh.triangleCount;
+}
+
+StaticScene::Part StaticScene::BakePart(MapGeometry& geometry) {
+    Part part;
+    AddModel(part, geometry.opaqueVertices, geometry.opaqueColors);
+    part.opaqueCount = (int)part.models.size();
+    AddModel(part, geometry.translucentVertices, geometry.translucentColors);
+
+    part.firstLine = lines.GetLineCount();
+    part.lineCount = geometry.GetLineCount();
+    lines.lineVertices.insert(lines.lineVertices.end(), geometry.lineVertices.begin(), geometry.lineVertices.end());
+    lines.lineColors.insert(lines.lineColors.end(), geometry.lineColors.begin(), geometry.lineColors.end());
+    return part;
+}
+
+// Bounds and average color (weighted by triangle area) of the recorded triangles
+static void MeasureGeometry(const MapGeometry& geometry, BoundingBox& bounds, Color& average) {
+    bounds.min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    bounds.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    double sum[3] = { 0, 0, 0 };
+    double totalArea = 0;
+
+    const std::vector<float>& v = geometry.opaqueVertices;
+    const std::vector<unsigned char>& c = geometry.opaqueColors;
+    for (size_t t = 0; t + 9 <= v.size(); t += 9) {
+        Vector3 a = { v[t], v[t + 1], v[t + 2] };
+        Vector3 b = { v[t + 3], v[t + 4], v[t + 5] };
+        Vector3 d = { v[t + 6], v[t + 7], v[t + 8] };
+        bounds.min = Vector3Min(bounds.min, Vector3Min(a, Vector3Min(b, d)));
+        bounds.max = Vector3Max(bounds.max, Vector3Max(a, Vector3Max(b, d)));
+
+        double area = 0.5 * Vector3Length(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(d, a)));
+        size_t ci = (t / 3) * 4;
+        for (int k = 0; k < 3; k++) sum[k] += area * c[ci + k];
+        totalArea += area;
+    }
+    for (size_t i = 0; i + 3 <= geometry.translucentVertices.size(); i += 3) {
+        Vector3 p = { geometry.translucentVertices[i], geometry.translucentVertices[i + 1], geometry.translucentVertices[i + 2] };
+        bounds.min = Vector3Min(bounds.min, p);
+        bounds.max = Vector3Max(bounds.max, p);
+    }
+
+    if (bounds.min.x > bounds.max.x) bounds.min = bounds.max = { 0, 0, 0 }; // Nothing recorded
+    average = GRAY;
+    if (totalArea > 0) {
+        average = { (unsigned char)(sum[0] / totalArea), (unsigned char)(sum[1] / totalArea),
+                    (unsigned char)(sum[2] / totalArea), 255 };
+    }
+}
+
+void StaticScene::Build(void (*drawGround)(), int objectCount, void (*drawObject)(int index)) {
+    Unload();
+
+    MapGeometry geometry;
+    MapDraw::BeginRecording(&geometry);
+    drawGround();
+    MapDraw::EndRecording();
+    ground = BakePart(geometry);
+
+    for (int i = 0; i < objectCount; i++) {
+        geometry.Clear();
+        MapDraw::BeginRecording(&geometry);
+        drawObject(i);
+        MapDraw::EndRecording();
+
+        BakedObject object;
+        MeasureGeometry(geometry, object.bounds, object.lodColor);
+        object.part = BakePart(geometry);
+        objects.push_back(object);
+    }
+
+    TraceLog(LOG_INFO, "STATIC SCENE: Baked %d triangles in %d meshes (%d objects), %d lines",
+             triangleCount, meshCount, (int)objects.size(), lines.GetLineCount());
+    built = true;
+}
+
+// =============================================================================
+//  DRAW
+// =============================================================================
+
+void StaticScene::DrawPart(const Part& part) const {
+    for (int m = 0; m < part.opaqueCount; m++) DrawModel(part.models[m], { 0, 0, 0 }, 1.0f, WHITE);
+
+    // Wires: already in world space, streamed in a few large line batches
+    const float* v = lines.lineVertices.data();
+    const unsigned char* c = lines.lineColors.data();
+    int end = part.firstLine + part.lineCount;
+    for (int first = part.firstLine; first < end; first += LINES_PER_BATCH) {
+        int last = first + LINES_PER_BATCH;
+        if (last > end) last = end;
+
+        rlCheckRenderBatchLimit((last - first) * 2);
+        rlBegin(RL_LINES);
+        for (int i = first * 2; i < last * 2; i++) {
+            rlColor4ub(c[i*4 + 0], c[i*4 + 1], c[i*4 + 2], c[i*4 + 3]);
+            rlVertex3f(v[i*3 + 0], v[i*3 + 1], v[i*3 + 2]);
+        }
+        rlEnd();
+    }
+}
+
+void StaticScene::DrawTranslucent(const Part& part) const {
+    for (int m = part.opaqueCount; m < (int)part.models.size(); m++) DrawModel(part.models[m], { 0, 0, 0 }, 1.0f, WHITE);
+}
+
+void StaticScene::Draw() const {
+    DrawPart(ground);
+    for (const BakedObject& object : objects) DrawPart(object.part);
+    DrawTranslucent(ground);
+    for (const BakedObject& object : objects) DrawTranslucent(object.part);
+}
+
+void StaticScene::Draw(const Frustum& frustum, Vector3 cameraPos, float lodDistance, CullCounter& counter) const {
+    DrawPart(ground);
+    translucentParts.clear();
+    translucentParts.push_back(&ground);
+
+    for (const BakedObject& object : objects) {
+        if (!BoxInFrustum(frustum, object.bounds)) {
+            counter.culled++;
+            continue;
+        }
+        counter.drawn++;
+
+        Vector3 center = Vector3Scale(Vector3Add(object.bounds.min, object.bounds.max), 0.5f);
+        if (Vector3Distance(center, cameraPos) < lodDistance) {
+            DrawPart(object.part);
+            if (object.part.opaqueCount < (int)object.part.models.size()) translucentParts.push_back(&object.part);
+        } else {
+            // Far away: one box the size of the building (DrawGenericBuilding level of detail)
+            Vector3 size = Vector3Subtract(object.bounds.max, object.bounds.min);
+            DrawCube(center, size.x, size.y, size.z, object.lodColor);
+            DrawCubeWires(center, size.x, size.y, size.z, DARKGRAY);
+            counter.lowDetail++;
+        }
+    }
+
+    // Translucent pass last, over everything opaque
+    for (const Part* part : translucentParts) DrawTranslucent(*part);
+}
+
+void StaticScene::Unload() {
+    for (Model& model : ground.models) UnloadModel(model);
+    for (BakedObject& object : objects) {
+        for (Model& model : object.part.models) UnloadModel(model);
+    }
+    ground = Part();
+    objects.clear();
+    lines.Clear();
+    meshCount = 0;
+    triangleCount = 0;
+    built = false;
+}
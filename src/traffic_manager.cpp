@@ -1,8 +1,10 @@
 #include "traffic_manager.h"
-#include "vehicle.h"
 #include <cmath>
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
 #include "raymath.h" 
+#include "router.h"
 
 // =============================================================================
 //  HELPER FUNCTIONS
@@ -19,9 +21,9 @@ bool TrafficManager::AreSameDirection(const Vector3& dir1, const Vector3& dir2)
 
 // Check if two vehicles are in the same PHYSICAL lane (ignoring current yielding offset)
 // This prevents oscillation (yielding -> thinking you are safe -> moving back -> yielding again)
-bool IsInSamePhysicalLane(Vehicle* a, Vehicle* b) {
-    Vector3 toB = Vector3Subtract(b->position, a->position);
-    Vector3 right = { -a->forward.z, 0, a->forward.x };
+static bool IsInSamePhysicalLane(const VehicleStore& vs, int a, int b) {
+    Vector3 toB = Vector3Subtract(vs.position[b], vs.position[a]);
+    Vector3 right = { -vs.forward[a].z, 0, vs.forward[a].x };
     float sideDist = Vector3DotProduct(toB, right);
     // Standard lane width check (approx 2.5m tolerance)
     return fabs(sideDist) < 2.5f;
@@ -29,17 +31,17 @@ bool IsInSamePhysicalLane(Vehicle* a, Vehicle* b) {
 
 // Standard Collision Check (Respects VISUAL yielding)
 // Used to decide if we need to brake or if we can pass
-bool TrafficManager::IsInMyLane(Vehicle* me, Vehicle* other) {
+bool TrafficManager::IsInMyLane(const VehicleStore& vs, int me, int other) {
     // 1. Calculate effective positions with Lateral Offset
-    Vector3 meRight = { -me->forward.z, 0, me->forward.x };
-    Vector3 otherRight = { -other->forward.z, 0, other->forward.x };
+    Vector3 meRight = { -vs.forward[me].z, 0, vs.forward[me].x };
+    Vector3 otherRight = { -vs.forward[other].z, 0, vs.forward[other].x };
 
-    Vector3 mePos = Vector3Add(me->position, Vector3Scale(meRight, me->lateralOffset));
-    Vector3 otherPos = Vector3Add(other->position, Vector3Scale(otherRight, other->lateralOffset));
+    Vector3 mePos = Vector3Add(vs.position[me], Vector3Scale(meRight, frontLateralOffset[me]));
+    Vector3 otherPos = Vector3Add(vs.position[other], Vector3Scale(otherRight, frontLateralOffset[other]));
 
     Vector3 toOther = Vector3Subtract(otherPos, mePos);
 
-    float forwardDist = Vector3DotProduct(toOther, me->forward);
+    float forwardDist = Vector3DotProduct(toOther, vs.forward[me]);
     if (forwardDist < 0) return false; // Behind us
 
     float sideDist = Vector3DotProduct(toOther, meRight);
@@ -53,7 +55,7 @@ float TrafficManager::Lerp(float start, float end, float amount) {
 }
 
 // =============================================================================
-//  SETUP & DRAWING
+//  SETUP
 // =============================================================================
 
 TrafficManager::TrafficManager(float slowDist, float detection)
@@ -65,7 +67,8 @@ void TrafficManager::AddController(int id, std::vector<int> nodeIds) {
     ctrl.id = id;
     ctrl.nodeIds = nodeIds;
     ctrl.currentState = LIGHT_GREEN; 
-    ctrl.timer = 0.0f;
+    ctrl.phaseStart = lightClock;
+    ctrl.frozenElapsed = 0.0;
     ctrl.isEmergencyOverride = false; // Initialize new flag
     
     // Default values (will be overwritten by ConfigureTrafficLight)
@@ -76,6 +79,16 @@ void TrafficManager::AddController(int id, std::vector<int> nodeIds) {
     ctrl.position = {0,0,0};
 
     controllers.push_back(ctrl);
+    int index = (int)controllers.size() - 1;
+
+    // Node -> controller lookup (a node belongs to a single controller)
+    for (int nodeId : nodeIds) {
+        if (nodeId < 0) continue;
+        if (nodeId >= (int)controllerByNode.size()) controllerByNode.resize(nodeId + 1, -1);
+        if (controllerByNode[nodeId] == -1) controllerByNode[nodeId] = index;
+    }
+    downstreamDirty = true;
+    if (lightsScheduled) ScheduleLight(index);
 }
 
 void TrafficManager::ConfigureTrafficLight(int controllerId, Vector3 position, float rotation, float startRedTime, float greenTime, float yellowTime, float redTime) {
@@ -90,364 +103,1043 @@ void TrafficManager::ConfigureTrafficLight(int controllerId, Vector3 position, f
             ctrl.durationYellow = yellowTime;
             ctrl.durationRed = redTime;
 
-            // Logic: Start Red if offset is requested
-            if (ctrl.startRedTime > 0.0f) {
-                ctrl.currentState = LIGHT_RED;
-                ctrl.durationRed = ctrl.startRedTime; 
+            // Logic: Start Red if offset is requested (only the first red lasts startRedTime)
+            ctrl.inStartDelay = ctrl.startRedTime > 0.0f;
+            ctrl.currentState = ctrl.inStartDelay ? LIGHT_RED : LIGHT_GREEN;
+            if (ctrl.plan != -1) {
+                SyncPlanLights(ctrl.plan); // The plan owns the timings
+                break;
             }
+
+            // Restart the phase with the new timings
+            ctrl.phaseStart = lightClock;
+            if (lightsScheduled) ScheduleLight((int)(&ctrl - controllers.data()));
             break;
         }
     }
 }
 
+int TrafficManager::FindController(int controllerId) const {
+    for (int c = 0; c < (int)controllers.size(); c++) {
+        if (controllers[c].id == controllerId) return c;
+    }
+    return -1;
+}
+
 // =============================================================================
-//  DRAWING LOGIC
+//  SIGNAL PLANS
 // =============================================================================
-void TrafficManager::DrawTrafficLightModel(Vector3 pos, float angleY, LightState state) {
-    rlPushMatrix();
-    
-    // 1. Move to position
-    rlTranslatef(pos.x, pos.y, pos.z);
-    
-    // 2. Rotate to face the road
-    rlRotatef(angleY, 0, 1, 0);
 
-    // --- DRAWING IN LOCAL COORDINATES ---
-    
-    float poleHeight = 6.0f;
-    float armLength = 6.5f; 
-
-    // A. The Pole
-    // Note: Chaimae offsets the pole slightly (x=1.0) so the light hangs over 0.0
-    DrawCylinder({1.0f, 0.0f, 0.0f}, 0.3f, 0.3f, poleHeight, 16, DARKGRAY);
-
-    // B. The Horizontal Arm
-    Vector3 armStart = {1.0f, poleHeight - 0.5f, 0.0f};
-    Vector3 armEnd   = {1.0f - armLength, poleHeight - 0.5f, 0.0f};
-    DrawCylinderEx(armStart, armEnd, 0.2f, 0.2f, 8, DARKGRAY);
-
-    // C. The Light Box
-    Vector3 boxPos = armEnd;
-    float w=0.6f, h=1.8f, d=0.6f;
-    Vector3 boxCenter = {boxPos.x, boxPos.y - 0.8f, boxPos.z};
-    
-    DrawCube(boxCenter, w, h, d, BLACK);
-    DrawCubeWires(boxCenter, w, h, d, DARKGRAY); 
+float SignalPlan::GetCycleLength() const {
+    float cycle = 0.0f;
+    for (const SignalStage& stage : stages) cycle += stage.green + yellow + allRed;
+    return cycle;
+}
 
-    // D. The Lights (Red/Yellow/Green)
-    float zFace = boxCenter.z + (d/2) + 0.05f; 
+bool SignalPlan::Conflicts(int controllerA, int controllerB) const {
+    int n = (int)controllerIds.size();
+    int a = (int)(std::find(controllerIds.begin(), controllerIds.end(), controllerA) - controllerIds.begin());
+    int b = (int)(std::find(controllerIds.begin(), controllerIds.end(), controllerB) - controllerIds.begin());
+    if (a == n || b == n) return false;
+    return conflicts[a * n + b] != 0;
+}
 
-    // Colors: Dim if off, Bright if on
-    Color cRed    = (state == LIGHT_RED)    ? RED    : (Color){50, 0, 0, 255};   
-    Color cYellow = (state == LIGHT_YELLOW) ? ORANGE : (Color){50, 40, 0, 255};
-    Color cGreen  = (state == LIGHT_GREEN)  ? GREEN  : (Color){0, 50, 0, 255}; 
+bool SignalPlan::GetGreenWindow(int controllerId, float& greenStart, float& greenTime) const {
+    float stageStart = 0.0f;
+    bool found = false;
+    for (const SignalStage& stage : stages) {
+        bool served = std::find(stage.controllerIds.begin(), stage.controllerIds.end(), controllerId) != stage.controllerIds.end();
+        if (served && !found) {
+            found = true;
+            greenStart = stageStart;
+        }
+        if (found) {
+            if (!served) break; // End of the run
+            // Carried over into the next stage: no yellow/all-red in between
+            greenTime = stageStart + stage.green - greenStart;
+        }
+        stageStart += stage.green + yellow + allRed;
+    }
+    // A run that ends with the last stage never wraps into the first one (simpler to reason about)
+    return found;
+}
 
-    DrawSphere({boxCenter.x, boxCenter.y + 0.5f, zFace}, 0.22f, cRed);    // Top
-    DrawSphere({boxCenter.x, boxCenter.y,        zFace}, 0.22f, cYellow); // Middle
-    DrawSphere({boxCenter.x, boxCenter.y - 0.5f, zFace}, 0.22f, cGreen);  // Bottom
-    
-    rlPopMatrix();
+SignalPlan* TrafficManager::FindPlan(int planId) {
+    for (auto& plan : plans) {
+        if (plan.id == planId) return &plan;
+    }
+    return nullptr;
+}
+
+const SignalPlan* TrafficManager::GetSignalPlan(int planId) const {
+    for (const auto& plan : plans) {
+        if (plan.id == planId) return &plan;
+    }
+    return nullptr;
+}
+
+void TrafficManager::AddSignalPlan(int planId, std::vector<int> controllerIds, float yellow, float allRed) {
+    SignalPlan plan;
+    plan.id = planId;
+    plan.controllerIds = controllerIds;
+    plan.conflicts.assign(controllerIds.size() * controllerIds.size(), 0);
+    plan.yellow = yellow;
+    plan.allRed = allRed;
+    for (int id : controllerIds) plan.controllerIndex.push_back(FindController(id));
+    plans.push_back(plan);
+
+    int planIndex = (int)plans.size() - 1;
+    for (int c : plans.back().controllerIndex) {
+        if (c != -1) controllers[c].plan = planIndex;
+    }
+}
+
+void TrafficManager::SetConflict(int planId, int controllerA, int controllerB) {
+    SignalPlan* plan = FindPlan(planId);
+    if (!plan) return;
+    int n = (int)plan->controllerIds.size();
+    int a = (int)(std::find(plan->controllerIds.begin(), plan->controllerIds.end(), controllerA) - plan->controllerIds.begin());
+    int b = (int)(std::find(plan->controllerIds.begin(), plan->controllerIds.end(), controllerB) - plan->controllerIds.begin());
+    if (a == n || b == n) return;
+    plan->conflicts[a * n + b] = 1;
+    plan->conflicts[b * n + a] = 1;
+}
+
+bool TrafficManager::AddStage(int planId, std::vector<int> controllerIds, float green) {
+    SignalPlan* plan = FindPlan(planId);
+    if (!plan || green <= 0.0f) return false;
+
+    // Never two conflicting movements green together
+    for (size_t a = 0; a < controllerIds.size(); a++) {
+        for (size_t b = a + 1; b < controllerIds.size(); b++) {
+            if (plan->Conflicts(controllerIds[a], controllerIds[b])) return false;
+        }
+    }
+    plan->stages.push_back({ controllerIds, green });
+    SyncPlanLights((int)(plan - plans.data()));
+    return true;
+}
+
+void TrafficManager::SetPlanOffset(int planId, float offset) {
+    SignalPlan* plan = FindPlan(planId);
+    if (!plan) return;
+    float cycle = plan->GetCycleLength();
+    plan->offset = cycle > 0.0f ? fmodf(fmodf(offset, cycle) + cycle, cycle) : offset;
+    SyncPlanLights((int)(plan - plans.data()));
 }
 
-void TrafficManager::Draw() {
-    for (const auto& ctrl : controllers) {
-        DrawTrafficLightModel(ctrl.position, ctrl.rotation, ctrl.currentState);
+void TrafficManager::SyncPlanLights(int planIndex) {
+    if (controlMode != SIGNAL_FIXED_TIME) {
+        ResetActuatedPlan(planIndex);
+        return;
     }
+    const SignalPlan& plan = plans[planIndex];
+    float cycle = plan.GetCycleLength();
+    if (cycle <= 0.0f) return;
+
+    for (int id : plan.controllerIds) {
+        int c = FindController(id);
+        if (c == -1) continue;
+        TrafficController& ctrl = controllers[c];
+        if (ctrl.isEmergencyOverride) continue; // Synced when released
+        ctrl.inStartDelay = false;
+
+        float greenStart = 0.0f, greenTime = 0.0f;
+        if (!plan.GetGreenWindow(id, greenStart, greenTime)) {
+            // Not served by any stage (yet): red for the whole cycle
+            greenTime = 0.0f;
+        }
+        ctrl.durationGreen = greenTime;
+        ctrl.durationYellow = greenTime > 0.0f ? plan.yellow : 0.0f;
+        ctrl.durationRed = cycle - ctrl.durationGreen - ctrl.durationYellow;
+
+        // Where are we in this group's cycle (0 = start of its green)?
+        // The plan starts at its offset: red until the first green
+        double t = fmod(lightClock - plan.offset - greenStart, (double)cycle);
+        if (t < 0.0) t += cycle;
+        if (lightClock < plan.offset + greenStart) {
+            ctrl.currentState = LIGHT_RED;
+            ctrl.inStartDelay = true;
+            ctrl.startRedTime = (float)(plan.offset + greenStart - lightClock);
+            ctrl.phaseStart = lightClock;
+        }
+        else if (t < ctrl.durationGreen) {
+            ctrl.currentState = LIGHT_GREEN;
+            ctrl.phaseStart = lightClock - t;
+        }
+        else if (t < ctrl.durationGreen + ctrl.durationYellow) {
+            ctrl.currentState = LIGHT_YELLOW;
+            ctrl.phaseStart = lightClock - (t - ctrl.durationGreen);
+        }
+        else {
+            ctrl.currentState = LIGHT_RED;
+            ctrl.phaseStart = lightClock - (t - ctrl.durationGreen - ctrl.durationYellow);
+        }
+        if (lightsScheduled) ScheduleLight(c);
+    }
+    nodeLightsDirty = true;
+}
+
+// Length of the shortest drive from one node to another (Dijkstra on the node graph), -1 if unreachable
+static float GetPathLength(const RoadGraph& map, int fromId, int toId) {
+    typedef std::pair<float, int> Entry; // (distance, node id)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::unordered_map<int, float> best;
+    open.push({ 0.0f, fromId });
+    best[fromId] = 0.0f;
+
+    while (!open.empty()) {
+        Entry top = open.top();
+        open.pop();
+        if (top.second == toId) return top.first;
+        if (top.first > best[top.second]) continue;
+
+        const Node& node = map.GetNode(top.second);
+        if (node.type == TELEPORT && node.teleportTargetId != -1) {
+            // Jump is instant
+            auto it = best.find(node.teleportTargetId);
+            if (it == best.end() || top.first < it->second) {
+                best[node.teleportTargetId] = top.first;
+                open.push({ top.first, node.teleportTargetId });
+            }
+        }
+        for (int nextId : node.nextNodes) {
+            const Node& next = map.GetNode(nextId);
+            if (!next.IsValid()) continue;
+            float d = top.first + Vector3Distance(node.pos, next.pos);
+            auto it = best.find(nextId);
+            if (it == best.end() || d < it->second) {
+                best[nextId] = d;
+                open.push({ d, nextId });
+            }
+        }
+    }
+    return -1.0f;
+}
+
+bool TrafficManager::SolveGreenWave(const RoadGraph& map, const std::vector<int>& corridorNodes, float progressionSpeed, int referenceIndex) {
+    int count = (int)corridorNodes.size();
+    if (count < 2 || progressionSpeed <= 0.0f || referenceIndex < 0 || referenceIndex >= count) return false;
+
+    // 1. Controller, plan and travel time (from the first stop line) of every corridor node
+    std::vector<int> ctrlIds(count), planIndex(count);
+    std::vector<float> arrival(count, 0.0f);
+    float cycle = -1.0f;
+    for (int k = 0; k < count; k++) {
+        int c = GetControllerForNode(corridorNodes[k]);
+        if (c == -1 || controllers[c].plan == -1) return false;
+        ctrlIds[k] = controllers[c].id;
+        planIndex[k] = controllers[c].plan;
+
+        float planCycle = plans[planIndex[k]].GetCycleLength();
+        if (cycle < 0.0f) cycle = planCycle;
+        if (fabsf(planCycle - cycle) > 0.001f || cycle <= 0.0f) return false; // Needs a common cycle
+
+        if (k > 0) {
+            float length = GetPathLength(map, corridorNodes[k - 1], corridorNodes[k]);
+            if (length < 0.0f) return false;
+            arrival[k] = arrival[k - 1] + length / progressionSpeed;
+        }
+    }
+
+    // 2. Green of node k starts when the platoon gets there: the reference plan stays,
+    //    every other plan is shifted (once, first corridor node of that plan wins)
+    float refStart = 0.0f, refGreen = 0.0f;
+    const SignalPlan& refPlan = plans[planIndex[referenceIndex]];
+    if (!refPlan.GetGreenWindow(ctrlIds[referenceIndex], refStart, refGreen)) return false;
+    double refGreenAt = refPlan.offset + refStart;
+
+    std::vector<unsigned char> shifted(plans.size(), 0);
+    shifted[planIndex[referenceIndex]] = 1;
+    for (int k = 0; k < count; k++) {
+        int p = planIndex[k];
+        if (shifted[p]) continue;
+        shifted[p] = 1;
+
+        float greenStart = 0.0f, greenTime = 0.0f;
+        if (!plans[p].GetGreenWindow(ctrlIds[k], greenStart, greenTime)) return false;
+        double greenAt = refGreenAt + (arrival[k] - arrival[referenceIndex]);
+        SetPlanOffset(plans[p].id, (float)(greenAt - greenStart));
+    }
+    return true;
 }
 
 // =============================================================================
 //  UPDATE LIGHTS
 // =============================================================================
-void TrafficManager::UpdateLights(float dt, RoadGraph& map, const std::vector<std::unique_ptr<Vehicle>>& vehicles) {
-    
-    // 1. Reset overrides first (assume normal operation)
-    for (auto& ctrl : controllers) ctrl.isEmergencyOverride = false;
+float TrafficManager::GetPhaseDuration(const TrafficController& ctrl) const {
+    switch (ctrl.currentState) {
+        case LIGHT_GREEN:  return ctrl.durationGreen;
+        case LIGHT_YELLOW: return ctrl.durationYellow;
+        case LIGHT_RED:    return ctrl.inStartDelay ? ctrl.startRedTime : ctrl.durationRed;
+        default:           return 0.0f;
+    }
+}
+
+void TrafficManager::ScheduleLight(int index) {
+    TrafficController& ctrl = controllers[index];
+    ctrl.eventGeneration++; // Cancels whatever was pending
+    if (IsActuated(ctrl)) return; // Driven by UpdateActuatedPlan, not by events
+    lightEvents.push({ ctrl.phaseStart + GetPhaseDuration(ctrl), index, ctrl.eventGeneration });
+}
 
-    // 2. Check for active emergency vehicles
-    Vehicle* emergencyVehicle = nullptr;
-    for(const auto& v : vehicles) {
-        if(v->IsEmergency() && !v->finished) {
-            emergencyVehicle = v.get();
-            break; // Found one, prioritize it
+void TrafficManager::ApplyLightState(int index, RoadGraph& map) {
+    const TrafficController& ctrl = controllers[index];
+    for (int nodeId : ctrl.nodeIds) {
+        Node* node = map.FindNode(nodeId);
+        if (node) node->lightState = ctrl.currentState;
+    }
+}
+
+void TrafficManager::SyncNodeLights(RoadGraph& map) {
+    for (int c = 0; c < (int)controllers.size(); c++) ApplyLightState(c, map);
+    downstreamDirty = true; // Called after the graph was rebuilt
+}
+
+void TrafficManager::StartLightScheduler(RoadGraph& map) {
+    while (!lightEvents.empty()) lightEvents.pop();
+    for (int c = 0; c < (int)controllers.size(); c++) ScheduleLight(c);
+    SyncNodeLights(map);
+    lightsScheduled = true;
+}
+
+void TrafficManager::UpdateLights(float dt, RoadGraph& map, const VehicleStore& vehicles) {
+    if (!lightsScheduled) StartLightScheduler(map);
+    if (nodeLightsDirty) {
+        SyncNodeLights(map); // A plan was changed since the last tick
+        nodeLightsDirty = false;
+    }
+
+    double tickStart = lightClock;
+    lightClock += dt;
+
+    // 0. Queues, arrivals and delay per approach (drives the actuated modes, feeds the stats)
+    if (MeasuresApproaches()) MeasureApproaches(dt, map, vehicles);
+
+    // 1. Emergency overrides: freeze the phase of the lights near an emergency vehicle
+    //    (skipped entirely when there is none on the map)
+    int emergencyVehicle = -1;
+    if (vehicles.GetEmergencyCount() > 0) {
+        for (int v = 0; v < vehicles.Size(); v++) {
+            if (vehicles.IsEmergency(v) && !vehicles.finished[v]) {
+                emergencyVehicle = v;
+                break; // Found one, prioritize it
+            }
         }
     }
 
-    // 3. Logic loop
-    for (auto& ctrl : controllers) {
-        
-        // --- A. Emergency Logic ---
-        if (emergencyVehicle != nullptr) {
-            // Check if controller is relevant (within 60m of emergency vehicle)
-            if (GetDistance(ctrl.position, emergencyVehicle->position) < 120.0f) {
-                
+    if (emergencyVehicle != -1 || overriddenCount > 0) {
+        for (int c = 0; c < (int)controllers.size(); c++) {
+            TrafficController& ctrl = controllers[c];
+            bool wasOverridden = ctrl.isEmergencyOverride;
+            bool overridden = false;
+            LightState forced = ctrl.currentState;
+
+            // Check if controller is relevant (within 120m of emergency vehicle)
+            if (emergencyVehicle != -1 && GetDistance(ctrl.position, vehicles.position[emergencyVehicle]) < 120.0f) {
                 // Determine Axis (X or Z)
-                bool isZAxis = fabs(emergencyVehicle->forward.z) > fabs(emergencyVehicle->forward.x);
-                
-                // Is this controller managing Z roads?
-                bool ctrlIsZ = (fabs(ctrl.position.z) > 20.0f); // 34.0f vs 10.5f check
-
-                // Only override if this light controls the ambulance's path
-                if (isZAxis == ctrlIsZ) {
-                     ctrl.isEmergencyOverride = true; 
-                     ctrl.currentState = LIGHT_GREEN; // FORCE GREEN
-                } 
+                Vector3 evForward = vehicles.forward[emergencyVehicle];
+                bool isZAxis = fabs(evForward.z) > fabs(evForward.x);
+
+                // Is this controller managing Z roads? (a light faces its traffic: rotation 0/180 = along Z)
+                float facing = ctrl.rotation * DEG2RAD;
+                bool ctrlIsZ = fabsf(cosf(facing)) > fabsf(sinf(facing));
+
+                // Only GREEN if this light controls the ambulance's path, RED for cross traffic
+                overridden = true;
+                forced = (isZAxis == ctrlIsZ) ? LIGHT_GREEN : LIGHT_RED;
+            }
+
+            if (overridden && !wasOverridden) {
+                // Freeze: remember how far into the phase we were, drop the pending event
+                ctrl.frozenElapsed = tickStart - ctrl.phaseStart;
+                ctrl.eventGeneration++;
+                overriddenCount++;
+            }
+            else if (!overridden && wasOverridden) {
+                overriddenCount--;
+                ctrl.isEmergencyOverride = false;
+                if (IsActuated(ctrl)) {
+                    // UpdateActuatedPlan below sets it back with the rest of its plan
+                }
+                else if (ctrl.plan != -1) {
+                    // Back in step with the rest of the intersection
+                    SyncPlanLights(ctrl.plan);
+                    ApplyLightState(c, map);
+                }
                 else {
-                    // Force RED for cross traffic
-                    ctrl.isEmergencyOverride = true; 
-                    ctrl.currentState = LIGHT_RED; 
+                    // Resume where the phase was frozen (in whatever state the override left)
+                    ctrl.phaseStart = tickStart - ctrl.frozenElapsed;
+                    ScheduleLight(c);
                 }
             }
+            ctrl.isEmergencyOverride = overridden;
+
+            if (overridden && forced != ctrl.currentState) {
+                ctrl.currentState = forced;
+                ApplyLightState(c, map);
+            }
         }
+    }
+
+    // 2. Phase changes due this tick (popped first so each light changes at most once per tick)
+    dueEvents.clear();
+    while (!lightEvents.empty() && lightEvents.top().time <= lightClock) {
+        dueEvents.push_back(lightEvents.top());
+        lightEvents.pop();
+    }
 
-        // --- B. Standard Timer Logic (Only if not overridden) ---
-        if (!ctrl.isEmergencyOverride) {
-            ctrl.timer += dt;
+    for (const LightEvent& ev : dueEvents) {
+        TrafficController& ctrl = controllers[ev.controller];
+        if (ev.generation != ctrl.eventGeneration) continue; // Cancelled (override, reconfigure)
 
+        // Zero-length phases are skipped (e.g. a plan group no stage serves: never green)
+        int guard = 0;
+        do {
             switch (ctrl.currentState) {
                 case LIGHT_GREEN:
-                    if (ctrl.timer >= ctrl.durationGreen) {
-                        ctrl.currentState = LIGHT_YELLOW;
-                        ctrl.timer = 0.0f;
-                    }
+                    ctrl.currentState = LIGHT_YELLOW;
                     break;
                 case LIGHT_YELLOW:
-                    if (ctrl.timer >= ctrl.durationYellow) {
-                        ctrl.currentState = LIGHT_RED;
-                        ctrl.timer = 0.0f;
-                        ctrl.durationRed = 15.0f; 
-                    }
+                    ctrl.currentState = LIGHT_RED;
                     break;
                 case LIGHT_RED:
-                    if (ctrl.timer >= ctrl.durationRed) {
-                        ctrl.currentState = LIGHT_GREEN;
-                        ctrl.timer = 0.0f;
-                        ctrl.durationGreen = 15.0f; 
-                    }
+                    ctrl.currentState = LIGHT_GREEN;
+                    ctrl.inStartDelay = false;
                     break;
                 default: break;
             }
+        } while (GetPhaseDuration(ctrl) <= 0.0f && ++guard < 3);
+        // From the due time, not the tick: phases do not drift by a step per change
+        // and plan-driven groups stay locked to their cycle
+        ctrl.phaseStart = ev.time;
+        ScheduleLight(ev.controller);
+        ApplyLightState(ev.controller, map);
+    }
+
+    // 3. Actuated / max-pressure plans decide every tick from the measurements
+    if (controlMode != SIGNAL_FIXED_TIME) {
+        for (int p = 0; p < (int)plans.size(); p++) UpdateActuatedPlan(p, map);
+    }
+}
+
+// =============================================================================
+//  APPROACH MEASUREMENTS
+// =============================================================================
+
+void TrafficManager::ResetApproachStats() {
+    for (auto& ctrl : controllers) {
+        ctrl.stats.served = 0;
+        ctrl.stats.totalDelay = 0.0;
+    }
+}
+
+void TrafficManager::SetApproachStats(bool enabled) {
+    if (enabled == approachStats) return;
+    if (!MeasuresApproaches()) lastTarget.clear(); // Targets moved while nobody looked
+    approachStats = enabled;
+}
+
+void TrafficManager::MeasureApproaches(float dt, const RoadGraph& map, const VehicleStore& vehicles) {
+    int count = vehicles.Size();
+    int ctrlCount = (int)controllers.size();
+    if (ctrlCount == 0) return;
+
+    // Nodes right after each stop line (max-pressure "downstream" load)
+    if (downstreamDirty) {
+        downstreamByNode.clear();
+        for (int c = 0; c < ctrlCount; c++) {
+            for (int nodeId : controllers[c].nodeIds) {
+                const Node* node = map.FindNode(nodeId);
+                if (!node) continue;
+                for (int nextId : node->nextNodes) {
+                    if (nextId < 0) continue;
+                    if (nextId >= (int)downstreamByNode.size()) downstreamByNode.resize(nextId + 1, -1);
+                    downstreamByNode[nextId] = c;
+                }
+            }
+        }
+        downstreamDirty = false;
+    }
+
+    // The store was cleared (or shrank): forget who was heading where
+    if (count < (int)lastTarget.size()) lastTarget.clear();
+    lastTarget.resize(count, -1);
+    arrivals.assign(ctrlCount, 0);
+    for (auto& ctrl : controllers) {
+        ctrl.stats.approaching = 0;
+        ctrl.stats.detected = 0;
+        ctrl.stats.queued = 0;
+        ctrl.stats.downstream = 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (vehicles.finished[i]) {
+            lastTarget[i] = -1; // The slot's next vehicle starts fresh
+            continue;
+        }
+        int target = vehicles.targetNodeId[i];
+
+        // Target changed: left one approach (served) and/or joined another
+        if (lastTarget[i] != target) {
+            int from = GetControllerForNode(lastTarget[i]);
+            if (from != -1) controllers[from].stats.served++;
+            int to = GetControllerForNode(target);
+            if (to != -1) arrivals[to]++;
+            lastTarget[i] = target;
         }
 
-        // --- C. Apply State to Nodes ---
-        for (int nodeId : ctrl.nodeIds) {
-            try {
-                Node& node = map.GetNode(nodeId);
-                node.lightState = ctrl.currentState;
-            } catch (...) {}
+        int c = GetControllerForNode(target);
+        if (c == -1) {
+            int d = (target >= 0 && target < (int)downstreamByNode.size()) ? downstreamByNode[target] : -1;
+            if (d != -1) controllers[d].stats.downstream++;
+            continue;
         }
+
+        TrafficController& ctrl = controllers[c];
+        ctrl.stats.approaching++;
+        const Node* stopNode = map.FindNode(target);
+        if (stopNode && GetDistance(vehicles.position[i], stopNode->pos) < detectorDistance) {
+            ctrl.stats.detected++;
+            ctrl.lastDetection = lightClock;
+            if (vehicles.speed[i] < 1.0f) ctrl.stats.queued++;
+        }
+
+        // Delay: the fraction of free-flow speed lost, integrated over time
+        float desired = vehicles.desiredSpeed[i];
+        if (desired > 0.0f) ctrl.stats.totalDelay += dt * std::max(0.0f, 1.0f - vehicles.speed[i] / desired);
+    }
+
+    float blend = std::min(1.0f, dt / 10.0f);
+    for (int c = 0; c < ctrlCount; c++) {
+        float rate = dt > 0.0f ? arrivals[c] / dt : 0.0f;
+        controllers[c].stats.arrivalRate += (rate - controllers[c].stats.arrivalRate) * blend;
     }
 }
 
 // =============================================================================
-//  UPDATE VEHICLES  and YIELDING Logic
+//  ACTUATED / MAX-PRESSURE CONTROL
 // =============================================================================
 
-void TrafficManager::UpdateVehicles(std::vector<std::unique_ptr<Vehicle>>& vehicles, const RoadGraph& map) {
-    float dt = GetFrameTime();
+void TrafficManager::SetControlMode(SignalControlMode mode) {
+    if (mode == controlMode) return;
+    if (!MeasuresApproaches()) lastTarget.clear(); // Targets moved while nobody looked
+    controlMode = mode;
+    // Fixed time: back on the planned cycle (events). Otherwise: the plan machines take over.
+    for (int p = 0; p < (int)plans.size(); p++) SyncPlanLights(p);
+    nodeLightsDirty = true;
+}
 
-    // 1. Identify active emergency vehicles
-    std::vector<Vehicle*> emergencyVehicles;
-    for(const auto& v : vehicles) {
-        if(v->IsEmergency() && !v->finished) {
-            emergencyVehicles.push_back(v.get());
+void TrafficManager::SetActuatedTimings(float minGreen, float maxGreen, float gap, float detectorDist) {
+    actuatedMinGreen = minGreen;
+    actuatedMaxGreen = std::max(minGreen, maxGreen);
+    actuatedGap = gap;
+    detectorDistance = detectorDist;
+}
+
+void TrafficManager::ResetActuatedPlan(int planIndex) {
+    SignalPlan& plan = plans[planIndex];
+    // Start with the clearance: the first green goes to whoever has demand
+    plan.activeStage = 0;
+    plan.stageState = LIGHT_RED;
+    plan.stageStart = lightClock;
+    for (int c : plan.controllerIndex) {
+        if (c == -1 || controllers[c].isEmergencyOverride) continue;
+        controllers[c].eventGeneration++; // Drop the fixed-time event, if any
+        controllers[c].currentState = LIGHT_RED;
+        controllers[c].inStartDelay = false;
+        controllers[c].phaseStart = lightClock;
+    }
+    nodeLightsDirty = true;
+}
+
+int TrafficManager::GetStageDemand(const SignalPlan& plan, int stage) const {
+    int demand = 0;
+    for (int id : plan.stages[stage].controllerIds) {
+        int c = FindController(id);
+        if (c != -1) demand += controllers[c].stats.detected;
+    }
+    return demand;
+}
+
+int TrafficManager::GetStagePressure(const SignalPlan& plan, int stage) const {
+    int pressure = 0;
+    for (int id : plan.stages[stage].controllerIds) {
+        int c = FindController(id);
+        if (c != -1) pressure += controllers[c].stats.approaching - controllers[c].stats.downstream;
+    }
+    return pressure;
+}
+
+bool TrafficManager::ShouldEndStage(const SignalPlan& plan, double elapsed) const {
+    if (elapsed < actuatedMinGreen) return false;
+
+    // A single-stage plan alternates with unsignalized cross traffic (the all-red):
+    // there is always someone else to serve
+    int stageCount = (int)plan.stages.size();
+    bool otherDemand = stageCount == 1;
+    for (int s = 0; s < stageCount && !otherDemand; s++) {
+        if (s != plan.activeStage && GetStageDemand(plan, s) > 0) otherDemand = true;
+    }
+    if (!otherDemand) return false; // Rest in green
+    if (elapsed >= actuatedMaxGreen) return true;
+
+    if (controlMode == SIGNAL_ACTUATED) {
+        // Gap-out: nobody entered the detectors for a while
+        double lastDetection = -1.0e9;
+        for (int id : plan.stages[plan.activeStage].controllerIds) {
+            int c = FindController(id);
+            if (c != -1) lastDetection = std::max(lastDetection, controllers[c].lastDetection);
         }
-    }    
-    
-    for (size_t i = 0; i < vehicles.size(); i++) {
-        Vehicle* current = vehicles[i].get();
-        if (current->finished) continue;
-
-        //=======EMERGENCY.-.YIELD.-.LOGIC._.
-        float targetLateralOffset = 0.0f;
-        // --- 1. NON-EMERGENCY VEHICLES: YIELD RIGHT ---
-        if (!current->IsEmergency()) {
-            for (Vehicle* ev : emergencyVehicles) {
-                // Check if EV is behind us AND in the same PHYSICAL lane (ignoring yield offset)
-                if (AreSameDirection(current->forward, ev->forward) && 
-                    GetDistance(current->position, ev->position) < 80.0f) 
-                {
-                    Vector3 toMe = Vector3Subtract(current->position, ev->position);
-                    if (Vector3DotProduct(ev->forward, toMe) > 0) { // We are ahead
-                        if (IsInSamePhysicalLane(ev, current)) {
-                             // Yield heavily to the RIGHT (3.5 units)
-                             targetLateralOffset = 3.5f;
-                        }
-                    }
-                }
-            }
+        return lightClock - lastDetection >= actuatedGap;
+    }
+
+    // Max-pressure: switch as soon as another stage pushes harder
+    int own = GetStagePressure(plan, plan.activeStage);
+    if (stageCount == 1) return own < 0 || GetStageDemand(plan, plan.activeStage) == 0; // Exit backing up, or served everyone
+    for (int s = 0; s < stageCount; s++) {
+        if (s != plan.activeStage && GetStagePressure(plan, s) > own) return true;
+    }
+    return false;
+}
+
+int TrafficManager::PickNextStage(const SignalPlan& plan) const {
+    int stageCount = (int)plan.stages.size();
+    int best = -1;
+    int bestPressure = 0;
+    for (int k = 1; k <= stageCount; k++) {
+        int s = (plan.activeStage + k) % stageCount; // In plan order, after the one that just ended
+        if (GetStageDemand(plan, s) == 0) continue; // Skipped: nobody waiting
+        if (controlMode == SIGNAL_ACTUATED) return s;
+
+        int pressure = GetStagePressure(plan, s);
+        if (best == -1 || pressure > bestPressure) {
+            best = s;
+            bestPressure = pressure;
         }
-        // --- 2. EMERGENCY VEHICLES: YIELD LEFT (IF BLOCKED) ---
-        else {
-            // Check if there is a car directly ahead of us that hasn't fully cleared yet
-            bool isBlockedAhead = false;
-            for (const auto& other : vehicles) {
-                if (other.get() == current || other->finished) continue;
-                
-                if (AreSameDirection(current->forward, other->forward) &&
-                    GetDistance(current->position, other->position) < 40.0f) 
-                {
-                    Vector3 toOther = Vector3Subtract(other->position, current->position);
-                    if (Vector3DotProduct(current->forward, toOther) > 0) { // It is ahead
-                         // Check if it's blocking our path (using current visual positions)
-                         if (IsInMyLane(current, other.get())) {
-                             isBlockedAhead = true;
-                             break;
-                         }
-                    }
-                }
-            }
+    }
+    return best; // -1 = rest in all-red until someone shows up
+}
+
+void TrafficManager::UpdateActuatedPlan(int planIndex, RoadGraph& map) {
+    SignalPlan& plan = plans[planIndex];
+    if (plan.stages.empty()) return;
+    double elapsed = lightClock - plan.stageStart;
 
-            if (isBlockedAhead) {
-                // If blocked (Road Full/Red Light jam), move LEFT to create a middle lane
-                targetLateralOffset = -2.0f;
-            } else {
-                // If right line is free (Cars moved out of way), pass NORMAL (Center)
-                targetLateralOffset = 0.0f;
+    switch (plan.stageState) {
+        case LIGHT_GREEN:
+            if (ShouldEndStage(plan, elapsed)) {
+                plan.stageState = LIGHT_YELLOW;
+                plan.stageStart = lightClock;
+            }
+            break;
+        case LIGHT_YELLOW:
+            if (elapsed >= plan.yellow) {
+                plan.stageState = LIGHT_RED;
+                plan.stageStart = lightClock;
             }
+            break;
+        default: {
+            if (elapsed < plan.allRed) break;
+            int next = PickNextStage(plan);
+            if (next != -1) {
+                plan.activeStage = next;
+                plan.stageState = LIGHT_GREEN;
+                plan.stageStart = lightClock;
+            }
+            break;
         }
+    }
 
-        // Smoothly apply the offset
-        current->lateralOffset = Lerp(current->lateralOffset, targetLateralOffset, 3.0f * dt);
-        //===============================================
-        if (current->forceMoveTimer > 0.0f) current->forceMoveTimer -= dt;
-        
-        float targetSpeed = current->desiredSpeed;
-        bool emergencyStop = false; 
-        bool redLightStop = false;
-
-        // --- 1. TRAFFIC LIGHT LOGIC ---
-        for (const auto& ctrl : controllers) {
-            bool isManagedNode = false;
-            for (int nodeId : ctrl.nodeIds) {
-                if (current->targetNodeId == nodeId) {
-                    isManagedNode = true;
-                    break;
+    // Groups of the running stage follow it, everyone else is red
+    const SignalStage& stage = plan.stages[plan.activeStage];
+    for (size_t g = 0; g < plan.controllerIds.size(); g++) {
+        int c = plan.controllerIndex[g];
+        if (c == -1) continue;
+        TrafficController& ctrl = controllers[c];
+        if (ctrl.isEmergencyOverride) continue;
+
+        bool inStage = std::find(stage.controllerIds.begin(), stage.controllerIds.end(), plan.controllerIds[g]) != stage.controllerIds.end();
+        LightState state = (inStage && plan.stageState != LIGHT_RED) ? plan.stageState : LIGHT_RED;
+        if (state != ctrl.currentState) {
+            ctrl.currentState = state;
+            ctrl.phaseStart = lightClock;
+            ApplyLightState(c, map);
+        }
+    }
+}
+
+// =============================================================================
+//  UPDATE VEHICLES  and YIELDING Logic
+// =============================================================================
+
+void TrafficManager::UpdateVehicles(float dt, VehicleStore& vehicles, const RoadGraph& map, WorkerPool* pool, const Router* router) {
+    int count = vehicles.Size();
+    laneRouter = router;
+    int threadCount = pool ? pool->GetThreadCount() : 1;
+    if ((int)workerScratch.size() < threadCount) workerScratch.resize(threadCount);
+    std::vector<int>& neighbors = workerScratch[0].neighbors;
+
+    // 0. Index everyone once: roads for the leaders, grid for the other neighbor checks
+    grid.Build(vehicles);
+    BuildLanes(vehicles, map);
+
+    // Snapshot of the state other vehicles read (front buffer). Each vehicle then only
+    // writes its own speed/offset, so the order (and thread count) does not change the result.
+    frontSpeed = vehicles.speed;
+    frontLateralOffset = vehicles.lateralOffset;
+
+    // 1. Identify active emergency vehicles and mark the cars they are catching up with
+    yieldRight.assign(count, 0);
+    for (int ev = 0; ev < count; ev++) {
+        if (!vehicles.IsEmergency(ev) || vehicles.finished[ev]) continue;
+
+        grid.Query(vehicles.position[ev], 80.0f, neighbors);
+        for (int idx : neighbors) {
+            if (vehicles.IsEmergency(idx)) continue;
+
+            // Check if EV is behind us AND in the same PHYSICAL lane (ignoring yield offset)
+            if (AreSameDirection(vehicles.forward[idx], vehicles.forward[ev]) && 
+                GetDistance(vehicles.position[idx], vehicles.position[ev]) < 80.0f) 
+            {
+                Vector3 toMe = Vector3Subtract(vehicles.position[idx], vehicles.position[ev]);
+                if (Vector3DotProduct(vehicles.forward[ev], toMe) > 0) { // We are ahead
+                    if (IsInSamePhysicalLane(vehicles, ev, idx)) {
+                        yieldRight[idx] = 1;
+                    }
                 }
             }
+        }
+    }
+    
+    // 2. Per-vehicle perception: leader, lights, yielding (parallel)
+    followInputs.Resize(count);
+    auto updateRange = [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i++) {
+            UpdateVehicle(i, dt, vehicles, map, workerScratch[worker]);
+        }
+    };
+    if (pool) pool->ParallelFor(count, updateRange);
+    else updateRange(0, count, 0);
 
-            if (isManagedNode) {
-                // If light is RED or YELLOW...
-                if (ctrl.currentState == LIGHT_RED || ctrl.currentState == LIGHT_YELLOW) {
-                    // ...but allow emergency vehicles to run red lights!
-                    if (current->IsEmergency()) {
-                        redLightStop = false; 
-                    }else{
-                        // Standard cars stop
-                        Vector3 nodePos = {0,0,0};
-                        bool found = false;
-                        for(const auto& n : map.GetAllNodes()) {
-                            if(n.id == current->targetNodeId) {
-                                nodePos = n.pos;
-                                found = true;
-                                break;
-                            }
-                        }
+    // 3. Speeds, one batch per car-following model (no per-vehicle dispatch)
+    modelStart.assign(FOLLOW_MODEL_COUNT + 1, 0);
+    for (int i = 0; i < count; i++) {
+        if (!vehicles.finished[i]) modelStart[vehicles.followModel[i] + 1]++;
+    }
+    for (int m = 0; m < FOLLOW_MODEL_COUNT; m++) modelStart[m + 1] += modelStart[m];
+    modelVehicles.resize(modelStart[FOLLOW_MODEL_COUNT]);
+    modelCursor.assign(modelStart.begin(), modelStart.end() - 1);
+    for (int i = 0; i < count; i++) {
+        if (!vehicles.finished[i]) modelVehicles[modelCursor[vehicles.followModel[i]]++] = i;
+    }
+
+    FollowContext ctx = { dt, minSafeDist, startSlowingDist, followStep++ };
+    for (int m = 0; m < FOLLOW_MODEL_COUNT; m++) {
+        int begin = modelStart[m];
+        int size = modelStart[m + 1] - begin;
+        if (size == 0) continue;
+        FollowModelFunc model = GetFollowModelFunc((FollowModel)m);
+        auto modelRange = [&](int from, int to, int) {
+            model(&modelVehicles[begin + from], to - from, followInputs, ctx, vehicles);
+        };
+        if (pool) pool->ParallelFor(size, modelRange);
+        else modelRange(0, size, 0);
+    }
+}
 
-                        if (found) {
-                            float distToNode = GetDistance(current->position, nodePos); // Uses restored helper
+void TrafficManager::UpdateVehicle(int i, float dt, VehicleStore& vehicles, const RoadGraph& map, WorkerScratch& scratch) {
+    if (vehicles.finished[i]) return;
+    bool isEmergency = vehicles.IsEmergency(i);
 
-                            if (distToNode < startSlowingDist) {
-                                Vector3 toNode = Vector3Subtract(nodePos, current->position);
-                                if (Vector3DotProduct(current->forward, toNode) > 0) {
-                                    redLightStop = true;
-                                }
-                            }
-                        }
-                    } 
+    //=======EMERGENCY.-.YIELD.-.LOGIC._.
+    float targetLateralOffset = 0.0f;
+    // --- 1. NON-EMERGENCY VEHICLES: YIELD RIGHT ---
+    if (!isEmergency) {
+        if (yieldRight[i]) {
+            // Yield heavily to the RIGHT (3.5 units)
+            targetLateralOffset = 3.5f;
+        }
+    }
+    // --- 2. EMERGENCY VEHICLES: YIELD LEFT (IF BLOCKED) ---
+    else {
+        // Check if there is a car directly ahead of us that hasn't fully cleared yet
+        bool isBlockedAhead = false;
+        grid.Query(vehicles.position[i], 40.0f, scratch.neighbors);
+        for (int idx : scratch.neighbors) {
+            if (idx == i || vehicles.finished[idx]) continue;
+            
+            if (AreSameDirection(vehicles.forward[i], vehicles.forward[idx]) &&
+                GetDistance(vehicles.position[i], vehicles.position[idx]) < 40.0f) 
+            {
+                Vector3 toOther = Vector3Subtract(vehicles.position[idx], vehicles.position[i]);
+                if (Vector3DotProduct(vehicles.forward[i], toOther) > 0) { // It is ahead
+                     // Check if it's blocking our path (using current visual positions)
+                     if (IsInMyLane(vehicles, i, idx)) {
+                         isBlockedAhead = true;
+                         break;
+                     }
                 }
             }
         }
 
-        if (redLightStop) emergencyStop = true;
-        
-        // --- 2. COLLISION LOGIC ---
-        float closestGap = 9999.0f;
-        Vehicle* closestVehicle = nullptr;
-        bool followMode = false;
+        if (isBlockedAhead) {
+            // If blocked (Road Full/Red Light jam), move LEFT to create a middle lane
+            targetLateralOffset = -2.0f;
+        } else {
+            // If right line is free (Cars moved out of way), pass NORMAL (Center)
+            targetLateralOffset = 0.0f;
+        }
+    }
 
-        float dynamicDetectionRange = detectionRange + (current->speed * 2.0f);
-        float dynamicSlowingDist = startSlowingDist + (current->speed * 1.5f);
+    // Smoothly apply the offset
+    vehicles.lateralOffset[i] = Lerp(vehicles.lateralOffset[i], targetLateralOffset, 3.0f * dt);
+    //===============================================
+    if (vehicles.forceMoveTimer[i] > 0.0f) vehicles.forceMoveTimer[i] -= dt;
+    
+    bool emergencyStop = false; 
+    bool redLightStop = false;
+    float stopGap = NO_FOLLOW_GAP;  // Where we must stop, bumper to stop line
 
-        for (size_t j = 0; j < vehicles.size(); j++) {
-            if (i == j) continue;
-            Vehicle* other = vehicles[j].get();
-            if (other->finished) continue;
-
-            float dist = GetDistance(current->position, other->position);
-            if (dist > dynamicDetectionRange) continue;
-
-            if (AreSameDirection(current->forward, other->forward)) {
-                // Use the visual IsInMyLane (respects yielding)
-                if (IsInMyLane(current, other)) {
-                    float physicalGap = dist - (current->length/2 + other->length/2);
-                    if (physicalGap < closestGap && physicalGap > -1.0f) {
-                        closestGap = physicalGap;
-                        closestVehicle = other;
-                        followMode = true;
+    // --- 1. TRAFFIC LIGHT LOGIC ---
+    // O(1): the target node tells us which controller (if any) guards it
+    int ctrlIndex = GetControllerForNode(vehicles.targetNodeId[i]);
+    if (ctrlIndex != -1) {
+        const TrafficController& ctrl = controllers[ctrlIndex];
+
+        // If light is RED or YELLOW...
+        if (ctrl.currentState == LIGHT_RED || ctrl.currentState == LIGHT_YELLOW) {
+            // ...but allow emergency vehicles to run red lights!
+            if (isEmergency) {
+                redLightStop = false; 
+            }else{
+                // Standard cars stop
+                const Node* stopNode = map.FindNode(vehicles.targetNodeId[i]);
+
+                if (stopNode) {
+                    Vector3 nodePos = stopNode->pos;
+                    float distToNode = GetDistance(vehicles.position[i], nodePos); // Uses restored helper
+
+                    // The other models brake gently: they must see the line early enough
+                    float lookahead = startSlowingDist;
+                    if (vehicles.followModel[i] != FOLLOW_LEGACY) {
+                        const FollowParams& fp = GetVehicleTypeParams(vehicles.type[i]).follow;
+                        float v = vehicles.speed[i];
+                        lookahead = std::max(lookahead, v * v / (2.0f * fp.comfortDecel) + fp.minGap + vehicles.length[i]);
                     }
-                }
-            } else {
-                // Intersection logic
-                if (!current->IsEmergency()) {
-                    Vector3 toOther = Vector3Subtract(other->position, current->position);
-                    float fwdDist = Vector3DotProduct(toOther, current->forward);
-                    float sideDist = Vector3DotProduct(toOther, { -current->forward.z, 0, current->forward.x });
-                    if (fwdDist > 0 && fwdDist < (current->length+other->length)/2 + 3.0f && fabs(sideDist) < 2.5f) {
-                        emergencyStop = true;
+
+                    if (distToNode < lookahead) {
+                        Vector3 toNode = Vector3Subtract(nodePos, vehicles.position[i]);
+                        if (Vector3DotProduct(vehicles.forward[i], toNode) > 0) {
+                            redLightStop = true;
+                            stopGap = distToNode - vehicles.length[i] / 2;
+                        }
                     }
                 }
-            }
+            } 
         }
+    }
+
+    if (redLightStop) emergencyStop = true;
+    
+    // --- 2. COLLISION LOGIC ---
+    float closestGap = 9999.0f;
+    int closestVehicle = -1;
+    bool followMode = false;
+
+    float dynamicDetectionRange = detectionRange + (vehicles.speed[i] * 2.0f);
 
-        // --- ANGRY MODE (NUCLEAR OPTION) ---
-        if (current->forceMoveTimer > 0.0f) {
-            targetSpeed = 18.0f;     // Force high speed
-            current->speed = 18.0f;  // Force physics velocity immediately
-            emergencyStop = false;  // Ignore obstacles
-            followMode = false;     // Ignore lead car
+    FollowSelf self;
+    self.px = vehicles.position[i].x; self.py = vehicles.position[i].y; self.pz = vehicles.position[i].z;
+    self.fx = vehicles.forward[i].x;  self.fy = vehicles.forward[i].y;  self.fz = vehicles.forward[i].z;
+    self.lateralOffset = frontLateralOffset[i];
+    self.length = vehicles.length[i];
+    self.range = dynamicDetectionRange;
+    self.checkCrossing = !isEmergency; // Intersection logic
+
+    // On a known road the leader comes from the occupancy lists; the geometric search is
+    // then only needed for crossing traffic, right in front of us
+    bool onLane = laneSlot[i] != -1;
+    if (onLane) self.range = (self.length + MAX_VEHICLE_LENGTH) / 2 + 3.0f + 2.5f; // Crossing check reach
+
+    FollowResult lead = { -1, 9999.0f, false };
+    if (!onLane || self.checkCrossing) {
+        grid.Query(vehicles.position[i], self.range, scratch.neighbors);
+
+        // Gather the neighbors into flat arrays, then run the batched kernel over them
+        FollowCandidates& cands = scratch.candidates;
+        cands.Clear();
+        for (int j : scratch.neighbors) {
+            if (i == j) continue;
+            if (vehicles.finished[j]) continue;
+            const Vector3& p = vehicles.position[j];
+            const Vector3& f = vehicles.forward[j];
+            cands.Add(j, p.x, p.y, p.z, f.x, f.y, f.z, frontLateralOffset[j], vehicles.length[j]);
         }
+        lead = FindLeader(self, cands);
+    }
+    if (onLane) {
+        bool crossingStop = lead.crossingStop;
+        lead = FindLaneLeader(i, dynamicDetectionRange, vehicles, map);
+        lead.crossingStop = crossingStop;
+    }
 
-        else {
-            // CALM MODE
-            if (emergencyStop) {
-                targetSpeed = 0.0f;
-            }
-            else if (followMode) {
-                if (closestGap < minSafeDist) {
-                    targetSpeed = 0.0f;
-                }
-                else if (closestGap < dynamicSlowingDist) {
-                    // Using Lerp could be nice here, but keeping your original math for consistency
-                    // Or we can use the helper:
-                    // float factor = (closestGap - minSafeDist) / (dynamicSlowingDist - minSafeDist);
-                    // targetSpeed = Lerp(0.0f, current->desiredSpeed, factor);
-                    
-                    float factor = (closestGap - minSafeDist) / (dynamicSlowingDist - minSafeDist);
-                    if (closestVehicle) {
-                        targetSpeed = closestVehicle->speed + (current->desiredSpeed - closestVehicle->speed) * factor;
-                    } else {
-                        targetSpeed = current->desiredSpeed * factor;
-                    }
-                }
-            }
-            // Physics Smoothing
-            float acceleration = 10.0f;
-            float braking = 15.0f + (current->speed * 0.5f); 
+    if (lead.leader != -1) {
+        // Closest vehicle ahead in our lane (respects yielding)
+        closestGap = lead.gap;
+        closestVehicle = lead.leader;
+        followMode = true;
+    }
+    if (lead.crossingStop) {
+        emergencyStop = true;
+        stopGap = 0.0f; // Crossing vehicle right in front: stop now
+    }
 
-            if (followMode && closestGap < minSafeDist + 2.0f && current->speed > 1.0f) {
-                braking = 50.0f; 
-            }
+    // --- 3. SPEED ---
+    // What we see goes to the follow model pass (UpdateVehicles), which sets the speed
+    followInputs.gap[i] = followMode ? closestGap : NO_FOLLOW_GAP;
+    followInputs.leaderSpeed[i] = followMode ? frontSpeed[closestVehicle] : 0.0f;
+    followInputs.stopGap[i] = emergencyStop ? stopGap : NO_FOLLOW_GAP;
+    followInputs.forced[i] = vehicles.forceMoveTimer[i] > 0.0f; // ANGRY MODE (NUCLEAR OPTION): ignore obstacles
+}
 
-            if (current->speed > targetSpeed) {
-                current->speed -= braking * dt;
-                if (current->speed < targetSpeed) current->speed = targetSpeed;
-            } 
-            else {
-                current->speed += acceleration * dt;
-                if (current->speed > targetSpeed) current->speed = targetSpeed;
+// =============================================================================
+//  ROAD OCCUPANCY
+// =============================================================================
+
+void TrafficManager::BuildLanes(const VehicleStore& vehicles, const RoadGraph& map) {
+    const std::vector<Node>& nodes = map.GetAllNodes();
+    int count = vehicles.Size();
+
+    // 1. Road slots: the graph's frozen edges (nothing to rebuild unless the graph changed)
+    map.Freeze();
+    int slots = map.GetEdgeCount();
+
+    // 2. Which road each vehicle is on, and how far along it
+    laneSlot.assign(count, -1);
+    laneProgress.assign(count, 0.0f);
+    laneStart.assign(slots + 1, 0);
+    for (int i = 0; i < count; i++) {
+        int from = vehicles.finished[i] ? -1 : map.GetNodeIndex(vehicles.edgeFromId[i]);
+        if (from == -1) continue;
+        const Node& fromNode = nodes[from];
+        int branch = vehicles.edgeBranch[i];
+        if (branch < 0 || branch >= (int)fromNode.nextNodes.size()) continue;
+        if (fromNode.nextNodes[branch] != vehicles.targetNodeId[i]) continue; // Stale (forced move, ...)
+
+        int slot = map.GetEdgeBegin(from) + branch;
+        float length = map.GetEdgeLength(slot);
+        float progress = 0.0f;
+        if (length > 0.0f) {
+            Vector3 dir = Vector3Scale(Vector3Subtract(nodes[map.GetEdgeTarget(slot)].pos, fromNode.pos), 1.0f / length);
+            progress = Vector3DotProduct(Vector3Subtract(vehicles.position[i], fromNode.pos), dir);
+            progress = std::max(0.0f, std::min(length, progress));
+        }
+        laneSlot[i] = slot;
+        laneProgress[i] = progress;
+        laneStart[slot + 1]++;
+    }
+
+    // 3. Group by road (counting sort), then order each road by progress
+    for (int e = 0; e < slots; e++) laneStart[e + 1] += laneStart[e];
+    laneVehicles.assign(laneStart[slots], -1);
+    lanePos.assign(laneStart.begin(), laneStart.end() - 1); // Write cursor per road for now
+    for (int i = 0; i < count; i++) {
+        if (laneSlot[i] != -1) laneVehicles[lanePos[laneSlot[i]]++] = i;
+    }
+    for (int e = 0; e < slots; e++) {
+        auto begin = laneVehicles.begin() + laneStart[e];
+        auto end = laneVehicles.begin() + laneStart[e + 1];
+        if (end - begin < 2) continue;
+        std::sort(begin, end, [&](int a, int b) {
+            if (laneProgress[a] != laneProgress[b]) return laneProgress[a] < laneProgress[b];
+            return a < b;
+        });
+    }
+    lanePos.assign(count, -1);
+    for (int k = 0; k < (int)laneVehicles.size(); k++) lanePos[laneVehicles[k]] = k;
+}
+
+bool TrafficManager::IsPassable(int me, int other) const {
+    // Same test as the lane band of IsInMyLane, on a shared road only the yield offsets differ
+    return fabsf(frontLateralOffset[other] - frontLateralOffset[me]) >= 2.2f;
+}
+
+FollowResult TrafficManager::FindLaneLeader(int i, float range, const VehicleStore& vehicles, const RoadGraph& map) const {
+    FollowResult best = { -1, 9999.0f, false };
+    int slot = laneSlot[i];
+    if (slot == -1) return best;
+
+    // 1. Further along our own road (usually the very next entry)
+    for (int k = lanePos[i] + 1; k < laneStart[slot + 1]; k++) {
+        int j = laneVehicles[k];
+        if (IsPassable(i, j)) continue;
+        float distance = laneProgress[j] - laneProgress[i];
+        if (distance > range) break;
+        float gap = distance - (vehicles.length[i] / 2 + vehicles.length[j] / 2);
+        if (gap > -1.0f) { // Same overlap tolerance as the geometric search
+            best.leader = j;
+            best.gap = gap;
+            return best;
+        }
+    }
+
+    // 2. The roads after our target node
+    float toEnd = map.GetEdgeLength(slot) - laneProgress[i];
+    if (toEnd <= range) ScanLanesAhead(i, map.GetEdgeTarget(slot), toEnd, range, 0, 0, vehicles, map, best);
+    return best;
+}
+
+// Branch vehicle i will take at 'node', 'choicesAhead' route choices from now (same rule
+// as ChooseNextBranch). -1 when it turns randomly there: then every branch counts.
+int TrafficManager::GetPlannedBranch(int i, const Node& node, int choicesAhead, const VehicleStore& vehicles, const RoadGraph& map) const {
+    int choice;
+    if (laneRouter && vehicles.tripDestination[i] >= 0) choice = laneRouter->ChooseFastestBranch(map, node.id, vehicles.tripDestination[i]);
+    else choice = vehicles.PeekRouteChoice(i, choicesAhead);
+    return choice < (int)node.nextNodes.size() ? choice : -1;
+}
+
+// Closest blocking vehicle on the roads leaving node index 'node' ('distance' = from vehicle i to it).
+// Only the branch the vehicle will take when its trip says so, every branch for random turns.
+void TrafficManager::ScanLanesAhead(int i, int node, float distance, float range, int depth, int choicesAhead,
+                                    const VehicleStore& vehicles, const RoadGraph& map, FollowResult& best) const {
+    if (depth >= MAX_LANE_LOOKAHEAD || node < 0) return;
+
+    int first = map.GetEdgeBegin(node);
+    int last = map.GetEdgeEnd(node);
+    const Node& n = map.GetAllNodes()[node];
+    if (n.type != TELEPORT && last - first > 1) { // A choice (MakeRouteChoices stores one byte per such node)
+        int branch = GetPlannedBranch(i, n, choicesAhead, vehicles, map);
+        if (branch != -1) {
+            first += branch;
+            last = first + 1;
+        }
+        choicesAhead++;
+    }
+
+    for (int slot = first; slot < last; slot++) {
+        bool blocked = false;
+        for (int k = laneStart[slot]; k < laneStart[slot + 1]; k++) {
+            int j = laneVehicles[k];
+            if (j == i || IsPassable(i, j)) continue;
+            float total = distance + laneProgress[j];
+            if (total > range) break;
+            float gap = total - (vehicles.length[i] / 2 + vehicles.length[j] / 2);
+            if (gap <= -1.0f) continue;
+            if (gap < best.gap) {
+                best.leader = j;
+                best.gap = gap;
             }
+            blocked = true;
+            break;
         }
-        
-        if (current->speed < 0.0f) current->speed = 0.0f;
+        // Empty road: keep looking past its end
+        float next = distance + map.GetEdgeLength(slot);
+        if (!blocked && next <= range) ScanLanesAhead(i, map.GetEdgeTarget(slot), next, range, depth + 1, choicesAhead, vehicles, map, best);
     }
-}
\ No newline at end of file
+}
+
+int TrafficManager::GetLaneLeader(const VehicleStore& vehicles, const RoadGraph& map, int i) const {
+    if (i < 0 || i >= (int)laneSlot.size()) return -1;
+    return FindLaneLeader(i, detectionRange + vehicles.speed[i] * 2.0f, vehicles, map).leader;
+}
@@ -0,0 +1,83 @@
+#include "traffic_manager.h"
+#include "rlgl.h"
+
+// =============================================================================
+//  DRAWING LOGIC
+// =============================================================================
+void TrafficManager::DrawTrafficLightModel(Vector3 pos, float angleY, LightState state) {
+    rlPushMatrix();
+    
+    // 1. Move to position
+    rlTranslatef(pos.x, pos.y, pos.z);
+    
+    // 2. Rotate to face the road
+    rlRotatef(angleY, 0, 1, 0);
+
+    // --- DRAWING IN LOCAL COORDINATES ---
+    
+    float poleHeight = 6.0f;
+    float armLength = 6.5f; 
+
+    // A. The Pole
+    // Note: Chaimae offsets the pole slightly (x=1.0) so the light hangs over 0.0
+    DrawCylinder({1.0f, 0.0f, 0.0f}, 0.3f, 0.3f, poleHeight, 16, DARKGRAY);
+
+    // B. The Horizontal Arm
+    Vector3 armStart = {1.0f, poleHeight - 0.5f, 0.0f};
+    Vector3 armEnd   = {1.0f - armLength, poleHeight - 0.5f, 0.0f};
+    DrawCylinderEx(armStart, armEnd, 0.2f, 0.2f, 8, DARKGRAY);
+
+    // C. The Light Box
+    Vector3 boxPos = armEnd;
+    float w=0.6f, h=1.8f, d=0.6f;
+    Vector3 boxCenter = {boxPos.x, boxPos.y - 0.8f, boxPos.z};
+    
+    DrawCube(boxCenter, w, h, d, BLACK);
+    DrawCubeWires(boxCenter, w, h, d, DARKGRAY); 
+
+    // D. The Lights (Red/Yellow/Green)
+    float zFace = boxCenter.z + (d/2) + 0.05f; 
+
+    // Colors: Dim if off, Bright if on
+    Color cRed    = (state == LIGHT_RED)    ? RED    : (Color){50, 0, 0, 255};   
+    Color cYellow = (state == LIGHT_YELLOW) ? ORANGE : (Color){50, 40, 0, 255};
+    Color cGreen  = (state == LIGHT_GREEN)  ? GREEN  : (Color){0, 50, 0, 255}; 
+
+    DrawSphere({boxCenter.x, boxCenter.y + 0.5f, zFace}, 0.22f, cRed);    // Top
+    DrawSphere({boxCenter.x, boxCenter.y,        zFace}, 0.22f, cYellow); // Middle
+    DrawSphere({boxCenter.x, boxCenter.y - 0.5f, zFace}, 0.22f, cGreen);  // Bottom
+    
+    rlPopMatrix();
+}
+
+void TrafficManager::DrawTrafficLightSimple(Vector3 pos, float angleY, LightState state) {
+    rlPushMatrix();
+    rlTranslatef(pos.x, pos.y, pos.z);
+    rlRotatef(angleY, 0, 1, 0);
+
+    // Same footprint as the full model: pole at x=1, box hanging at the end of the arm
+    Color lit = (state == LIGHT_RED) ? RED : (state == LIGHT_YELLOW) ? ORANGE : GREEN;
+    DrawCube({1.0f, 3.0f, 0.0f}, 0.4f, 6.0f, 0.4f, DARKGRAY);
+    DrawCube({-5.5f, 4.7f, 0.0f}, 0.8f, 1.8f, 0.8f, lit);
+
+    rlPopMatrix();
+}
+
+void TrafficManager::Draw(const Frustum& frustum, Vector3 cameraPos, CullCounter& counter) {
+    for (const auto& ctrl : controllers) {
+        // Sphere around pole + arm (6.5 m arm, 6 m pole)
+        Vector3 center = { ctrl.position.x, ctrl.position.y + 3.0f, ctrl.position.z };
+        if (!SphereInFrustum(frustum, center, 7.5f)) {
+            counter.culled++;
+            continue;
+        }
+        counter.drawn++;
+
+        if (Vector3Distance(center, cameraPos) < CONFIG::LOD_LIGHT_DISTANCE) {
+            DrawTrafficLightModel(ctrl.position, ctrl.rotation, ctrl.currentState);
+        } else {
+            DrawTrafficLightSimple(ctrl.position, ctrl.rotation, ctrl.currentState);
+            counter.lowDetail++;
+        }
+    }
+}
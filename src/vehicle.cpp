@@ -1,457 +1,396 @@
 #include "vehicle.h"
-#include "rlgl.h"
+#include "sim_random.h"
+#include "router.h"
 #include "raymath.h" // Important pour Vector3Normalize, etc.
 
-// Initialize static member
-ModelManager* Vehicle::modelManager = nullptr;
-
 // =============================================================================
-//  VEHICLE BASE CLASS
+//  PER-TYPE PARAMETER TABLE
 // =============================================================================
 
-Vehicle::Vehicle(Vector3 pos, int initialTargetId) 
-    : position(pos), 
-      forward({1,0,0}), 
-      speed(5.0f), 
-      desiredSpeed(5.0f), 
-      length(4.0f), 
-      targetNodeId(initialTargetId), 
-      color(RED),
-      originalColor(RED),
-      forceMoveTimer(0.0f)
-      {}
-
-Vehicle::~Vehicle() {}
-
-// MISE À JOUR : Utilise RoadGraph au lieu de std::vector<Node>
-void Vehicle::update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>>& allVehicles) {
-
-    // 1. Récupération sécurisée du noeud cible via la classe RoadGraph
-    Node &targetNode = graph.GetNode(targetNodeId);
-    Vector3 targetPos = targetNode.pos;
-    
-    // 2. Calcul de la direction et distance
-    Vector3 dir = { targetPos.x - position.x, targetPos.y - position.y, targetPos.z - position.z };
-    float dist = sqrtf(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
-    
-    // 3. LOGIQUE D'ARRIVÉE
-    if (dist < CONFIG::ARRIVAL_THRESHOLD) { // Threshold for "reaching" the node
-        
-        // TYPE A: TELEPORTATION
-        if (targetNode.type == TELEPORT) {
-            int startNodeId = targetNode.teleportTargetId;
-            Node &destinationNode = graph.GetNode(startNodeId);
-
-            // --- 1. CHECK IF LANDING ZONE IS CLEAR ---
-            bool isBlocked = false;
-
-            
-            
-            // Scan all vehicles to see if anyone is at the destination
-            for (const auto& other : allVehicles) {
-                // Don't check against self
-                if (other.get() == this) continue; 
-
-                // Check distance to the destination node
-                // 8.0f is a safe gap to ensure we don't spawn inside them
-                if (Vector3Distance(other->position, destinationNode.pos) < 8.0f) {
-                    isBlocked = true;
-                    break;
-                }
-            }
-
-            // --- 2. EXECUTE TELEPORT OR WAIT ---
-            if (!isBlocked) {
-                // CLEAR: Jump instantly
-                this->position = destinationNode.pos;
-                this->targetNodeId = destinationNode.nextNodes[0];
-                
-                // IMPORTANT: Reset direction immediately to face the new path
-                Node &nextNode = graph.GetNode(this->targetNodeId);
-                Vector3 newDir = Vector3Subtract(nextNode.pos, this->position);
-                this->forward = Vector3Normalize(newDir);
-            } 
-            else {
-                // BLOCKED: Stop and wait for the car ahead to move
-                this->speed = 0; 
-                return; 
-            }
-        }
-        
-        // TYPE B: NAVIGATION CLASSIQUE (DECISION, START, ARC)
-        else if (targetNode.type == DECISION || targetNode.type == START || targetNode.type == ARC) {
-            if (!targetNode.nextNodes.empty()) {
-                // Pick one of multiple paths randomly
-                int randomIndex = GetRandomValue(0, targetNode.nextNodes.size() - 1);
-                targetNodeId = targetNode.nextNodes[randomIndex];
-            }
-        }
-        return; // Exit update for this frame to prevent jitter
-    }
-
-    // 4. LOGIQUE DE MOUVEMENT
-        // A- Normalize direction vector (using the dist we calculated earlier)
-        if (dist > 0) {
-            dir.x /= dist; 
-            dir.y /= dist; 
-            dir.z /= dist;
-        }
-
-        // B- Smooth Steering (Interpolate forward vector toward direction)
-        float turnRate = 12.0f * dt;
-        forward.x += (dir.x - forward.x) * turnRate;
-        forward.z += (dir.z - forward.z) * turnRate;
-
-        // C- Re-normalize forward vector to keep speed consistent
-        float fMag = sqrtf(forward.x*forward.x + forward.z*forward.z);
-        if (fMag > 0) { 
-            forward.x /= fMag; 
-            forward.z /= fMag; 
-        }
-
-        // D- Apply velocity to position
-        position.x += forward.x * speed * dt;
-        position.y += forward.y * speed * dt;
-        position.z += forward.z * speed * dt;
-}
-
-void Vehicle::draw() {
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-    //.-.
-    // Calculate lateral vector (Right vector)
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    //.-.
-    rlPushMatrix();
-    rlTranslatef(drawPos.x, drawPos.y, drawPos.z);
-    rlRotatef(angle, 0, 1, 0);
-    DrawCube({0,0,0}, 2.0f, 0.6f, 4.0f, color); 
-    DrawCubeWires({0,0,0}, 2.0f, 0.6f, 4.0f, BLACK);
-    rlPopMatrix();
+static const VehicleTypeParams TYPE_PARAMS[VEHICLE_TYPE_COUNT] = {
+    // name          model          color                         desiredSpeed               length  scale  emergency  siren  flashA  flashB
+    //   follow: model           accel  comfort  max    minGap  headway  reaction  sigma
+    { "Generic",    "Car",        RED,                          5.0f,                      4.0f,   1.0f,  false,     false, RED,    RED,
+        { FOLLOW_LEGACY,  2.0f,  3.0f,  8.0f,  2.5f,  1.5f,  1.0f,  0.5f } },
+    { "Car",        "Car",        BLUE,                         CONFIG::CAR_SPEED,         4.5f,   1.0f,  false,     false, BLUE,   BLUE,   // Standard Car Length
+        { FOLLOW_LEGACY,  2.6f,  4.5f,  9.0f,  2.0f,  1.2f,  1.0f,  0.5f } },
+    { "Bus",        "Bus",        GOLD,                         CONFIG::BUS_SPEED,         8.5f,   1.0f,  false,     false, GOLD,   GOLD,   // Heavy: gentle starts and stops
+        { FOLLOW_IDM,     1.0f,  1.5f,  6.0f,  3.0f,  1.5f,  1.2f,  0.5f } },
+    { "Truck",      "Truck",      (Color){139, 69, 19, 255},    CONFIG::TRUCK_SPEED,       10.0f,  1.0f,  false,     false, BROWN,  BROWN,  // Brun, the longest
+        { FOLLOW_IDM,     0.8f,  1.5f,  6.0f,  3.5f,  1.8f,  1.2f,  0.5f } },
+    { "Taxi",       "Taxi",       YELLOW,                       CONFIG::TAXI_SPEED,        4.5f,   1.0f,  false,     false, YELLOW, YELLOW,
+        { FOLLOW_LEGACY,  3.0f,  4.5f,  9.0f,  2.0f,  1.0f,  1.0f,  0.5f } },
+    { "Police",     "Police",     (Color){20, 20, 120, 255},    CONFIG::POLICE_SPEED,      4.5f,   1.0f,  true,      true,  RED,    BLUE,   // Bleu foncé, flashes Red/Blue
+        { FOLLOW_LEGACY,  4.0f,  6.0f, 10.0f,  2.0f,  0.8f,  0.8f,  0.2f } },
+    { "Motorcycle", "Motorcycle", (Color){50, 50, 50, 255},     CONFIG::MOTORCYCLE_SPEED,  2.5f,   1.0f,  false,     false, GRAY,   GRAY,   // Shortest vehicle
+        { FOLLOW_LEGACY,  4.0f,  6.0f, 10.0f,  1.5f,  1.0f,  0.8f,  0.5f } },
+    { "Ambulance",  "Ambulance",  WHITE,                        CONFIG::POLICE_SPEED,      6.0f,   0.8f,  true,      true,  RED,    WHITE,  // Fast like police, flashes Red/White
+        { FOLLOW_LEGACY,  3.5f,  5.0f,  9.0f,  2.0f,  0.9f,  0.9f,  0.2f } },
+};
+
+const VehicleTypeParams& GetVehicleTypeParams(VehicleType type) {
+    if (type < 0 || type >= VEHICLE_TYPE_COUNT) return TYPE_PARAMS[VEHICLE_GENERIC];
+    return TYPE_PARAMS[type];
 }
 
-void DrawWheel3D(float x, float y, float z, float radius = 0.3f, float width = 0.4f) {
-    rlPushMatrix();
-        rlTranslatef(x, y, z);
-        // Rotate 90 deg around Z so the cylinder lays flat sideways
-        rlRotatef(90, 0, 0, 1); 
-        // Note: Raylib draws cylinder centered at (0,0,0). 
-        // The rotation pivots it correctly.
-        DrawCylinder((Vector3){0,0,0}, radius, radius, width, 16, BLACK);
-        DrawCylinderWires((Vector3){0,0,0}, radius, radius, width, 16, DARKGRAY);
-        
-        // Hubcap (Visual detail to see rotation)
-        DrawCylinder((Vector3){0, width/2.0f + 0.01f, 0}, radius*0.5f, radius*0.5f, 0.05f, 8, LIGHTGRAY);
-    rlPopMatrix();
+VehicleType VehicleTypeFromName(const std::string& name) {
+    for (int t = VEHICLE_CAR; t < VEHICLE_TYPE_COUNT; t++) {
+        if (name == TYPE_PARAMS[t].name) return (VehicleType)t;
+    }
+    return VEHICLE_GENERIC;
 }
 
 // =============================================================================
-//  CAR IMPLEMENTATION
+//  VEHICLE STORE
 // =============================================================================
 
-Car::Car(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = BLUE; 
-    originalColor = BLUE;
-    desiredSpeed = CONFIG::CAR_SPEED; 
-    speed = desiredSpeed;
-    length = 4.5f; // Standard Car Length
-}
-
-void Car::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& carModel = modelManager->GetModel("Car");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(drawPos.x, drawPos.y, drawPos.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        carModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-        
-        DrawModel(carModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
-}
+const int VehicleStore::TRIP_NONE;
+const int VehicleStore::TRIP_RANDOM;
 
-// =============================================================================
-//  BUS IMPLEMENTATION
-// =============================================================================
+int VehicleStore::Add(VehicleType vehicleType, Vector3 pos, int initialTargetId) {
+    const VehicleTypeParams& params = GetVehicleTypeParams(vehicleType);
 
-Bus::Bus(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = GOLD;
-    originalColor = GOLD;
-    desiredSpeed = CONFIG::BUS_SPEED;
-    speed = desiredSpeed; 
-    length = 8.5f;
+    // A freed slot if there is one, otherwise one more entry in every array
+    int i;
+    if (!freeSlots.empty()) {
+        i = freeSlots.back();
+        freeSlots.pop_back();
+        recycledCount++;
+    }
+    else {
+        i = Size();
+        int n = i + 1;
+        position.resize(n);
+        forward.resize(n);
+        prevPosition.resize(n);
+        prevForward.resize(n);
+        speed.resize(n);
+        desiredSpeed.resize(n);
+        length.resize(n);
+        lateralOffset.resize(n);
+        forceMoveTimer.resize(n);
+        effectTimer.resize(n);
+        targetNodeId.resize(n);
+        edgeFromId.resize(n);
+        edgeBranch.resize(n);
+        type.resize(n);
+        color.resize(n);
+        finished.resize(n);
+        followModel.resize(n);
+        tripDestination.resize(n);
+        tripRequest.resize(n);
+        routeCursor.resize(n);
+        routeEnd.resize(n);
+        generation.push_back(0);
+    }
+    spawnedCount++;
+
+    position[i] = pos;
+    forward[i] = {1, 0, 0};
+    prevPosition[i] = pos;
+    prevForward[i] = {1, 0, 0};
+    speed[i] = params.desiredSpeed;
+    desiredSpeed[i] = params.desiredSpeed;
+    length[i] = params.length;
+    lateralOffset[i] = 0.0f;
+    forceMoveTimer[i] = 0.0f;
+    effectTimer[i] = 0.0f;
+    targetNodeId[i] = initialTargetId;
+    edgeFromId[i] = -1;
+    edgeBranch[i] = 0;
+    type[i] = vehicleType;
+    color[i] = params.color;
+    finished[i] = 0;
+    followModel[i] = (unsigned char)(globalConfig.followModel != FOLLOW_BY_TYPE ? globalConfig.followModel : params.follow.model);
+    tripDestination[i] = TRIP_NONE;
+    tripRequest[i] = -1;
+    routeCursor[i] = 0;
+    routeEnd[i] = 0;
+    if (params.isEmergency) emergencyCount++;
+
+    return i;
 }
 
-void Bus::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& busModel = modelManager->GetModel("Bus");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(position.x, position.y, position.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        busModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-        
-        DrawModel(busModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
+void VehicleStore::Remove(int i) {
+    if (i < 0 || i >= Size() || finished[i]) return;
+
+    finished[i] = 1;
+    generation[i]++;
+    freeSlots.push_back(i);
+    removedCount++;
+    if (IsEmergency(i)) emergencyCount--;
+
+    // Nothing may keep reading the old vehicle through the slot
+    speed[i] = 0.0f;
+    forceMoveTimer[i] = 0.0f;
+    edgeFromId[i] = -1;
+    tripDestination[i] = TRIP_NONE;
+    tripRequest[i] = -1;
+    routeWaste += routeEnd[i] - routeCursor[i];
+    routeCursor[i] = routeEnd[i] = 0;
 }
 
-// =============================================================================
-//  AMBULANCE IMPLEMENTATION
-// =============================================================================
-Ambulance::Ambulance(Vector3 pos, int targetId) : Vehicle(pos, targetId) {
-    color = WHITE; 
-    originalColor = WHITE;
-    desiredSpeed = CONFIG::POLICE_SPEED; // Fast like police
-    speed = desiredSpeed;
-    length = 6.0f; // Slightly larger than a car
-    modelType = "Ambulance";
+void VehicleStore::Clear() {
+    position.clear();
+    forward.clear();
+    prevPosition.clear();
+    prevForward.clear();
+    speed.clear();
+    desiredSpeed.clear();
+    length.clear();
+    lateralOffset.clear();
+    forceMoveTimer.clear();
+    effectTimer.clear();
+    targetNodeId.clear();
+    edgeFromId.clear();
+    edgeBranch.clear();
+    type.clear();
+    color.clear();
+    finished.clear();
+    followModel.clear();
+    tripDestination.clear();
+    tripRequest.clear();
+    routeCursor.clear();
+    routeEnd.clear();
+    routeChoices.clear();
+    routeWaste = 0;
+    emergencyCount = 0;
+    exits.clear();
+    generation.clear();
+    freeSlots.clear();
+    spawnedCount = recycledCount = removedCount = 0;
 }
 
-void Ambulance::update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) {
-    Vehicle::update(dt, graph, allVehicles);
-    sirenTimer += dt;
-    // Simple visual siren effect (flashing color)
-    if (fmod(sirenTimer, 0.5f) > 0.25f) color = RED;
-    else color = WHITE;
+VehiclePoolStats VehicleStore::GetPoolStats() const {
+    VehiclePoolStats stats;
+    stats.slots = Size();
+    stats.live = GetLiveCount();
+    stats.freeSlots = (int)freeSlots.size();
+    stats.spawned = spawnedCount;
+    stats.recycled = recycledCount;
+    stats.removed = removedCount;
+
+    // Per-slot bytes of every array (capacity, what the allocator actually holds)
+    size_t perSlot = 4 * sizeof(Vector3) + 6 * sizeof(float) + 3 * sizeof(int) + sizeof(VehicleType) + sizeof(Color)
+                   + 2 * sizeof(unsigned char) + 4 * sizeof(int) + sizeof(unsigned);
+    stats.bytes = position.capacity() * perSlot + freeSlots.capacity() * sizeof(int) + routeChoices.capacity();
+    return stats;
 }
 
-void Ambulance::draw() {
-    if (!modelManager) return;
-
-    // Use Truck model as placeholder if Ambulance doesn't exist, or specific model
-    // Assuming we might use the Truck model scaled down or just draw basic for now
-    // If you have an ambulance.glb, load it in ModelManager. 
-    // For now, we reuse the Truck model but painted White/Red
-    
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-
-    Model& model = modelManager->GetModel("Ambulance"); // Reusing Truck for shape
-
-    rlPushMatrix();
-    rlTranslatef(drawPos.x, drawPos.y, drawPos.z);
-    rlRotatef(angle, 0, 1, 0);
-    rlScalef(0.8f, 0.8f, 0.8f); // Slightly smaller than the big truck
-    
-    model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-    DrawModel(model, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
+void VehicleStore::SetRoute(int i, int destination, const std::vector<unsigned char>& choices) {
+    routeWaste += routeEnd[i] - routeCursor[i];
+
+    // Compact the pool once most of it is dead (routes used up or replaced)
+    if (routeWaste > 4096 && routeWaste * 2 > (int)routeChoices.size()) {
+        std::vector<unsigned char> compacted;
+        compacted.reserve(routeChoices.size() - routeWaste);
+        for (int j = 0; j < Size(); j++) {
+            int begin = (int)compacted.size();
+            if (j != i) compacted.insert(compacted.end(), routeChoices.begin() + routeCursor[j], routeChoices.begin() + routeEnd[j]);
+            routeCursor[j] = begin;
+            routeEnd[j] = (int)compacted.size();
+        }
+        routeChoices.swap(compacted);
+        routeWaste = 0;
+    }
+
+    tripDestination[i] = destination;
+    routeCursor[i] = (int)routeChoices.size();
+    routeChoices.insert(routeChoices.end(), choices.begin(), choices.end());
+    routeEnd[i] = (int)routeChoices.size();
 }
 
 // =============================================================================
-//  TRUCK IMPLEMENTATION
+//  MOTION UPDATE
 // =============================================================================
 
-Truck::Truck(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = (Color){139, 69, 19, 255}; // Brun
-    originalColor = (Color){139, 69, 19, 255};
-    desiredSpeed = CONFIG::TRUCK_SPEED;
-    speed = desiredSpeed;
-    length = 10.0f; // Truck is the longest
+int ChooseNextBranch(VehicleStore& vs, int i, const Node& node, const RoadGraph& graph, const Router* router) {
+    // Routed vehicles follow their trip (live fastest branch or stored route),
+    // the others pick one of multiple paths randomly
+    int choice = -1;
+    if (node.nextNodes.size() > 1) {
+        if (router && vs.tripDestination[i] >= 0) choice = router->ChooseFastestBranch(graph, node.id, vs.tripDestination[i]);
+        else choice = vs.NextRouteChoice(i);
+    }
+    if (choice < 0 || choice >= (int)node.nextNodes.size()) {
+        choice = SimRandom::GetValue(0, node.nextNodes.size() - 1);
+    }
+    return choice;
 }
 
-void Truck::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& truckModel = modelManager->GetModel("Truck");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(position.x, position.y, position.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        truckModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-        
-        DrawModel(truckModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
-}
+void UpdateVehicleMotion(VehicleStore& vs, float dt, RoadGraph& graph, WorkerPool* pool, const Router* router) {
+    int count = vs.Size();
+    vs.steerDir.resize(count);
+    vs.moving.resize(count);
+    vs.arrived.resize(count);
+
+    // Every vehicle only writes its own slot in the parallel passes, so the
+    // result is the same with 1 or N threads. Node lookups are read-only there.
+    const RoadGraph& readGraph = graph;
+    auto forEach = [&](const WorkerPool::RangeFunc& fn) {
+        if (pool) pool->ParallelFor(count, fn);
+        else fn(0, count, 0);
+    };
+
+    // --- 1. STEERING TARGET (parallel) ---
+    forEach([&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) {
+            vs.moving[i] = 0.0f;
+            vs.arrived[i] = 0;
+            if (vs.finished[i]) continue;
+
+            // Récupération sécurisée du noeud cible via la classe RoadGraph
+            const Node &targetNode = readGraph.GetNode(vs.targetNodeId[i]);
+            if (!targetNode.IsValid()) {
+                // Lost vehicle (target removed from the graph): stop instead of driving to a random node
+                vs.speed[i] = 0;
+                continue;
+            }
 
-// =============================================================================
-//  TAXI IMPLEMENTATION
-// =============================================================================
+            // Calcul de la direction et distance
+            Vector3 dir = Vector3Subtract(targetNode.pos, vs.position[i]);
+            float dist = sqrtf(dir.x*dir.x + dir.y*dir.y + dir.z*dir.z);
 
-Taxi::Taxi(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = YELLOW;
-    originalColor = YELLOW;
-    desiredSpeed = CONFIG::TAXI_SPEED;
-    speed = desiredSpeed;
-    length = 4.5f;
-}
+            // LOGIQUE D'ARRIVÉE: handled in pass 2, no movement this step to prevent jitter
+            if (dist < CONFIG::ARRIVAL_THRESHOLD) { // Threshold for "reaching" the node
+                vs.arrived[i] = 1;
+                continue;
+            }
 
-void Taxi::update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) {
-    Vehicle::update(dt, graph, allVehicles); 
-    signBlinkTimer += dt;
-}
+            vs.steerDir[i] = { dir.x / dist, dir.y / dist, dir.z / dist };
+            vs.moving[i] = 1.0f;
+        }
+    });
+
+    // --- 2. ARRIVALS (serial, in index order) ---
+    // Few vehicles per tick; kept serial because they draw random numbers
+    // and teleports look at the landing zone of the other vehicles.
+    // Landing zone: vehicles near it in the grid (checked at their current position,
+    // some jumped or left since the build) plus the ones that landed this tick.
+    bool gridBuilt = false;
+    vs.landedNow.clear();
+    auto isLandingClear = [&](int i, Vector3 landing) {
+        if (!gridBuilt) {
+            vs.landingGrid.Build(vs);
+            gridBuilt = true;
+        }
+        for (const Vector3& p : vs.landedNow) {
+            if (Vector3Distance(p, landing) < 8.0f) return false;
+        }
+        vs.landingGrid.Query(landing, 8.0f, vs.landingNearby);
+        for (int j : vs.landingNearby) {
+            if (j == i || vs.finished[j]) continue;
+            if (Vector3Distance(vs.position[j], landing) < 8.0f) return false;
+        }
+        return true;
+    };
+    for (int i = 0; i < count; i++) {
+        if (!vs.arrived[i]) continue;
+        Node &targetNode = graph.GetNode(vs.targetNodeId[i]);
+
+        // TYPE A: TELEPORTATION (or leaving the network)
+        if (targetNode.type == TELEPORT && globalConfig.VehiclesLeaveAtExits()) {
+            vs.exits.push_back({ vs.type[i], targetNode.id });
+            vs.Remove(i);
+        }
+        else if (targetNode.type == TELEPORT) {
+            Node &destinationNode = graph.GetNode(targetNode.teleportTargetId);
 
-void Taxi::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& taxiModel = modelManager->GetModel("Taxi");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(position.x, position.y, position.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        taxiModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-        
-        DrawModel(taxiModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
-}
+            // --- CHECK IF LANDING ZONE IS CLEAR ---
+            // Broken teleport (missing target or no exit path): wait like a blocked one
+            bool isBlocked = !destinationNode.IsValid() || destinationNode.nextNodes.empty();
 
-// =============================================================================
-//  POLICE CAR IMPLEMENTATION
-// =============================================================================
+            // 8.0f is a safe gap to ensure we don't land inside someone
+            if (!isBlocked) isBlocked = !isLandingClear(i, destinationNode.pos);
 
-PoliceCar::PoliceCar(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = (Color){20, 20, 120, 255}; // Bleu foncé
-    originalColor = (Color){20, 20, 120, 255};
-    desiredSpeed = CONFIG::POLICE_SPEED;
-    speed = desiredSpeed;
-    length = 4.5f;
-}
+            if (!isBlocked) {
+                // Trip over (or random turns until here): AssignTrips gives a new one
+                if (vs.tripDestination[i] == vs.targetNodeId[i] || vs.tripDestination[i] == VehicleStore::TRIP_RANDOM) {
+                    vs.tripDestination[i] = VehicleStore::TRIP_NONE;
+                }
 
-void PoliceCar::update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) {
-    Vehicle::update(dt, graph, allVehicles); 
-    sirenTimer += dt;
+                // CLEAR: Jump instantly and face the new path
+                vs.position[i] = destinationNode.pos;
+                vs.landedNow.push_back(destinationNode.pos);
+                vs.targetNodeId[i] = destinationNode.nextNodes[0];
+                vs.edgeFromId[i] = destinationNode.id;
+                vs.edgeBranch[i] = 0;
+                Vector3 newDir = Vector3Subtract(graph.GetNode(vs.targetNodeId[i]).pos, vs.position[i]);
+                vs.forward[i] = Vector3Normalize(newDir);
+
+                // No interpolation across the jump (would draw the car crossing the map)
+                vs.prevPosition[i] = vs.position[i];
+                vs.prevForward[i] = vs.forward[i];
+            }
+            else {
+                // BLOCKED: Stop and wait for the car ahead to move
+                vs.speed[i] = 0;
+            }
+        }
 
-    // --- SIREN EFFECT: Flash Blue and Red ---
-    // Every 0.25 seconds, switch color
-    if (fmod(sirenTimer, 0.5f) > 0.25f) {
-        color = RED; // Flash Red
-    } else {
-        color = BLUE; // Flash Blue (Bright Blue)
+        // TYPE B: NAVIGATION CLASSIQUE (DECISION, START, ARC)
+        else if (targetNode.type == DECISION || targetNode.type == START || targetNode.type == ARC) {
+            if (!targetNode.nextNodes.empty()) {
+                int choice = ChooseNextBranch(vs, i, targetNode, graph, router);
+                vs.targetNodeId[i] = targetNode.nextNodes[choice];
+                vs.edgeFromId[i] = targetNode.id;
+                vs.edgeBranch[i] = choice;
+            }
+        }
     }
-}
 
-void PoliceCar::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& policeModel = modelManager->GetModel("Police");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(position.x, position.y, position.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        policeModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-
-        DrawModel(policeModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    // --- DRAW ROOF LIGHTS ---
-        // We draw two small spheres on top of the car roof
-        // Adjust (0.0f, 1.8f, +/- 0.4f) depending on your car model size
-        
-        bool isRedPhase = fmod(sirenTimer, 0.5f) > 0.25f;
-        
-        // Light 1 (Red)
-        Color light1 = isRedPhase ? RED : DARKGRAY;
-        DrawSphere((Vector3){0.0f, 1.8f, 0.4f}, 0.2f, light1);
-        
-        // Light 2 (Blue)
-        Color light2 = isRedPhase ? DARKGRAY : BLUE;
-        DrawSphere((Vector3){0.0f, 1.8f, -0.4f}, 0.2f, light2);
-
-    rlPopMatrix();
+    // --- 3. STEERING + INTEGRATION + EFFECTS (parallel, no branches in the motion math) ---
+    // Vehicles that did not move this step have moving = 0 and keep their state.
+    float turnRate = 12.0f * dt;
+    forEach([&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) {
+            float m = vs.moving[i];
+            Vector3 f = vs.forward[i];
+            Vector3 d = vs.steerDir[i];
+
+            // Smooth Steering (Interpolate forward vector toward direction)
+            float fx = f.x + (d.x - f.x) * turnRate * m;
+            float fz = f.z + (d.z - f.z) * turnRate * m;
+
+            // Re-normalize forward vector to keep speed consistent
+            float fMag = sqrtf(fx*fx + fz*fz);
+            if (fMag > 0.0f) {
+                fx /= fMag;
+                fz /= fMag;
+            }
+            // Parked vehicles keep their exact heading (select, not a branch)
+            f.x = m * fx + (1.0f - m) * f.x;
+            f.z = m * fz + (1.0f - m) * f.z;
+            vs.forward[i] = f;
+
+            // Apply velocity to position
+            float v = vs.speed[i] * m;
+            vs.position[i].x += f.x * v * dt;
+            vs.position[i].y += f.y * v * dt;
+            vs.position[i].z += f.z * v * dt;
+        }
+
+        // Visual effects (siren flashing)
+        for (int i = begin; i < end; i++) {
+            vs.effectTimer[i] += dt;
+
+            const VehicleTypeParams& params = GetVehicleTypeParams(vs.type[i]);
+            if (params.hasSiren) {
+                // Every 0.25 seconds, switch color
+                vs.color[i] = (fmod(vs.effectTimer[i], 0.5f) > 0.25f) ? params.flashColorA : params.flashColorB;
+            }
+        }
+    });
 }
 
 // =============================================================================
-//  MOTORCYCLE IMPLEMENTATION
+//  LIVE TRAVEL TIMES
 // =============================================================================
 
-Motorcycle::Motorcycle(Vector3 pos, int targetId) : Vehicle(pos, targetId) { 
-    color = (Color){50, 50, 50, 255}; // Gris foncé
-    originalColor = (Color){50, 50, 50, 255};
-    desiredSpeed = CONFIG::MOTORCYCLE_SPEED;
-    speed = desiredSpeed;
-    length = 2.5f; // Shortest vehicle
-    lastForward = forward;
-}
-
-void Motorcycle::update(float dt, RoadGraph &graph, const std::vector<std::unique_ptr<Vehicle>> &allVehicles) {
-    Vector3 prevForward = lastForward;
-    
-    // Utilise votre logique de navigation RoadGraph
-    Vehicle::update(dt, graph, allVehicles);
-
-    // Calcul de l'inclinaison basé sur le changement de direction
-    float turnRate = (forward.x - prevForward.x) + (forward.z - prevForward.z);
-    tiltAngle = turnRate * 30.0f;
-    
-    // Limitation de l'angle d'inclinaison
-    if (tiltAngle > 25.0f) tiltAngle = 25.0f;
-    if (tiltAngle < -25.0f) tiltAngle = -25.0f;
-    
-    tiltAngle *= 0.9f; // Amortissement pour plus de fluidité
-    lastForward = forward;
+void UpdateEdgeTravelTimes(const VehicleStore& vehicles, RoadGraph& graph, float dt) {
+    for (int i = 0; i < vehicles.Size(); i++) {
+        if (vehicles.finished[i] || vehicles.edgeFromId[i] < 0) continue;
+        graph.AddEdgeSpeedSample(vehicles.edgeFromId[i], vehicles.edgeBranch[i], vehicles.speed[i]);
+    }
+    graph.UpdateTravelTimes(dt);
 }
-
-void Motorcycle::draw() {
-    if (!modelManager) return; // Safety check
-
-    float angle = atan2f(forward.x, forward.z) * RAD2DEG;
-
-    Model& motorcycleModel = modelManager->GetModel("Motorcycle");
-
-    Vector3 right = { -forward.z, 0.0f, forward.x };
-    Vector3 drawPos = Vector3Add(position, Vector3Scale(right, lateralOffset));
-    
-    rlPushMatrix();
-        rlTranslatef(position.x, position.y, position.z);
-        rlRotatef(angle, 0, 1, 0);
-        
-        // Adjust scale and height as needed
-        rlScalef(1.0f, 1.0f, 1.0f);
-        
-        // Apply vehicle color to the model
-        motorcycleModel.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = color;
-
-        DrawModel(motorcycleModel, (Vector3){0, 0, 0}, 1.0f, WHITE);
-    rlPopMatrix();
-}
\ No newline at end of file
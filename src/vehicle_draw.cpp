@@ -0,0 +1,340 @@
+#include "vehicle_draw.h"
+#include "rlgl.h"
+#include "raymath.h"
+
+static ModelManager* modelManager = nullptr;
+
+void SetVehicleModelManager(ModelManager* manager) {
+    modelManager = manager;
+}
+
+// =============================================================================
+//  MODELS
+// =============================================================================
+
+static void DrawBoxVehicle(Color color) {
+    DrawCube({0,0,0}, 2.0f, 0.6f, 4.0f, color); 
+    DrawCubeWires({0,0,0}, 2.0f, 0.6f, 4.0f, BLACK);
+}
+
+void DrawWheel3D(float x, float y, float z, float radius = 0.3f, float width = 0.4f) {
+    rlPushMatrix();
+        rlTranslatef(x, y, z);
+        // Rotate 90 deg around Z so the cylinder lays flat sideways
+        rlRotatef(90, 0, 0, 1); 
+        // Note: Raylib draws cylinder centered at (0,0,0). 
+        // The rotation pivots it correctly.
+        DrawCylinder((Vector3){0,0,0}, radius, radius, width, 16, BLACK);
+        DrawCylinderWires((Vector3){0,0,0}, radius, radius, width, 16, DARKGRAY);
+        
+        // Hubcap (Visual detail to see rotation)
+        DrawCylinder((Vector3){0, width/2.0f + 0.01f, 0}, radius*0.5f, radius*0.5f, 0.05f, 8, LIGHTGRAY);
+    rlPopMatrix();
+}
+
+// --- DRAW ROOF LIGHTS ---
+// We draw two small spheres on top of the car roof
+// Adjust (0.0f, 1.8f, +/- 0.4f) depending on your car model size
+static void DrawRoofLights(float effectTimer) {
+    bool isRedPhase = fmod(effectTimer, 0.5f) > 0.25f;
+
+    // Light 1 (Red)
+    Color light1 = isRedPhase ? RED : DARKGRAY;
+    DrawSphere((Vector3){0.0f, 1.8f, 0.4f}, 0.2f, light1);
+
+    // Light 2 (Blue)
+    Color light2 = isRedPhase ? DARKGRAY : BLUE;
+    DrawSphere((Vector3){0.0f, 1.8f, -0.4f}, 0.2f, light2);
+}
+
+// =============================================================================
+//  POSE
+// =============================================================================
+
+// Interpolated draw position (with the yielding offset) and heading in degrees
+static void GetVehicleDrawPose(const VehicleStore& vehicles, int i, float alpha, Vector3& drawPos, float& angle) {
+    // Blend between the last two fixed steps so motion stays smooth at any frame rate
+    Vector3 pos = Vector3Lerp(vehicles.prevPosition[i], vehicles.position[i], alpha);
+    Vector3 fwd = Vector3Lerp(vehicles.prevForward[i], vehicles.forward[i], alpha);
+    float fMag = sqrtf(fwd.x*fwd.x + fwd.z*fwd.z);
+    if (fMag > 0.0001f) {
+        fwd.x /= fMag;
+        fwd.z /= fMag;
+    } else {
+        fwd = vehicles.forward[i];
+    }
+
+    angle = atan2f(fwd.x, fwd.z) * RAD2DEG;
+
+    //.-.
+    // Calculate lateral vector (Right vector)
+    Vector3 right = { -fwd.z, 0.0f, fwd.x };
+    drawPos = Vector3Add(pos, Vector3Scale(right, vehicles.lateralOffset[i]));
+    //.-.
+}
+
+// =============================================================================
+//  DISPATCH
+// =============================================================================
+
+void DrawVehicle(const VehicleStore& vehicles, int i, float alpha) {
+    Vector3 drawPos;
+    float angle;
+    GetVehicleDrawPose(vehicles, i, alpha, drawPos, angle);
+    const VehicleTypeParams& params = GetVehicleTypeParams(vehicles.type[i]);
+
+    // Generic vehicles have no model, they are drawn as a plain box
+    bool hasModel = vehicles.type[i] != VEHICLE_GENERIC;
+    if (hasModel && !modelManager) return; // Safety check
+
+    rlPushMatrix();
+        rlTranslatef(drawPos.x, drawPos.y, drawPos.z);
+        rlRotatef(angle, 0, 1, 0);
+
+        if (hasModel) {
+            Model& model = modelManager->GetModel(params.modelName);
+
+            // Adjust scale and height as needed
+            rlScalef(params.drawScale, params.drawScale, params.drawScale);
+
+            // Apply vehicle color to the model
+            model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = vehicles.color[i];
+            DrawModel(model, (Vector3){0, 0, 0}, 1.0f, WHITE);
+
+            if (vehicles.type[i] == VEHICLE_POLICE) DrawRoofLights(vehicles.effectTimer[i]);
+        } else {
+            DrawBoxVehicle(vehicles.color[i]);
+        }
+    rlPopMatrix();
+}
+
+// =============================================================================
+//  INSTANCED RENDERER
+// =============================================================================
+
+// Same inputs as raylib's default shader plus the per-instance transform and tint.
+// useTint replaces colDiffuse by the instance color (what DrawVehicle does to materials[0]).
+static const char* INSTANCING_VS = R"(#version 330
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+in mat4 instanceTransform;
+in vec4 instanceColor;
+uniform mat4 mvp;
+out vec2 fragTexCoord;
+out vec4 fragColor;
+out vec4 fragTint;
+void main() {
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    fragTint = instanceColor;
+    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);
+}
+)";
+
+static const char* INSTANCING_FS = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+in vec4 fragTint;
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform int useTint;
+out vec4 finalColor;
+void main() {
+    vec4 tint = (useTint != 0) ? fragTint : colDiffuse;
+    finalColor = texture(texture0, fragTexCoord)*tint*fragColor;
+}
+)";
+
+// All live vehicles sharing one model: one DrawMeshInstanced per mesh of that model
+struct InstanceBatch {
+    Model* model = nullptr;
+    bool tintAllMaterials = false;  // Generated meshes (box, roof light) take the tint on every material
+    std::vector<Matrix> transforms;
+    std::vector<Color> colors;
+    unsigned int colorVbo = 0;      // Per-instance tint, attached to every mesh VAO of the model
+    int colorCapacity = 0;
+};
+
+static Shader instancingShader = { 0 };
+static int instanceColorLoc = -1;
+static int useTintLoc = -1;
+static bool instancingReady = false;
+
+static std::vector<InstanceBatch> batches;
+static int typeBatch[VEHICLE_TYPE_COUNT];   // VehicleType -> index in batches
+static int lightBatch = -1;                 // Police roof lights
+static Model boxModel = { 0 };              // Generic vehicles
+static Model lightModel = { 0 };
+static VehicleDrawStats lastStats = { 0, 0, false };
+
+static int AddBatch(Model* model, bool tintAllMaterials) {
+    for (int b = 0; b < (int)batches.size(); b++) {
+        if (batches[b].model == model) return b;
+    }
+    InstanceBatch batch;
+    batch.model = model;
+    batch.tintAllMaterials = tintAllMaterials;
+    batches.push_back(batch);
+    return (int)batches.size() - 1;
+}
+
+// Grows the tint buffer and (re)binds it as an instanced attribute of every mesh
+static void ReserveColorBuffer(InstanceBatch& batch, int count) {
+    if (count <= batch.colorCapacity) return;
+
+    int capacity = batch.colorCapacity > 0 ? batch.colorCapacity : 256;
+    while (capacity < count) capacity *= 2;
+
+    if (batch.colorVbo != 0) rlUnloadVertexBuffer(batch.colorVbo);
+    batch.colorVbo = rlLoadVertexBuffer(nullptr, capacity * (int)sizeof(Color), true);
+    batch.colorCapacity = capacity;
+
+    for (int m = 0; m < batch.model->meshCount; m++) {
+        if (!rlEnableVertexArray(batch.model->meshes[m].vaoId)) continue;
+        rlEnableVertexBuffer(batch.colorVbo);
+        rlSetVertexAttribute(instanceColorLoc, 4, RL_UNSIGNED_BYTE, true, 0, 0);
+        rlEnableVertexAttribute(instanceColorLoc);
+        rlSetVertexAttributeDivisor(instanceColorLoc, 1);
+        rlDisableVertexBuffer();
+        rlDisableVertexArray();
+    }
+}
+
+static void DrawBatch(InstanceBatch& batch) {
+    int count = (int)batch.transforms.size();
+    if (count == 0) return;
+
+    ReserveColorBuffer(batch, count);
+    rlUpdateVertexBuffer(batch.colorVbo, batch.colors.data(), count * (int)sizeof(Color), 0);
+
+    Model& model = *batch.model;
+    for (int m = 0; m < model.meshCount; m++) {
+        int materialIndex = model.meshMaterial[m];
+        Material material = model.materials[materialIndex];
+        material.shader = instancingShader;
+
+        int useTint = (batch.tintAllMaterials || materialIndex == 0) ? 1 : 0;
+        SetShaderValue(instancingShader, useTintLoc, &useTint, SHADER_UNIFORM_INT);
+        DrawMeshInstanced(model.meshes[m], material, batch.transforms.data(), count);
+        lastStats.drawCalls++;
+    }
+}
+
+void InitVehicleRenderer() {
+    UnloadVehicleRenderer();
+
+    instancingShader = LoadShaderFromMemory(INSTANCING_VS, INSTANCING_FS);
+    instancingShader.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(instancingShader, "mvp");
+    instancingShader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(instancingShader, "instanceTransform");
+    instanceColorLoc = GetShaderLocationAttrib(instancingShader, "instanceColor");
+    useTintLoc = GetShaderLocation(instancingShader, "useTint");
+
+    // Failed compile (no GL 3.3): raylib hands back its default shader, keep DrawVehicle
+    instancingReady = modelManager && instancingShader.id != rlGetShaderIdDefault() && instanceColorLoc >= 0;
+    if (!instancingReady) {
+        TraceLog(LOG_WARNING, "VEHICLES: Instancing not available, drawing vehicles one by one");
+        return;
+    }
+
+    boxModel = LoadModelFromMesh(GenMeshCube(2.0f, 0.6f, 4.0f));
+    lightModel = LoadModelFromMesh(GenMeshSphere(0.2f, 8, 8));
+
+    // Types sharing a model (e.g. a fallback model) share a batch
+    for (int t = 0; t < VEHICLE_TYPE_COUNT; t++) {
+        if (t == VEHICLE_GENERIC) typeBatch[t] = AddBatch(&boxModel, true);
+        else typeBatch[t] = AddBatch(&modelManager->GetModel(GetVehicleTypeParams((VehicleType)t).modelName), false);
+    }
+    lightBatch = AddBatch(&lightModel, true);
+}
+
+void UnloadVehicleRenderer() {
+    for (InstanceBatch& batch : batches) {
+        if (batch.colorVbo != 0) rlUnloadVertexBuffer(batch.colorVbo);
+    }
+    batches.clear();
+    lightBatch = -1;
+
+    if (boxModel.meshCount > 0) UnloadModel(boxModel);
+    if (lightModel.meshCount > 0) UnloadModel(lightModel);
+    boxModel = { 0 };
+    lightModel = { 0 };
+
+    if (instancingShader.id != 0 && instancingShader.id != rlGetShaderIdDefault()) UnloadShader(instancingShader);
+    instancingShader = { 0 };
+    instancingReady = false;
+}
+
+void DrawVehicles(const VehicleStore& vehicles, float alpha, const Frustum& frustum, Vector3 cameraPos, CullCounter& counter) {
+    lastStats = { 0, 0, instancingReady };
+    int count = vehicles.Size();
+
+    for (InstanceBatch& batch : batches) {
+        batch.transforms.clear();
+        batch.colors.clear();
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (vehicles.finished[i]) continue; // Free slot
+        Vector3 drawPos;
+        float angle;
+        GetVehicleDrawPose(vehicles, i, alpha, drawPos, angle);
+
+        VehicleType type = vehicles.type[i];
+        const VehicleTypeParams& params = GetVehicleTypeParams(type);
+
+        // Bounding sphere: the models are a bit longer than the simulated length
+        if (!SphereInFrustum(frustum, drawPos, params.length * 0.75f + 2.0f)) {
+            counter.culled++;
+            continue;
+        }
+        counter.drawn++;
+
+        // Far away: the plain box of generic vehicles, no roof lights
+        bool lowDetail = type == VEHICLE_GENERIC || Vector3Distance(drawPos, cameraPos) > CONFIG::LOD_VEHICLE_DISTANCE;
+        if (lowDetail && type != VEHICLE_GENERIC) counter.lowDetail++;
+
+        if (!instancingReady) {
+            if (!lowDetail) {
+                DrawVehicle(vehicles, i, alpha);
+            } else {
+                rlPushMatrix();
+                    rlTranslatef(drawPos.x, drawPos.y, drawPos.z);
+                    rlRotatef(angle, 0, 1, 0);
+                    DrawBoxVehicle(vehicles.color[i]);
+                rlPopMatrix();
+            }
+            lastStats.drawCalls++;
+            lastStats.instances++;
+            continue;
+        }
+
+        // Same order as DrawVehicle: scale, rotate, translate
+        float scale = lowDetail ? 1.0f : params.drawScale;
+        Matrix pose = MatrixMultiply(MatrixMultiply(MatrixScale(scale, scale, scale), MatrixRotateY(angle * DEG2RAD)),
+                                     MatrixTranslate(drawPos.x, drawPos.y, drawPos.z));
+
+        InstanceBatch& batch = batches[lowDetail ? typeBatch[VEHICLE_GENERIC] : typeBatch[type]];
+        batch.transforms.push_back(MatrixMultiply(batch.model->transform, pose));
+        batch.colors.push_back(vehicles.color[i]);
+
+        if (type == VEHICLE_POLICE && !lowDetail) {
+            bool isRedPhase = fmod(vehicles.effectTimer[i], 0.5f) > 0.25f;
+            InstanceBatch& lights = batches[lightBatch];
+            lights.transforms.push_back(MatrixMultiply(MatrixTranslate(0.0f, 1.8f, 0.4f), pose));
+            lights.colors.push_back(isRedPhase ? RED : DARKGRAY);
+            lights.transforms.push_back(MatrixMultiply(MatrixTranslate(0.0f, 1.8f, -0.4f), pose));
+            lights.colors.push_back(isRedPhase ? DARKGRAY : BLUE);
+        }
+    }
+
+    if (!instancingReady) return;
+    for (InstanceBatch& batch : batches) {
+        lastStats.instances += (int)batch.transforms.size();
+        DrawBatch(batch);
+    }
+}
+
+VehicleDrawStats GetVehicleDrawStats() {
+    return lastStats;
+}
@@ -0,0 +1,109 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(int threadCount) {
+    Start(threadCount);
+}
+
+WorkerPool::~WorkerPool() {
+    Stop();
+}
+
+void WorkerPool::Start(int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount <= 0) threadCount = 1; // hardware_concurrency() may not know
+
+    // New threads only wait for jobs posted after this point (Resize after a ParallelFor
+    // leaves generation != 0 and the last job's fields behind)
+    unsigned long current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        current = generation;
+    }
+    for (int i = 1; i < threadCount; i++) {
+        threads.emplace_back(&WorkerPool::WorkerLoop, this, i, current);
+    }
+}
+
+void WorkerPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& t : threads) t.join();
+    threads.clear();
+}
+
+void WorkerPool::Resize(int threadCount) {
+    int wanted = threadCount;
+    if (wanted <= 0) wanted = (int)std::thread::hardware_concurrency();
+    if (wanted <= 0) wanted = 1;
+    if (wanted == GetThreadCount()) return;
+
+    Stop();
+    Start(wanted);
+}
+
+void WorkerPool::RunChunk(const RangeFunc& fn, int count, int chunks, int chunk) {
+    // Same split for the same (count, chunks), whichever thread runs it
+    int begin = (int)((long long)count * chunk / chunks);
+    int end = (int)((long long)count * (chunk + 1) / chunks);
+    if (begin < end) fn(begin, end, chunk);
+}
+
+void WorkerPool::ParallelFor(int count, const RangeFunc& fn, int minChunk) {
+    if (count <= 0) return;
+
+    int chunks = GetThreadCount();
+    if (minChunk > 0 && count / minChunk < chunks) chunks = count / minChunk;
+    if (chunks <= 1) {
+        fn(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobChunks = chunks;
+        pending = chunks - 1;
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    // The caller takes chunk 0 instead of sleeping
+    RunChunk(fn, count, chunks, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::WorkerLoop(int worker, unsigned long seen) {
+    while (true) {
+        const RangeFunc* fn;
+        int count, chunks;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            fn = job;
+            count = jobCount;
+            chunks = jobChunks;
+        }
+
+        // Threads beyond the chunk count sit this job out
+        if (worker >= chunks) continue;
+
+        RunChunk(*fn, count, chunks, worker);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = (--pending == 0);
+        }
+        if (last) allDone.notify_one();
+    }
+}
@@ -1,10 +1,29 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
-#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <chrono>
 #include "roadgraph.h"
 #include "traffic_manager.h"
 #include "vehicle.h"
+#include "spatial_grid.h"
+#include "simulation.h"
+#include "road_network.h"
+#include "follow_kernel.h"
+#include "profiler.h"
+#include "frustum.h"
+#include "router.h"
+#include "follow_model.h"
+#include "meso_engine.h"
+#include "road_network_file.h"
+#include "osm_import.h"
+#include "demand.h"
+#include "spawner.h"
+#include "sim_random.h"
+#include "config.h"
 #include "raylib.h"
 
 // Simple test helper
@@ -37,11 +56,15 @@ TEST_CASE(TestRoadGraphConnections) {
 // --- TEST 3: Vehicle Initialization ---
 TEST_CASE(TestVehicleInitialization) {
     Vector3 startPos = {0, 0, 0};
-    Car myCar(startPos, 1);
+    VehicleStore vehicles;
+    int myCar = vehicles.Add(VEHICLE_CAR, startPos, 1);
     
-    assert(myCar.position.x == 0);
-    assert(myCar.targetNodeId == 1);
-    assert(myCar.speed > 0); // Should have a default config speed
+    assert(vehicles.position[myCar].x == 0);
+    assert(vehicles.targetNodeId[myCar] == 1);
+    assert(vehicles.speed[myCar] > 0); // Should have a default config speed
+    assert(!vehicles.IsEmergency(myCar));
+    assert(VehicleTypeFromName("Police") == VEHICLE_POLICE);
+    assert(VehicleTypeFromName("Spaceship") == VEHICLE_GENERIC);
 }
 
 // --- TEST 4: Spawner Functionality ---
@@ -51,15 +74,15 @@ TEST_CASE(TestVehicleSpawner) {
     graph.ConnectNodes(1, 2); // Need a path to exist
     graph.AddNode(2, {10,0,0}, ARC);
 
-    std::vector<std::unique_ptr<Vehicle>> vehicles;
+    VehicleStore vehicles;
     
     // Attempt to spawn a vehicle at Node 1
     // Assuming your Spawner class has a SpawnSpecific method
-    // If not, this test verifies the logic of adding to the vector
-    vehicles.push_back(std::make_unique<Taxi>((Vector3){0,0,0}, 2));
+    // If not, this test verifies the logic of adding to the store
+    vehicles.Add(VEHICLE_TAXI, (Vector3){0,0,0}, 2);
     
-    assert(vehicles.size() == 1);
-    assert(vehicles[0]->color.r == YELLOW.r); // Verify it's a Taxi
+    assert(vehicles.Size() == 1);
+    assert(vehicles.color[0].r == YELLOW.r); // Verify it's a Taxi
 }
 
 // --- TEST 5: Teleportation Logic ---
@@ -70,23 +93,1018 @@ TEST_CASE(TestTeleportationLogic) {
     graph.SetTeleportTarget(1, 2);
     graph.ConnectNodes(2, 3); // Path after teleport
 
-    std::vector<std::unique_ptr<Vehicle>> vehicles;
-    vehicles.push_back(std::make_unique<Car>((Vector3){0,0,0}, 1));
+    VehicleStore vehicles;
+    vehicles.Add(VEHICLE_CAR, (Vector3){0,0,0}, 1);
     
     // Simulate arrival at node 1 (TELEPORT)
     // The vehicle update logic should move it to node 2
-    vehicles[0]->update(0.1f, graph, vehicles);
+    UpdateVehicleMotion(vehicles, 0.1f, graph);
 
     // Position should now be at the teleport destination
-    assert(vehicles[0]->position.x == 100);
-    assert(vehicles[0]->position.z == 100);
+    assert(vehicles.position[0].x == 100);
+    assert(vehicles.position[0].z == 100);
+
+    // Landing zone taken: by a vehicle parked there, then by one that landed the same tick
+    VehicleStore waiting;
+    int parked = waiting.Add(VEHICLE_CAR, (Vector3){105,0,100}, 3);
+    int first = waiting.Add(VEHICLE_CAR, (Vector3){0,0,0}, 1);
+    waiting.speed[parked] = waiting.desiredSpeed[parked] = 0.0f;
+    UpdateVehicleMotion(waiting, 0.1f, graph);
+    assert(waiting.position[first].x == 0 && waiting.targetNodeId[first] == 1);
+    waiting.position[parked] = (Vector3){300,0,300};
+    int second = waiting.Add(VEHICLE_CAR, (Vector3){0,0,0}, 1);
+    UpdateVehicleMotion(waiting, 0.1f, graph);
+    assert(waiting.position[first].x == 100 && waiting.position[second].x == 0);
+}
+
+// --- TEST 6: Spatial Grid matches a brute-force scan ---
+TEST_CASE(TestSpatialGridQuery) {
+    VehicleStore vehicles;
+    for (int i = 0; i < 200; i++) {
+        float x = (float)((i * 37) % 240) - 120.0f;
+        float z = (float)((i * 91) % 240) - 120.0f;
+        vehicles.Add(VEHICLE_CAR, (Vector3){x, 0, z}, 1);
+    }
+    vehicles.finished[5] = 1; // Finished vehicles are never reported
+
+    SpatialGrid grid(25.0f);
+    grid.Build(vehicles);
+
+    std::vector<int> found;
+    Vector3 center = {10, 0, -20};
+    float radius = 60.0f;
+    grid.Query(center, radius, found);
+
+    std::vector<int> expected;
+    for (int i = 0; i < vehicles.Size(); i++) {
+        if (vehicles.finished[i]) continue;
+        if (Vector3Distance(vehicles.position[i], center) <= radius) expected.push_back(i);
+    }
+    assert(found == expected);
+}
+
+// --- TEST 7: RoadGraph Lookup of Missing Nodes ---
+TEST_CASE(TestRoadGraphInvalidLookup) {
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, START);
+    graph.AddNode(5, {50, 0, 0}, DECISION); // Gaps in the id range are allowed
+
+    // Duplicate and negative ids are refused without leaving a node behind
+    assert(!graph.AddNode(5, {99, 0, 0}, ARC));
+    assert(!graph.AddNode(-1, {0, 0, 0}, ARC));
+    assert(graph.GetAllNodes().size() == 2);
+
+    assert(graph.GetNode(5).pos.x == 50);
+    assert(graph.HasNode(5));
+    assert(!graph.HasNode(3));
+    assert(graph.FindNode(42) == nullptr);
+    assert(graph.FindNode(-1) == nullptr);
+
+    // Missing ids no longer silently return the first node
+    assert(!graph.GetNode(3).IsValid());
+    assert(graph.GetNode(3).id == INVALID_NODE_ID);
+
+    graph.Clear();
+    assert(!graph.HasNode(0));
+}
+
+// --- TEST 8: Headless Simulation is Reproducible ---
+// Runs the full core (spawner, lights, traffic, physics) without a window.
+TEST_CASE(TestHeadlessSimulationDeterministic) {
+    globalConfig = GetDefaultConfig();
+
+    std::vector<Vector3> firstRun;
+    for (int run = 0; run < 2; run++) {
+        SimRandom::Seed(42);
+        Simulation sim;
+        sim.Init();
+        sim.ApplyConfiguration();
+        for (int t = 0; t < 600; t++) sim.Update(1.0f / 60.0f);
+
+        assert(sim.GetVehicleCount() > 0);
+        for (int i = 0; i < sim.GetVehicleCount(); i++) {
+            Vector3 p = sim.GetVehicles().position[i];
+            if (run == 0) firstRun.push_back(p);
+            else assert(p.x == firstRun[i].x && p.z == firstRun[i].z);
+        }
+    }
+}
+
+// --- TEST 9: Fixed Timestep is Frame-Rate Independent ---
+// 60 fps at 1x and 20 fps at 1x must run the same fixed steps and end in the same state.
+TEST_CASE(TestFixedTimestepFrameRateIndependent) {
+    globalConfig = GetDefaultConfig();
+    const float step = SimulationConfig::FIXED_TIMESTEP;
+
+    SimRandom::Seed(7);
+    Simulation fast;
+    fast.Init();
+    fast.ApplyConfiguration();
+    for (int f = 0; f < 300; f++) fast.Advance(step, 1.0f);
+
+    SimRandom::Seed(7);
+    Simulation slow;
+    slow.Init();
+    slow.ApplyConfiguration();
+    for (int f = 0; f < 100; f++) slow.Advance(step * 3.0f, 1.0f);
+
+    assert(fast.GetStepCount() == 300);
+    assert(slow.GetStepCount() == 300);
+    assert(fast.GetVehicleCount() == slow.GetVehicleCount());
+    for (int i = 0; i < fast.GetVehicleCount(); i++) {
+        assert(fast.GetVehicles().position[i].x == slow.GetVehicles().position[i].x);
+        assert(fast.GetVehicles().position[i].z == slow.GetVehicles().position[i].z);
+    }
+
+    // Fast-forward: one long frame becomes many substeps, capped per frame
+    int steps = slow.Advance(1.0f, SimulationConfig::FAST_FORWARD_SPEED);
+    assert(steps == SimulationConfig::MAX_SUBSTEPS_PER_FRAME);
+    assert(slow.GetInterpolationAlpha() >= 0.0f && slow.GetInterpolationAlpha() <= 1.0f);
+}
+
+// --- TEST 10: Parallel Update Does Not Depend on the Thread Count ---
+TEST_CASE(TestParallelUpdateMatchesSerial) {
+    std::vector<Vector3> serialRun;
+    int threadCounts[] = { 1, 4 };
+    for (int run = 0; run < 2; run++) {
+        globalConfig = GetDefaultConfig();
+        for (auto& vc : globalConfig.vehicleConfigs) vc.count *= 6; // Enough vehicles to split into chunks
+        globalConfig.maxVehicles *= 6;
+        globalConfig.workerThreads = threadCounts[run];
+
+        SimRandom::Seed(11);
+        Simulation sim;
+        sim.Init();
+        sim.ApplyConfiguration();
+        assert(sim.GetThreadCount() == threadCounts[run]);
+        for (int t = 0; t < 900; t++) sim.Update(1.0f / 60.0f);
+
+        for (int i = 0; i < sim.GetVehicleCount(); i++) {
+            Vector3 p = sim.GetVehicles().position[i];
+            if (run == 0) serialRun.push_back(p);
+            else assert(p.x == serialRun[i].x && p.z == serialRun[i].z);
+        }
+        assert((int)serialRun.size() == sim.GetVehicleCount());
+    }
+    globalConfig = GetDefaultConfig();
+
+    // Resizing after a job: the new threads only run the jobs posted after they started
+    WorkerPool pool(2);
+    std::vector<int> hits(1000, 0);
+    WorkerPool::RangeFunc mark = [&](int begin, int end, int) {
+        for (int i = begin; i < end; i++) hits[i]++;
+    };
+    pool.ParallelFor((int)hits.size(), mark);
+    pool.Resize(4);
+    assert(pool.GetThreadCount() == 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Let them start before the next job
+    pool.ParallelFor((int)hits.size(), mark);
+    pool.Resize(3);
+    pool.ParallelFor((int)hits.size(), mark);
+    for (int h : hits) assert(h == 3);
+}
+
+// --- TEST 11: SIMD Car-Following Kernel Matches the Scalar Path ---
+TEST_CASE(TestFollowKernelMatchesScalar) {
+    SimRandom::Seed(5);
+    FollowCandidates cands;
+    for (int trial = 0; trial < 200; trial++) {
+        FollowSelf self;
+        self.px = (float)SimRandom::GetValue(-50, 50); self.py = 0; self.pz = (float)SimRandom::GetValue(-50, 50);
+        float a = SimRandom::GetValue(0, 359) * DEG2RAD;
+        self.fx = cosf(a); self.fy = 0; self.fz = sinf(a);
+        self.lateralOffset = (trial % 3 == 0) ? 3.5f : 0.0f;
+        self.length = 4.5f;
+        self.range = 30.0f + trial % 20;
+        self.checkCrossing = (trial % 5 != 0);
+
+        // Odd counts exercise the scalar tail after the SIMD batches
+        cands.Clear();
+        int count = trial % 37;
+        for (int c = 0; c < count; c++) {
+            float b = (trial % 2 == 0) ? a : SimRandom::GetValue(0, 3) * 90.0f * DEG2RAD;
+            cands.Add(c * 3, self.px + SimRandom::GetValue(-30, 30), 0, self.pz + SimRandom::GetValue(-30, 30),
+                      cosf(b), 0, sinf(b), (c % 4 == 0) ? 3.5f : 0.0f, (float)SimRandom::GetValue(2, 10));
+        }
+
+        FollowResult simd = FindLeader(self, cands);
+        FollowResult scalar = FindLeaderScalar(self, cands);
+        assert(simd.leader == scalar.leader);
+        assert(simd.gap == scalar.gap);
+        assert(simd.crossingStop == scalar.crossingStop);
+    }
+}
+
+// --- TEST 12: Profiler Scopes ---
+TEST_CASE(TestProfilerScopes) {
+    // Disabled: scopes record nothing
+    Profiler::SetEnabled(false);
+    { PROFILE_SCOPE("TestSection"); }
+    Profiler::EndFrame();
+    assert(Profiler::GetSectionCount() == 0);
+
+    // Enabled: one section, called twice this frame
+    Profiler::SetEnabled(true);
+    for (int i = 0; i < 2; i++) { PROFILE_SCOPE("TestSection"); }
+    Profiler::EndFrame();
+    assert(Profiler::GetSectionCount() == 1);
+    Profiler::SectionStats stats = Profiler::GetSection(0);
+    assert(stats.calls == 2);
+    assert(stats.avgMs >= 0.0f && stats.maxMs >= stats.avgMs);
+    Profiler::SetEnabled(false);
+}
+
+TEST_CASE(TestFrustumCulling) {
+    // Camera at 20 m looking down -Z, 45 deg field of view
+    Matrix view = MatrixLookAt({0, 0, 20}, {0, 0, 0}, {0, 1, 0});
+    Matrix proj = MatrixPerspective(45.0f * DEG2RAD, 16.0f / 9.0f, 0.01, 1000.0);
+    Frustum frustum = ExtractFrustum(MatrixMultiply(view, proj));
+
+    assert(SphereInFrustum(frustum, {0, 0, 0}, 1.0f));          // Straight ahead
+    assert(!SphereInFrustum(frustum, {0, 0, 40}, 1.0f));        // Behind the camera
+    assert(!SphereInFrustum(frustum, {200, 0, 0}, 1.0f));       // Far to the side
+    assert(SphereInFrustum(frustum, {200, 0, 0}, 200.0f));      // ...but big enough to reach in
+    assert(!SphereInFrustum(frustum, {0, 0, -2000}, 1.0f));     // Past the far plane
+
+    BoundingBox inside = { {-1, -1, -1}, {1, 1, 1} };
+    BoundingBox outside = { {100, -1, -1}, {102, 1, 1} };
+    BoundingBox straddling = { {-100, -1, -1}, {100, 1, 1} };
+    assert(BoxInFrustum(frustum, inside));
+    assert(!BoxInFrustum(frustum, outside));
+    assert(BoxInFrustum(frustum, straddling));
+}
+
+TEST_CASE(TestLightScheduler) {
+    RoadGraph graph;
+    graph.AddNode(5, {0, 0, 0}, ARC);
+    graph.AddNode(6, {0, 0, 5}, ARC);
+    graph.AddNode(7, {0, 0, 10}, ARC);
+
+    TrafficManager mgr(20.0f, 50.0f);
+    mgr.AddController(5, { 5, 6 });
+    mgr.ConfigureTrafficLight(5, {0, 0, 0}, 0.0f, 0.0f, 2.0f, 1.0f, 3.0f); // Green 2s, Yellow 1s, Red 3s
+    assert(mgr.GetControllerForNode(6) == 0);
+    assert(mgr.GetControllerForNode(7) == -1);
+    assert(mgr.GetControllerForNode(-1) == -1 && mgr.GetControllerForNode(1000) == -1);
+
+    VehicleStore vehicles; // No emergency vehicle
+    auto run = [&](float seconds) {
+        for (int s = 0; s < (int)(seconds * 10.0f + 0.5f); s++) mgr.UpdateLights(0.1f, graph, vehicles);
+    };
+    run(1.0f);
+    assert(mgr.GetLightStateForNode(5) == LIGHT_GREEN);
+    assert(graph.GetNode(6).lightState == LIGHT_GREEN);
+    run(1.5f); // t = 2.5
+    assert(mgr.GetLightStateForNode(5) == LIGHT_YELLOW);
+    run(1.0f); // t = 3.5
+    assert(mgr.GetLightStateForNode(6) == LIGHT_RED);
+    assert(graph.GetNode(5).lightState == LIGHT_RED);
+    assert(mgr.GetLightStateForNode(7) == LIGHT_NONE);
+    run(3.0f); // t = 6.5, the configured 3s red (not 15s)
+    assert(mgr.GetLightStateForNode(5) == LIGHT_GREEN);
+}
+
+TEST_CASE(TestSignalPlanGreenWave) {
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, ARC);
+    graph.AddNode(1, {100, 0, 0}, ARC);
+    graph.AddNode(2, {0, 0, 10}, ARC);
+    graph.ConnectNodes(0, 1);
+
+    TrafficManager mgr(20.0f, 50.0f);
+    mgr.AddController(0, { 0 });
+    mgr.AddController(1, { 1 });
+    mgr.AddController(2, { 2 });
+
+    // Intersection A: groups 0 and 2 cross, one stage each
+    mgr.AddSignalPlan(10, { 0, 2 }, 3.0f, 1.0f);
+    mgr.SetConflict(10, 0, 2);
+    assert(!mgr.AddStage(10, { 0, 2 }, 20.0f));
+    assert(mgr.AddStage(10, { 0 }, 20.0f));
+    assert(mgr.AddStage(10, { 2 }, 20.0f));
+    const SignalPlan* planA = mgr.GetSignalPlan(10);
+    assert(planA && planA->GetCycleLength() == 48.0f);
+    float start = 0.0f, green = 0.0f;
+    assert(planA->GetGreenWindow(2, start, green) && start == 24.0f && green == 20.0f);
+
+    // Intersection B, 100 m downstream, same cycle
+    mgr.AddSignalPlan(11, { 1 }, 3.0f, 1.0f);
+    mgr.AddStage(11, { 1 }, 44.0f);
+    assert(mgr.SolveGreenWave(graph, { 0, 1 }, 10.0f));
+    assert(std::fabs(mgr.GetSignalPlan(11)->offset - 10.0f) < 0.001f); // 100 m at 10 m/s
+
+    VehicleStore vehicles;
+    for (int s = 0; s < 95; s++) mgr.UpdateLights(0.1f, graph, vehicles); // t = 9.5
+    assert(mgr.GetLightStateForNode(0) == LIGHT_GREEN);
+    assert(mgr.GetLightStateForNode(2) == LIGHT_RED);
+    assert(mgr.GetLightStateForNode(1) == LIGHT_RED);
+    for (int s = 0; s < 10; s++) mgr.UpdateLights(0.1f, graph, vehicles);  // t = 10.5
+    assert(mgr.GetLightStateForNode(1) == LIGHT_GREEN);
+    for (int s = 0; s < 150; s++) mgr.UpdateLights(0.1f, graph, vehicles); // t = 25.5
+    assert(mgr.GetLightStateForNode(0) == LIGHT_RED);
+    assert(mgr.GetLightStateForNode(2) == LIGHT_GREEN);
+}
+
+TEST_CASE(TestActuatedSignals) {
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, ARC);
+    graph.AddNode(2, {0, 0, 10}, ARC);
+    graph.AddNode(3, {0, 0, -10}, ARC);
+
+    TrafficManager mgr(20.0f, 50.0f);
+    mgr.AddController(0, { 0 });
+    mgr.AddController(2, { 2 });
+    mgr.AddSignalPlan(10, { 0, 2 }, 3.0f, 1.0f);
+    mgr.SetConflict(10, 0, 2);
+    mgr.AddStage(10, { 0 }, 20.0f);
+    mgr.AddStage(10, { 2 }, 20.0f);
+    mgr.SetControlMode(SIGNAL_ACTUATED);
+
+    // One stopped car waiting at node 2, nobody for node 0
+    VehicleStore vehicles;
+    int car = vehicles.Add(VEHICLE_CAR, {0, 0, 20}, 2);
+    vehicles.speed[car] = 0.0f;
+
+    for (int s = 0; s < 20; s++) mgr.UpdateLights(0.1f, graph, vehicles); // t = 2: after the all-red
+    assert(mgr.GetLightStateForNode(2) == LIGHT_GREEN); // Empty stage {0} skipped
+    assert(mgr.GetLightStateForNode(0) == LIGHT_RED);
+    assert(graph.GetNode(2).lightState == LIGHT_GREEN);
+
+    const ApproachStats& stats = mgr.GetController(mgr.GetControllerForNode(2)).stats;
+    assert(stats.approaching == 1 && stats.queued == 1);
+    assert(stats.totalDelay > 1.9 && stats.served == 0);
+
+    // The car crosses the stop line
+    vehicles.targetNodeId[car] = 3;
+    mgr.UpdateLights(0.1f, graph, vehicles);
+    assert(stats.served == 1 && stats.approaching == 0);
+    assert(stats.GetAverageDelay() > 1.9f);
+
+    // Fixed time: no per-approach scan unless the stats are asked for
+    mgr.SetControlMode(SIGNAL_FIXED_TIME);
+    mgr.ResetApproachStats();
+    vehicles.targetNodeId[car] = 2;
+    mgr.UpdateLights(0.1f, graph, vehicles);
+    vehicles.targetNodeId[car] = 3;
+    mgr.UpdateLights(0.1f, graph, vehicles);
+    assert(stats.served == 0 && stats.totalDelay == 0.0);
+
+    mgr.SetApproachStats(true);
+    vehicles.targetNodeId[car] = 2;
+    mgr.UpdateLights(0.1f, graph, vehicles);
+    vehicles.targetNodeId[car] = 3;
+    mgr.UpdateLights(0.1f, graph, vehicles);
+    assert(stats.served == 1);
+}
+
+TEST_CASE(TestRouterAStarMatchesCH) {
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    Router astar, ch;
+    astar.Build(graph);
+    ch.Build(graph);
+    ch.BuildContractionHierarchy();
+    assert(ch.HasContractionHierarchy() && !astar.HasContractionHierarchy());
+
+    // Every pair: same reachability and length, and the CH path is drivable
+    std::vector<int> pathA, pathC;
+    int routes = 0;
+    for (const Node& from : graph.GetAllNodes()) {
+        for (const Node& to : graph.GetAllNodes()) {
+            bool foundA = astar.FindRouteAStar(from.id, to.id, pathA);
+            bool foundC = ch.FindRouteCH(from.id, to.id, pathC);
+            assert(foundA == foundC);
+            if (!foundA) continue;
+            routes++;
+            assert(fabsf(astar.GetLastCost() - ch.GetLastCost()) < 0.01f);
+            assert(pathC.front() == from.id && pathC.back() == to.id);
+            for (size_t k = 0; k + 1 < pathC.size(); k++) {
+                const Node& n = graph.GetNode(pathC[k]);
+                int next = (n.type == TELEPORT) ? graph.GetNode(n.teleportTargetId).nextNodes[0] : -1;
+                bool connected = next == pathC[k + 1];
+                for (int id : n.nextNodes) connected = connected || id == pathC[k + 1];
+                assert(connected);
+            }
+        }
+    }
+    assert(routes > 0);
+
+    // Branch indices only at the nodes that have a choice
+    std::vector<unsigned char> choices;
+    astar.FindRouteAStar(pathA.front(), pathA.back(), pathA);
+    MakeRouteChoices(graph, pathA, choices);
+    size_t expected = 0;
+    for (size_t k = 0; k + 1 < pathA.size(); k++) {
+        const Node& n = graph.GetNode(pathA[k]);
+        if (n.type != TELEPORT && n.nextNodes.size() > 1) expected++;
+    }
+    assert(choices.size() == expected);
+}
+
+TEST_CASE(TestTripRouting) {
+    globalConfig = GetDefaultConfig();
+    globalConfig.routing = ROUTING_TRIPS;
+    SimRandom::Seed(7);
+    Simulation sim;
+    sim.Init();
+    sim.ApplyConfiguration();
+    for (int t = 0; t < 600; t++) sim.Update(1.0f / 60.0f);
+
+    // Everybody got a trip towards an exit (or random turns when none is reachable)
+    const VehicleStore& vehicles = sim.GetVehicles();
+    const std::vector<int>& exits = sim.GetRouter().GetExitNodes();
+    assert(vehicles.Size() > 0);
+    for (int i = 0; i < vehicles.Size(); i++) {
+        int dest = vehicles.tripDestination[i];
+        assert(dest == VehicleStore::TRIP_RANDOM || std::find(exits.begin(), exits.end(), dest) != exits.end());
+        assert(vehicles.routeCursor[i] <= vehicles.routeEnd[i]);
+    }
+    globalConfig = GetDefaultConfig();
+}
+
+TEST_CASE(TestFrozenAdjacency) {
+    // 0 -> {1, 2}, 1 -> 2, 2 -> 7 (unknown id), 3 has no road
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, DECISION);
+    graph.AddNode(1, {3, 0, 4}, ARC);
+    graph.AddNode(2, {0, 0, 10}, ARC);
+    graph.AddNode(3, {5, 0, 5}, ARC);
+    graph.ConnectNodes(0, 1);
+    graph.ConnectNodes(0, 2);
+    graph.ConnectNodes(1, 2);
+    graph.ConnectNodes(2, 7);
+    assert(!graph.IsFrozen());
+
+    graph.Freeze();
+    assert(graph.IsFrozen());
+    assert(graph.GetEdgeCount() == 4);
+    // Offsets follow the node order, targets the nextNodes order
+    const std::vector<Node>& nodes = graph.GetAllNodes();
+    for (int k = 0; k < (int)nodes.size(); k++) {
+        assert(graph.GetEdgeEnd(k) - graph.GetEdgeBegin(k) == (int)nodes[k].nextNodes.size());
+        for (int b = 0; b < (int)nodes[k].nextNodes.size(); b++) {
+            int e = graph.GetEdgeBegin(k) + b;
+            assert(graph.GetEdge(nodes[k].id, b) == e);
+            assert(graph.GetEdgeTarget(e) == graph.GetNodeIndex(nodes[k].nextNodes[b]));
+        }
+    }
+    assert(fabsf(graph.GetEdgeLength(graph.GetEdge(0, 0)) - 5.0f) < 1e-4f);
+    assert(fabsf(graph.GetEdgeLength(graph.GetEdge(0, 1)) - 10.0f) < 1e-4f);
+    assert(graph.GetEdgeTarget(graph.GetEdge(2, 0)) == -1);
+    assert(graph.GetEdgeLength(graph.GetEdge(2, 0)) == 0.0f);
+    assert(graph.GetEdge(3, 0) == -1 && graph.GetEdge(0, 2) == -1 && graph.GetEdge(9, 0) == -1);
+
+    // A new road thaws the graph; the next lookup repacks it (edges after it shift)
+    graph.ConnectNodes(0, 3);
+    assert(!graph.IsFrozen());
+    assert(graph.GetEdge(1, 0) == 3);
+    assert(graph.IsFrozen());
+    assert(graph.GetEdgeTarget(graph.GetEdge(0, 2)) == graph.GetNodeIndex(3));
+}
+
+TEST_CASE(TestLiveTravelTimes) {
+    // 0 -> 1 -> 3 (short) and 0 -> 2 -> 3 (longer), 3 is the exit
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, DECISION);
+    graph.AddNode(1, {30, 0, 0}, ARC);
+    graph.AddNode(2, {0, 0, 40}, ARC);
+    graph.AddNode(3, {30, 0, 40}, TELEPORT);
+    graph.AddNode(4, {-20, 0, 0}, START);
+    graph.ConnectNodes(0, 1);
+    graph.ConnectNodes(0, 2);
+    graph.ConnectNodes(1, 3);
+    graph.ConnectNodes(2, 3);
+    graph.ConnectNodes(4, 0);
+    graph.SetTeleportTarget(3, 4);
+    assert(fabsf(graph.GetEdgeTravelTime(0, 0) - 30.0f / RoadGraph::FREE_FLOW_SPEED) < 1e-4f);
+
+    Router router;
+    router.Build(graph);
+    router.UpdateExitTimes(graph, 1000);
+    assert(router.ChooseFastestBranch(graph, 0, 3) == 0); // Empty roads: shortest
+
+    // Jam on 0 -> 1: its time rises, the other branch becomes faster
+    for (int t = 0; t < 600; t++) {
+        graph.AddEdgeSpeedSample(0, 0, 0.0f);
+        graph.UpdateTravelTimes(1.0f / 60.0f);
+    }
+    float jammed = graph.GetEdgeTravelTime(0, 0);
+    assert(jammed > 10.0f);
+    assert(graph.GetEdgeTravelTime(0, 1) == graph.GetEdgeFreeFlowTime(0, 1));
+    router.UpdateExitTimes(graph, 1000);
+    assert(router.ChooseFastestBranch(graph, 0, 3) == 1);
+
+    // Nobody on it any more: back toward free flow
+    graph.UpdateTravelTimes(120.0f);
+    assert(graph.GetEdgeTravelTime(0, 0) < graph.GetEdgeFreeFlowTime(0, 0) + 0.01f);
+
+    // Weeks of simulated time later the clock still moves by single ticks
+    graph.UpdateTravelTimes(2000000.0f);
+    double before = graph.GetTravelClock();
+    graph.UpdateTravelTimes(1.0f / 60.0f);
+    assert(graph.GetTravelClock() - before > 0.016 && graph.GetTravelClock() - before < 0.017);
+}
+
+TEST_CASE(TestLaneLeader) {
+    // Curve 0 -> 1 -> 2 (90 degree turn at 1), and a parallel road 3 -> 4 two meters to the side
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, ARC);
+    graph.AddNode(1, {20, 0, 0}, ARC);
+    graph.AddNode(2, {20, 0, 20}, ARC);
+    graph.AddNode(3, {0, 0, 2}, ARC);
+    graph.AddNode(4, {40, 0, 2}, ARC);
+    graph.ConnectNodes(0, 1);
+    graph.ConnectNodes(1, 2);
+    graph.ConnectNodes(3, 4);
+
+    VehicleStore vehicles;
+    auto addOnRoad = [&](Vector3 pos, int from, int to, Vector3 fwd) {
+        int v = vehicles.Add(VEHICLE_CAR, pos, to);
+        vehicles.edgeFromId[v] = from;
+        vehicles.edgeBranch[v] = 0;
+        vehicles.forward[v] = fwd;
+        return v;
+    };
+    int me = addOnRoad({5, 0, 0}, 0, 1, {1, 0, 0});
+    int sideCar = addOnRoad({12, 0, 2}, 3, 4, {1, 0, 0});   // Next lane, right in front of us geometrically
+    int afterTurn = addOnRoad({20, 0, 8}, 1, 2, {0, 0, 1});  // Our real leader, already around the corner
+    int behind = addOnRoad({1, 0, 0}, 0, 1, {1, 0, 0});
+
+    TrafficManager mgr(20.0f, 50.0f);
+    mgr.UpdateVehicles(1.0f / 60.0f, vehicles, graph);
+    assert(mgr.GetLaneLeader(vehicles, graph, me) == afterTurn);
+    assert(mgr.GetLaneLeader(vehicles, graph, behind) == me);
+    assert(mgr.GetLaneLeader(vehicles, graph, sideCar) == -1);
+    assert(mgr.GetLaneLeader(vehicles, graph, afterTurn) == -1);
+
+    // Diverge at 11 (-> 12 or -> 13): a car on the branch we will not take does not stop us
+    graph.AddNode(10, {0, 0, 50}, ARC);
+    graph.AddNode(11, {20, 0, 50}, DECISION);
+    graph.AddNode(12, {40, 0, 50}, ARC);
+    graph.AddNode(13, {40, 0, 70}, ARC);
+    graph.ConnectNodes(10, 11);
+    graph.ConnectNodes(11, 12);
+    graph.ConnectNodes(11, 13);
+    int routed = addOnRoad({10, 0, 50}, 10, 11, {1, 0, 0});
+    int other = vehicles.Add(VEHICLE_CAR, {25, 0, 55}, 13);
+    vehicles.edgeFromId[other] = 11;
+    vehicles.edgeBranch[other] = 1;
+
+    vehicles.SetRoute(routed, 12, { 0 });
+    mgr.UpdateVehicles(1.0f / 60.0f, vehicles, graph);
+    assert(mgr.GetLaneLeader(vehicles, graph, routed) == -1);
+    vehicles.SetRoute(routed, 13, { 1 });
+    assert(mgr.GetLaneLeader(vehicles, graph, routed) == other);
+    vehicles.SetRoute(routed, VehicleStore::TRIP_RANDOM, {}); // Random turns: either branch
+    assert(mgr.GetLaneLeader(vehicles, graph, routed) == other);
+}
+
+TEST_CASE(TestFollowModels) {
+    const float dt = 1.0f / 60.0f;
+    FollowContext ctx = { dt, 4.0f, 20.0f, 0 };
+    for (int m = 0; m < FOLLOW_MODEL_COUNT; m++) {
+        FollowModelFunc model = GetFollowModelFunc((FollowModel)m);
+        VehicleStore vehicles;
+        int free = vehicles.Add(VEHICLE_CAR, {0, 0, 0}, 1);
+        int follower = vehicles.Add(VEHICLE_CAR, {0, 0, 0}, 1);
+        vehicles.speed[follower] = 12.0f;
+        int indices[2] = { free, follower };
+
+        // free: empty road. follower: stopped leader 60 m ahead
+        FollowInputs in;
+        in.Resize(2);
+        in.gap[free] = NO_FOLLOW_GAP;
+        in.stopGap[free] = in.stopGap[follower] = NO_FOLLOW_GAP;
+        in.leaderSpeed[free] = in.leaderSpeed[follower] = 0.0f;
+        float gap = 60.0f;
+        for (int t = 0; t < 60 * 60; t++) {
+            in.gap[follower] = gap;
+            model(indices, 2, in, ctx, vehicles);
+            ctx.step++;
+            gap -= vehicles.speed[follower] * dt;
+            assert(vehicles.speed[free] >= 0.0f && vehicles.speed[follower] >= 0.0f);
+            assert(gap > 0.0f);
+        }
+        assert(fabsf(vehicles.speed[free] - vehicles.desiredSpeed[free]) < 0.1f * vehicles.desiredSpeed[free]);
+        assert(vehicles.speed[follower] < 0.1f);
+        assert(gap < 10.0f);
+    }
+
+    // Same model (IDM), a bus pulls away slower than a car
+    VehicleStore vehicles;
+    int car = vehicles.Add(VEHICLE_CAR, {0, 0, 0}, 1);
+    int bus = vehicles.Add(VEHICLE_BUS, {0, 0, 0}, 1);
+    vehicles.desiredSpeed[car] = vehicles.desiredSpeed[bus] = 15.0f;
+    FollowInputs in;
+    in.Resize(2);
+    for (int i = 0; i < 2; i++) {
+        in.gap[i] = in.stopGap[i] = NO_FOLLOW_GAP;
+        in.leaderSpeed[i] = 0.0f;
+    }
+    int indices[2] = { car, bus };
+    for (int t = 0; t < 120; t++) GetFollowModelFunc(FOLLOW_IDM)(indices, 2, in, ctx, vehicles);
+    assert(vehicles.speed[bus] < vehicles.speed[car]);
+    assert(FollowModelFromName("gipps") == FOLLOW_GIPPS && FollowModelFromName("nope") == FOLLOW_BY_TYPE);
+}
+
+TEST_CASE(TestMesoEngine) {
+    // 0 -> 1 -> 2 (TELEPORT back to 0), two 75 m roads: 10 vehicles each, 5 s at car speed
+    RoadGraph graph;
+    graph.AddNode(0, {0, 0, 0}, START);
+    graph.AddNode(1, {75, 0, 0}, DECISION);
+    graph.AddNode(2, {150, 0, 0}, TELEPORT);
+    graph.ConnectNodes(0, 1);
+    graph.ConnectNodes(1, 2);
+    graph.SetTeleportTarget(2, 0);
+
+    MesoEngine meso;
+    meso.Build(graph);
+    VehicleStore vehicles;
+    auto insert = [&]() {
+        int v = vehicles.Add(VEHICLE_CAR, {0, 0, 0}, 1);
+        vehicles.edgeFromId[v] = 0;
+        vehicles.edgeBranch[v] = 0;
+        vehicles.desiredSpeed[v] = 15.0f;
+        meso.Insert(vehicles, v);
+        return v;
+    };
+    int first = insert();
+    int second = insert();
+
+    // Free flow: the first one reaches node 1 after 5 s, the second one SATURATION_HEADWAY later
+    for (int t = 0; t < 4; t++) meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[first] == 1 && meso.GetMoveCount() == 0);
+    meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[first] == 2 && vehicles.targetNodeId[second] == 1);
+    meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[second] == 1);
+    meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[second] == 2);
+
+    // Through the teleport: one trip each, back on the first road
+    for (int t = 0; t < 5; t++) meso.Update(1.0f, vehicles, graph);
+    assert(meso.GetTripCount() == 2);
+    assert(vehicles.targetNodeId[first] == 1 && vehicles.edgeFromId[first] == 0);
+
+    // Red at node 1 holds them at the stop line, green lets them go
+    graph.GetNode(1).lightState = LIGHT_RED;
+    for (int t = 0; t < 10; t++) meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[first] == 1 && vehicles.speed[first] == 0.0f);
+    assert(fabsf(vehicles.position[first].x - 75.0f) < 0.01f);
+    assert(fabsf(vehicles.position[second].x - (75.0f - MesoEngine::JAM_SPACING)) < 0.01f);
+    graph.GetNode(1).lightState = LIGHT_GREEN;
+    meso.Update(1.0f, vehicles, graph);
+    assert(vehicles.targetNodeId[first] == 2);
+
+    // Storage: 75 m hold 10 vehicles
+    int stored = 1;
+    while (meso.HasRoom(0, 0)) {
+        insert();
+        stored++;
+    }
+    assert(stored == 10);
+
+    // Two heads blocked on different full roads: once the first pushes in (STUCK_TIME),
+    // the second waits on its own road and leaves as soon as that one has room
+    RoadGraph fork;
+    fork.AddNode(0, {0, 0, 0}, START);
+    fork.AddNode(1, {75, 0, 0}, DECISION);
+    fork.AddNode(2, {80, 0, 0}, DECISION);  // 1 -> 2: one vehicle, dead end
+    fork.AddNode(3, {75, 0, 5}, DECISION);  // 1 -> 3: one vehicle, held by a red light
+    fork.AddNode(4, {75, 0, 80}, ARC);
+    fork.ConnectNodes(0, 1);
+    fork.ConnectNodes(1, 2);
+    fork.ConnectNodes(1, 3);
+    fork.ConnectNodes(3, 4);
+    fork.GetNode(3).lightState = LIGHT_RED;
+    MesoEngine queues;
+    queues.Build(fork);
+    VehicleStore cars;
+    auto put = [&](int from, int branch, std::vector<unsigned char> route) {
+        int v = cars.Add(VEHICLE_CAR, fork.GetNode(from).pos, fork.GetNode(from).nextNodes[branch]);
+        cars.edgeFromId[v] = from;
+        cars.edgeBranch[v] = branch;
+        cars.desiredSpeed[v] = 15.0f;
+        cars.SetRoute(v, 4, route);
+        queues.Insert(cars, v);
+        return v;
+    };
+    put(1, 0, {});
+    put(1, 1, {});
+    put(0, 0, { 0 });           // Ready at 5 s, pushes into 1 -> 2 at 15 s
+    int toC = put(0, 0, { 1 }); // Head at 17 s, waits for 1 -> 3
+    for (int t = 0; t < 20; t++) queues.Update(1.0f, cars, fork);
+    assert(queues.GetStuckCount() == 1 && cars.targetNodeId[toC] == 1);
+    fork.GetNode(3).lightState = LIGHT_GREEN; // 1 -> 3 frees its room
+    queues.Update(1.0f, cars, fork);
+    assert(cars.targetNodeId[toC] == 3 && queues.GetStuckCount() == 1);
+
+    // Whole simulation on the queue engine: same run twice, vehicles make trips
+    globalConfig = GetDefaultConfig();
+    globalConfig.engine = ENGINE_MESO;
+    long trips[2];
+    std::vector<int> targets;
+    for (int run = 0; run < 2; run++) {
+        SimRandom::Seed(5);
+        Simulation sim;
+        sim.Init();
+        sim.ApplyConfiguration();
+        for (int t = 0; t < 3600; t++) sim.Update(1.0f / 60.0f);
+        assert(sim.GetVehicleCount() > 0);
+        trips[run] = sim.GetMesoEngine().GetTripCount();
+        for (int i = 0; i < sim.GetVehicleCount(); i++) {
+            if (run == 0) targets.push_back(sim.GetVehicles().targetNodeId[i]);
+            else assert(targets[i] == sim.GetVehicles().targetNodeId[i]);
+        }
+    }
+    assert(trips[0] > 0 && trips[0] == trips[1]);
+    globalConfig = GetDefaultConfig();
+}
+
+TEST_CASE(TestVehiclePool) {
+    VehicleStore vehicles;
+    int a = vehicles.Add(VEHICLE_CAR, {0, 0, 0}, 1);
+    int b = vehicles.Add(VEHICLE_POLICE, {10, 0, 0}, 1);
+    int c = vehicles.Add(VEHICLE_BUS, {20, 0, 0}, 1);
+    VehicleHandle hb = vehicles.GetHandle(b);
+    assert(vehicles.Resolve(hb) == b && vehicles.GetEmergencyCount() == 1);
+
+    // Removal frees the slot in place: the others keep their index
+    vehicles.Remove(b);
+    vehicles.Remove(b); // Twice is harmless
+    assert(vehicles.finished[b] && vehicles.Resolve(hb) == -1);
+    assert(vehicles.GetLiveCount() == 2 && vehicles.Size() == 3 && vehicles.GetEmergencyCount() == 0);
+    assert(vehicles.Resolve(vehicles.GetHandle(a)) == a && vehicles.Resolve(vehicles.GetHandle(c)) == c);
+
+    // The next vehicle reuses it, the old handle stays stale
+    int d = vehicles.Add(VEHICLE_TRUCK, {5, 0, 5}, 2);
+    assert(d == b && !vehicles.finished[d] && vehicles.type[d] == VEHICLE_TRUCK && vehicles.edgeFromId[d] == -1);
+    assert(vehicles.Resolve(hb) == -1 && vehicles.Resolve(vehicles.GetHandle(d)) == d);
+
+    VehiclePoolStats stats = vehicles.GetPoolStats();
+    assert(stats.slots == 3 && stats.live == 3 && stats.freeSlots == 0);
+    assert(stats.spawned == 4 && stats.recycled == 1 && stats.removed == 1 && stats.bytes > 0);
+
+    // Vehicles leaving at the exits come back through the spawner: the store stops growing
+    for (int engine = 0; engine < 2; engine++) {
+        globalConfig = GetDefaultConfig();
+        globalConfig.engine = engine == 0 ? ENGINE_MICRO : ENGINE_MESO;
+        globalConfig.leaveAtExits = true;
+        SimRandom::Seed(9);
+        Simulation sim;
+        sim.Init();
+        sim.ApplyConfiguration();
+        int peak = 0;
+        for (int t = 0; t < 7200; t++) {
+            sim.Update(1.0f / 60.0f);
+            if (sim.GetVehicles().Size() > peak) peak = sim.GetVehicles().Size();
+        }
+        VehiclePoolStats pool = sim.GetVehicles().GetPoolStats();
+        assert(pool.removed > 0 && pool.recycled > 0);
+        assert(pool.slots == peak && pool.live == pool.slots - pool.freeSlots);
+        assert(pool.slots < pool.spawned);
+    }
+    globalConfig = GetDefaultConfig();
+}
+
+static bool SameGraph(const RoadGraph& a, const RoadGraph& b) {
+    if (a.GetAllNodes().size() != b.GetAllNodes().size()) return false;
+    for (const Node& n : a.GetAllNodes()) {
+        const Node& m = b.GetNode(n.id);
+        if (!m.IsValid() || m.type != n.type || m.teleportTargetId != n.teleportTargetId || m.nextNodes != n.nextNodes) return false;
+        if (Vector3Distance(m.pos, n.pos) > 1e-4f) return false;
+    }
+    return true;
+}
+
+TEST_CASE(TestRoadNetworkFile) {
+    RoadGraph builtIn;
+    InitializeRoadNetwork(builtIn);
+
+    // The shipped map is the built-in scene, branch order included
+    RoadNetworkFile text;
+    assert(text.Load("assets/maps/roundabout.roadnet"));
+    assert(text.GetControllerCount() == 4);
+    RoadGraph fromText;
+    text.BuildGraph(fromText);
+    assert(SameGraph(builtIn, fromText));
+
+    // Binary round trip (mmapped)
+    const char* binPath = "tests/roundabout_test.roadbin";
+    assert(text.SaveBinary(binPath));
+    RoadNetworkFile binary;
+    assert(binary.Load(binPath));
+    assert(binary.GetNodeCount() == text.GetNodeCount() && binary.GetEdgeCount() == text.GetEdgeCount());
+    RoadGraph fromBinary;
+    binary.BuildGraph(fromBinary);
+    assert(SameGraph(builtIn, fromBinary));
+
+    // Same lights as Simulation::Init
+    TrafficManager lights;
+    binary.ConfigureLights(lights);
+    assert(lights.GetControllerCount() == 4);
+    const SignalPlan* plan = lights.GetSignalPlan(16);
+    assert(plan && plan->stages.size() == 1 && plan->offset == 20.0f && plan->GetCycleLength() == 33.0f);
+    binary.Unload();
+
+    // A blob edge to a node that does not exist is refused (tables are sized by the ids)
+    std::vector<unsigned char> blob;
+    FILE* f = fopen(binPath, "rb");
+    for (int ch; (ch = fgetc(f)) != EOF; ) blob.push_back((unsigned char)ch);
+    fclose(f);
+    int32_t farAway = 2000000000;
+    memcpy(&blob[sizeof(RoadNetBlob::Header) + text.GetNodeCount() * sizeof(RoadNetBlob::NodeRecord)], &farAway, sizeof(farAway));
+    f = fopen(binPath, "wb");
+    fwrite(blob.data(), 1, blob.size(), f);
+    fclose(f);
+    assert(!binary.Load(binPath) && binary.GetError().find("unknown node") != std::string::npos);
+    remove(binPath);
+
+    // Errors name the line; a bad blob is refused
+    const char* badPath = "tests/bad_test.roadnet";
+    f = fopen(badPath, "w");
+    fprintf(f, "node 0 0 0 0 start\nnode 1 10 0 0 decision\nconnect 0 1\nconnect 7 1\n");
+    fclose(f);
+    RoadNetworkFile bad;
+    assert(!bad.Load(badPath) && !bad.IsLoaded());
+    assert(bad.GetError().find(":4:") != std::string::npos);
+    f = fopen(badPath, "w");
+    fprintf(f, "node 0 0 0 0 start\nnode 2000000000 10 0 0 decision\n"); // Would size the id table to 8 GB
+    fclose(f);
+    assert(!bad.Load(badPath) && bad.GetError().find(":2:") != std::string::npos);
+    f = fopen(badPath, "w");
+    fprintf(f, "node 0 0 0 0 teleport\nteleport 0 9\n");
+    fclose(f);
+    assert(!bad.Load(badPath) && bad.GetError().find(":2:") != std::string::npos);
+
+    // Dense ids in any order: 2000 nodes declared from the highest id down
+    f = fopen(badPath, "w");
+    for (int id = 1999; id >= 0; id--) fprintf(f, "node %d %d 0 0 decision\n", id, id);
+    fprintf(f, "connect 1999 0\n");
+    fclose(f);
+    RoadNetworkFile reversed;
+    assert(reversed.Load(badPath) && reversed.GetNodeCount() == 2000 && reversed.GetEdgeCount() == 1);
+    f = fopen(badPath, "wb");
+    fwrite(RoadNetBlob::MAGIC, 1, sizeof(RoadNetBlob::MAGIC), f);
+    fclose(f);
+    assert(!bad.Load(badPath));
+    remove(badPath);
+}
+
+TEST_CASE(TestDemand) {
+    // Profile: linear between the points, wrapping over midnight
+    DemandModel demand;
+    demand.AddProfilePoint(18.0f, 1.0f);
+    demand.AddProfilePoint(6.0f, 0.5f);
+    assert(fabsf(demand.GetFactor(12.0f) - 0.75f) < 1e-5f);
+    assert(fabsf(demand.GetFactor(0.0f) - 0.75f) < 1e-5f);
+    assert(fabsf(demand.GetFactor(30.0f) - 0.5f) < 1e-5f);
+
+    // Rows the map cannot serve are dropped; arrivals follow the rates (Poisson)
+    RoadGraph graph;
+    InitializeRoadNetwork(graph);
+    demand.Clear();
+    demand.AddTrips(0, 28, 2700.0f);
+    demand.AddTrips(0, 6, 900.0f);
+    demand.AddTrips(1, 28, 1800.0f);
+    demand.AddTrips(0, 2, 100.0f);      // Not an exit
+    demand.AddTrips(999, 28, 100.0f);   // No such node
+    SimRandom::Seed(3);
+    demand.Prepare(graph);
+    assert(demand.GetRowCount() == 3 && demand.GetDroppedRowCount() == 2);
+    assert(fabsf(demand.GetTotalRate() - 5400.0f) < 1e-3f);
+
+    std::vector<DemandArrival> arrivals;
+    for (int t = 0; t < 3600; t++) demand.Generate(1.0f, arrivals); // One hour, 1.5 veh/s expected
+    int toSix = 0, fromOne = 0;
+    for (size_t k = 0; k < arrivals.size(); k++) {
+        if (k > 0) assert(arrivals[k].time >= arrivals[k - 1].time);
+        if (arrivals[k].destinationId == 6) toSix++;
+        if (arrivals[k].originId == 1) fromOne++;
+        assert(arrivals[k].originId == 1 ? arrivals[k].destinationId == 28 : true);
+    }
+    assert(arrivals.size() > 5000 && arrivals.size() < 5800);
+    assert(toSix > 700 && toSix < 1100 && fromOne > 1600 && fromOne < 2000);
+
+    // A zero factor stops the arrivals, the clock keeps the time of day
+    demand.AddProfilePoint(0.0f, 0.0f);
+    demand.SetStartHour(10.0f);
+    demand.Prepare(graph);
+    arrivals.clear();
+    for (int t = 0; t < 600; t++) demand.Generate(1.0f, arrivals);
+    assert(arrivals.empty() && fabsf(demand.GetTimeOfDay() - 10.1667f) < 1e-3f);
+
+    // Spawner: one FIFO per start node, only the heads are tried, a blocked node does not hold the others
+    VehicleSpawner spawner;
+    VehicleStore vehicles;
+    spawner.Enqueue({ VEHICLE_CAR, 0 });
+    spawner.Enqueue({ VEHICLE_BUS, 0 });
+    spawner.Enqueue({ VEHICLE_TRUCK, 26, 28 });
+    spawner.Enqueue({ VEHICLE_GENERIC, 1 }); // Never spawns
+    assert(spawner.GetWaitingCount() == 3);
+    spawner.Update(graph, vehicles);
+    assert(vehicles.Size() == 2 && vehicles.type[0] == VEHICLE_CAR && vehicles.type[1] == VEHICLE_TRUCK);
+    assert(vehicles.tripRequest[1] == 28 && vehicles.tripRequest[0] == -1);
+    spawner.Update(graph, vehicles); // The car still sits on node 0
+    assert(vehicles.Size() == 2 && spawner.GetWaitingCount() == 1);
+    vehicles.position[0] = graph.GetNode(2).pos;
+    spawner.Update(graph, vehicles);
+    assert(vehicles.Size() == 3 && vehicles.type[2] == VEHICLE_BUS && spawner.GetWaitingCount() == 0);
+
+    // Whole simulation from a demand file: vehicles drive to the exit they were asked for and leave
+    const char* path = "tests/demand_test.od";
+    FILE* f = fopen(path, "w");
+    fprintf(f, "# test\nstart 8\nprofile 0 1\nmix Car 1\nod 0 28 1800\nod 26 28 1800\n");
+    fclose(f);
+    globalConfig = GetDefaultConfig();
+    globalConfig.demandPath = path;
+    globalConfig.routing = ROUTING_TRIPS;
+    SimRandom::Seed(8);
+    Simulation sim;
+    sim.Init();
+    assert(sim.GetDemand().HasDemand());
+    sim.ApplyConfiguration();
+    for (int t = 0; t < 60 * 120; t++) sim.Update(1.0f / 60.0f);
+    const VehicleStore& v = sim.GetVehicles();
+    assert(sim.GetDemand().GetArrivalCount() > 60 && v.GetPoolStats().removed > 0);
+    for (int i = 0; i < v.Size(); i++) {
+        if (v.finished[i]) continue;
+        assert(v.type[i] == VEHICLE_CAR);
+        assert(v.tripDestination[i] == 28 || v.tripDestination[i] == VehicleStore::TRIP_NONE);
+    }
+
+    // Errors name the line
+    f = fopen(path, "w");
+    fprintf(f, "od 0 28 100\nod 0 28 fast\n");
+    fclose(f);
+    assert(!demand.Load(path) && demand.GetError().find(":2:") != std::string::npos && !demand.HasDemand());
+    remove(path);
+    globalConfig = GetDefaultConfig();
+}
+
+TEST_CASE(TestOsmImport) {
+    OsmImportOptions options;
+    options.threads = 1;
+    OsmNetwork serial;
+    OsmImportStats stats;
+    std::string error;
+    assert(ImportOsm("assets/maps/anfa_sample.osm", options, serial, error, &stats));
+    assert(stats.roadWays == 23 && stats.skippedWays == 6); // Footway, buildings and park left out
+    assert(stats.boundaries == 5 && stats.signals == 2);
+    assert(serial.lights.size() == 8 && serial.plans.size() == 2 && serial.plans[0].stages.size() == 2);
+
+    // Boundaries: lanes leave on a TELEPORT to a START. Lanes sit 2.5m / 6.75m off the centreline,
+    // so each START sees the opposite inner lane 5m or 9.25m away
+    const RoadGraph& graph = serial.graph;
+    int starts = 0;
+    for (const Node& n : graph.GetAllNodes()) {
+        if (n.type == TELEPORT) {
+            assert(n.nextNodes.empty() && graph.GetNode(n.teleportTargetId).type == START);
+            continue;
+        }
+        assert(!n.nextNodes.empty()); // No dead end inside the map
+        if (n.type != START) continue;
+        starts++;
+        bool opposite = false;
+        for (const Node& m : graph.GetAllNodes()) {
+            if (m.type != TELEPORT) continue;
+            float d = Vector3Distance(m.pos, n.pos);
+            if (fabsf(d - 5.0f) < 0.3f || fabsf(d - 9.25f) < 0.3f) opposite = true;
+        }
+        assert(opposite);
+    }
+    assert(starts >= 5);
+
+    // Every lane of every signalised approach stops under its light
+    for (const NetworkLight& light : serial.lights) {
+        for (int id : light.nodeIds) assert(graph.GetNode(id).type == DECISION);
+    }
+
+    // Same network whatever the thread count
+    options.threads = 4;
+    OsmNetwork parallel;
+    assert(ImportOsm("assets/maps/anfa_sample.osm", options, parallel, error));
+    assert(SameGraph(serial.graph, parallel.graph));
+
+    // Written as a map file, read back with its lights
+    const char* path = "tests/osm_test.roadnet";
+    assert(WriteRoadNetworkText(serial.graph, path, serial.lights, serial.plans));
+    RoadNetworkFile file;
+    assert(file.Load(path));
+    assert(file.GetControllerCount() == 8);
+    RoadGraph loaded;
+    file.BuildGraph(loaded);
+    assert(SameGraph(serial.graph, loaded));
+    file.Unload();
+    remove(path);
+
+    // PBF and missing files are refused with a message
+    assert(!ImportOsm("city.osm.pbf", options, parallel, error) && error.find("PBF") != std::string::npos);
+    assert(!ImportOsm("tests/missing.osm", options, parallel, error) && !error.empty());
 }
 
 int main() {
-    // Raylib requires a window context for some functions (like GetFrameTime) 
-    // used in TrafficManager, so we init a headless/tiny window if needed.
-    InitWindow(100, 100, "Unit Tests");
-    SetTargetFPS(60);
+    // The simulation core takes dt explicitly, no window/context needed.
 
     // need this commit to test:
     // & "C:\raylib\w64devkit\bin\mingw32-make.exe" test
@@ -97,9 +1115,29 @@ int main() {
     RUN_TEST(TestVehicleInitialization);
     RUN_TEST(TestVehicleSpawner);
     RUN_TEST(TestTeleportationLogic);
+    RUN_TEST(TestSpatialGridQuery);
+    RUN_TEST(TestRoadGraphInvalidLookup);
+    RUN_TEST(TestHeadlessSimulationDeterministic);
+    RUN_TEST(TestFixedTimestepFrameRateIndependent);
+    RUN_TEST(TestParallelUpdateMatchesSerial);
+    RUN_TEST(TestFollowKernelMatchesScalar);
+    RUN_TEST(TestProfilerScopes);
+    RUN_TEST(TestFrustumCulling);
+    RUN_TEST(TestLightScheduler);
+    RUN_TEST(TestSignalPlanGreenWave);
+    RUN_TEST(TestActuatedSignals);
+    RUN_TEST(TestRouterAStarMatchesCH);
+    RUN_TEST(TestTripRouting);
+    RUN_TEST(TestFrozenAdjacency);
+    RUN_TEST(TestLiveTravelTimes);
+    RUN_TEST(TestLaneLeader);
+    RUN_TEST(TestFollowModels);
+    RUN_TEST(TestMesoEngine);
+    RUN_TEST(TestVehiclePool);
+    RUN_TEST(TestRoadNetworkFile);
+    RUN_TEST(TestOsmImport);
+    RUN_TEST(TestDemand);
 
     std::cout << "--- ALL TESTS PASSED ---\n";
-    
-    CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+// =============================================================================
+//  ROAD NETWORK TOOL
+//  Converts maps between the text and the binary format (road_network_file.h).
+//
+//  Usage: roadnet_tool export FILE.roadnet              built-in network (InitializeRoadNetwork) as text
+//         roadnet_tool compile IN.roadnet OUT.roadbin   text -> binary blob for fast loading
+//         roadnet_tool info FILE                        loads a map (either format), prints counts and timings
+// =============================================================================
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "roadgraph.h"
+#include "road_network.h"
+#include "road_network_file.h"
+
+static double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "export") == 0) {
+        RoadGraph graph;
+        InitializeRoadNetwork(graph);
+        if (!WriteRoadNetworkText(graph, argv[2])) {
+            fprintf(stderr, "Cannot write %s\n", argv[2]);
+            return 1;
+        }
+        printf("%s: %d nodes (lights are not part of the graph, add them by hand)\n", argv[2], (int)graph.GetAllNodes().size());
+        return 0;
+    }
+
+    if (argc == 4 && strcmp(argv[1], "compile") == 0) {
+        RoadNetworkFile file;
+        auto start = std::chrono::steady_clock::now();
+        if (!file.LoadText(argv[2])) {
+            fprintf(stderr, "%s\n", file.GetError().c_str());
+            return 1;
+        }
+        double parseMs = MsSince(start);
+        if (!file.SaveBinary(argv[3])) {
+            fprintf(stderr, "Cannot write %s\n", argv[3]);
+            return 1;
+        }
+        printf("%s: %d nodes, %d edges, %d lights, %zu bytes (parsed in %.1f ms)\n", argv[3],
+               file.GetNodeCount(), file.GetEdgeCount(), file.GetControllerCount(), file.GetByteSize(), parseMs);
+        return 0;
+    }
+
+    if (argc == 3 && strcmp(argv[1], "info") == 0) {
+        RoadNetworkFile file;
+        auto start = std::chrono::steady_clock::now();
+        if (!file.Load(argv[2])) {
+            fprintf(stderr, "%s\n", file.GetError().c_str());
+            return 1;
+        }
+        double loadMs = MsSince(start);
+
+        RoadGraph graph;
+        start = std::chrono::steady_clock::now();
+        file.BuildGraph(graph);
+        double buildMs = MsSince(start);
+        printf("%s: %d nodes, %d edges, %d lights, %zu bytes\n", argv[2],
+               file.GetNodeCount(), file.GetEdgeCount(), file.GetControllerCount(), file.GetByteSize());
+        printf("load=%.2f ms  BuildGraph=%.2f ms\n", loadMs, buildMs);
+        return 0;
+    }
+
+    fprintf(stderr, "Usage: roadnet_tool export FILE | compile IN OUT | info FILE\n");
+    return 1;
+}
@@ -0,0 +1,184 @@
+// =============================================================================
+//  TRAFFIC HEADLESS RUNNER
+//  Steps the simulation core without a window, as fast as the CPU allows.
+//
+//  Usage: traffic_headless [--ticks N] [--dt SECONDS] [--seed N] [--scale K] [--threads T] [--trace FILE]
+//                          [--signals fixed|actuated|pressure] [--routing random|trips|dynamic]
+//                          [--follow type|legacy|idm|gipps|krauss] [--engine micro|meso] [--map FILE]
+//                          [--exits teleport|leave] [--demand FILE]
+//    --ticks    number of simulation steps          (default 10000)
+//    --dt       seconds of simulated time per step   (default FIXED_TIMESTEP)
+//    --seed     random seed, same seed = same run    (default 1)
+//    --scale    multiplies every vehicle count       (default 1)
+//    --threads  worker threads, 0 = one per core     (default 0, result does not depend on it)
+//    --trace    write a Chrome trace of every tick    (default off)
+//    --signals  traffic light control mode            (default fixed)
+//    --routing  random turns, shortest-route trips or live fastest branch (default random)
+//    --follow   car-following model for every vehicle (default type: per vehicle type)
+//    --engine   per-tick vehicles or road queues (default micro; meso is fine with --dt 1)
+//    --map      .roadnet text or .roadbin binary map  (default: built-in network)
+//    --exits    jump to the landing, or leave and re-enter as a new vehicle (default teleport)
+//    --demand   OD matrix file (demand.h): continuous arrivals, vehicles leave at the exits
+// =============================================================================
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "simulation.h"
+#include "config.h"
+#include "sim_random.h"
+#include "profiler.h"
+#include "follow_model.h"
+
+int main(int argc, char** argv) {
+    long ticks = 10000;
+    float dt = SimulationConfig::FIXED_TIMESTEP;
+    unsigned int seed = 1;
+    int scale = 1;
+    int threads = 0;
+    const char* tracePath = nullptr;
+    const char* signals = "fixed";
+    const char* routing = "random";
+    const char* follow = "type";
+    const char* engine = "micro";
+    const char* mapPath = "";
+    const char* exits = "teleport";
+    const char* demandPath = "";
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--ticks") == 0) ticks = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "--dt") == 0) dt = (float)atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned int)strtoul(argv[i + 1], nullptr, 10);
+        else if (strcmp(argv[i], "--scale") == 0) scale = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threads = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+        else if (strcmp(argv[i], "--signals") == 0) signals = argv[i + 1];
+        else if (strcmp(argv[i], "--routing") == 0) routing = argv[i + 1];
+        else if (strcmp(argv[i], "--follow") == 0) follow = argv[i + 1];
+        else if (strcmp(argv[i], "--engine") == 0) engine = argv[i + 1];
+        else if (strcmp(argv[i], "--map") == 0) mapPath = argv[i + 1];
+        else if (strcmp(argv[i], "--exits") == 0) exits = argv[i + 1];
+        else if (strcmp(argv[i], "--demand") == 0) demandPath = argv[i + 1];
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    SignalControlMode signalMode = SIGNAL_FIXED_TIME;
+    if (strcmp(signals, "actuated") == 0) signalMode = SIGNAL_ACTUATED;
+    else if (strcmp(signals, "pressure") == 0) signalMode = SIGNAL_MAX_PRESSURE;
+    else if (strcmp(signals, "fixed") != 0) {
+        fprintf(stderr, "Unknown signal mode: %s\n", signals);
+        return 1;
+    }
+    RoutingMode routingMode = ROUTING_RANDOM_WALK;
+    if (strcmp(routing, "trips") == 0) routingMode = ROUTING_TRIPS;
+    else if (strcmp(routing, "dynamic") == 0) routingMode = ROUTING_DYNAMIC;
+    else if (strcmp(routing, "random") != 0) {
+        fprintf(stderr, "Unknown routing mode: %s\n", routing);
+        return 1;
+    }
+    FollowModel followModel = FollowModelFromName(follow);
+    if (followModel == FOLLOW_BY_TYPE && strcmp(follow, "type") != 0) {
+        fprintf(stderr, "Unknown follow model: %s\n", follow);
+        return 1;
+    }
+    SimulationEngine engineMode = ENGINE_MICRO;
+    if (strcmp(engine, "meso") == 0) engineMode = ENGINE_MESO;
+    else if (strcmp(engine, "micro") != 0) {
+        fprintf(stderr, "Unknown engine: %s\n", engine);
+        return 1;
+    }
+    bool leaveAtExits = strcmp(exits, "leave") == 0;
+    if (!leaveAtExits && strcmp(exits, "teleport") != 0) {
+        fprintf(stderr, "Unknown exit mode: %s\n", exits);
+        return 1;
+    }
+    if (ticks < 0 || dt <= 0.0f || scale < 1 || threads < 0) {
+        fprintf(stderr, "Invalid arguments\n");
+        return 1;
+    }
+
+    // 1. Same setup as the game, minus the window
+    SimRandom::Seed(seed);
+    globalConfig = GetDefaultConfig();
+    for (auto& vc : globalConfig.vehicleConfigs) vc.count *= scale;
+    globalConfig.maxVehicles *= scale;
+    globalConfig.workerThreads = threads;
+    globalConfig.signalControl = signalMode;
+    globalConfig.routing = routingMode;
+    globalConfig.followModel = followModel;
+    globalConfig.engine = engineMode;
+    globalConfig.networkPath = mapPath;
+    globalConfig.leaveAtExits = leaveAtExits;
+    globalConfig.demandPath = demandPath;
+    globalConfig.approachStats = true; // For the per-approach report below
+
+    Simulation simulation;
+    simulation.Init();
+    if (mapPath[0] && !simulation.GetNetworkFile().IsLoaded()) {
+        fprintf(stderr, "%s\n", simulation.GetNetworkFile().GetError().c_str());
+        return 1;
+    }
+    if (demandPath[0] && !simulation.GetDemand().HasDemand()) {
+        fprintf(stderr, "%s\n", simulation.GetDemand().GetError().c_str());
+        return 1;
+    }
+    simulation.ApplyConfiguration();
+
+    // 2. Run
+    if (tracePath) Profiler::BeginTrace();
+    auto start = std::chrono::steady_clock::now();
+    for (long t = 0; t < ticks; t++) {
+        simulation.Update(dt);
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (tracePath && !Profiler::EndTrace(tracePath)) {
+        fprintf(stderr, "Cannot write %s\n", tracePath);
+        return 1;
+    }
+
+    // 3. Report
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double simSeconds = ticks * (double)dt;
+    printf("ticks=%ld dt=%.4f seed=%u vehicles=%d threads=%d\n", ticks, dt, seed, simulation.GetVehicleCount(), simulation.GetThreadCount());
+    printf("wall=%.3fs sim=%.1fs ticks/s=%.0f realtime=x%.1f\n",
+           seconds, simSeconds,
+           seconds > 0.0 ? ticks / seconds : 0.0,
+           seconds > 0.0 ? simSeconds / seconds : 0.0);
+
+    // Per approach: vehicles through the stop line and their average delay
+    const TrafficManager& lights = simulation.GetTrafficManager();
+    long served = 0;
+    double delay = 0.0;
+    printf("signals=%s routing=%s follow=%s\n", signals, routing, follow);
+    for (int c = 0; c < lights.GetControllerCount(); c++) {
+        const TrafficController& ctrl = lights.GetController(c);
+        printf("  light %-3d served=%-6ld avgDelay=%.2fs queue=%d\n", ctrl.id, ctrl.stats.served, ctrl.stats.GetAverageDelay(), ctrl.stats.queued);
+        served += ctrl.stats.served;
+        delay += ctrl.stats.totalDelay;
+    }
+    printf("  total     served=%-6ld avgDelay=%.2fs throughput=%.1f veh/min\n", served, served > 0 ? delay / served : 0.0, simSeconds > 0.0 ? served * 60.0 / simSeconds : 0.0);
+    if (engineMode == ENGINE_MESO) {
+        const MesoEngine& meso = simulation.GetMesoEngine();
+        printf("engine=meso roads=%d moves=%ld trips=%ld (%.0f/h) stuck=%ld\n", meso.GetRoadCount(), meso.GetMoveCount(),
+               meso.GetTripCount(), simSeconds > 0.0 ? meso.GetTripCount() * 3600.0 / simSeconds : 0.0, meso.GetStuckCount());
+    }
+    if (demandPath[0]) {
+        const DemandModel& demand = simulation.GetDemand();
+        printf("demand: rows=%d (dropped %d) rate=%.0f/h arrivals=%ld spawned=%ld waiting=%d clock=%.2fh\n",
+               demand.GetRowCount(), demand.GetDroppedRowCount(), demand.GetTotalRate(), demand.GetArrivalCount(),
+               simulation.GetSpawner().GetSpawnedCount(), simulation.GetSpawner().GetWaitingCount(), demand.GetTimeOfDay());
+    }
+    if (leaveAtExits || demandPath[0]) {
+        VehiclePoolStats pool = simulation.GetVehicles().GetPoolStats();
+        printf("pool: live=%d slots=%d spawned=%lld recycled=%lld removed=%lld bytes=%zu\n", pool.live, pool.slots,
+               pool.spawned, pool.recycled, pool.removed, pool.bytes);
+    }
+    return 0;
+}